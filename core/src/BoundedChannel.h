@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_BOUNDEDCHANNEL_H
+#define FLUX_BOUNDEDCHANNEL_H
+
+#include <flux/EventCount>
+
+namespace flux {
+
+/** \brief Lock-free bounded inter-thread communication channel
+  *
+  * Multi-producer/multi-consumer ring buffer (D. Vyukov's bounded queue). Handing over
+  * an item takes a couple of atomic operations and does not allocate. Threads
+  * only block (on a futex) if the channel is full or empty. The capacity is rounded
+  * up to the next power of two.
+  * \see Channel, SpscChannel
+  */
+template<class T>
+class BoundedChannel: public Object
+{
+public:
+    static Ref<BoundedChannel> create(int capacity = 1024) {
+        return new BoundedChannel(capacity);
+    }
+
+    ~BoundedChannel() { delete[] cells_; }
+
+    bool tryPush(const T &item)
+    {
+        if (!enqueue(item)) return false;
+        notEmpty_.notify();
+        return true;
+    }
+
+    bool tryPop(T *item)
+    {
+        if (!dequeue(item)) return false;
+        notFull_.notify();
+        return true;
+    }
+
+    void push(const T &item)
+    {
+        while (!enqueue(item)) {
+            uint32_t epoch = notFull_.prepareWait();
+            if (enqueue(item)) {
+                notFull_.cancelWait();
+                break;
+            }
+            notFull_.wait(epoch);
+        }
+        notEmpty_.notify();
+    }
+
+    T pop(T *item = 0)
+    {
+        T h;
+        if (!item) item = &h;
+        popBefore(-1, item);
+        return *item;
+    }
+
+    bool popBefore(double timeout, T *item = 0)
+    {
+        T h;
+        if (!item) item = &h;
+        while (!dequeue(item)) {
+            uint32_t epoch = notEmpty_.prepareWait();
+            if (dequeue(item)) {
+                notEmpty_.cancelWait();
+                break;
+            }
+            if (!notEmpty_.wait(epoch, timeout)) {
+                if (!dequeue(item)) return false;
+                break;
+            }
+        }
+        notFull_.notify();
+        return true;
+    }
+
+    /** Push \a item and leave it empty. For references the reference is handed over to
+      * the receiving thread without touching the reference count. A thread-local object
+      * is switched to atomic reference counting on the way (see Object::setThreadLocal()).
+      */
+    void transfer(T *item)
+    {
+        share(*item);
+        while (!enqueueTransfer(item)) {
+            uint32_t epoch = notFull_.prepareWait();
+            if (enqueueTransfer(item)) {
+                notFull_.cancelWait();
+                break;
+            }
+            notFull_.wait(epoch);
+        }
+        notEmpty_.notify();
+    }
+
+    /** Push \a n items, waking up consumers once per batch
+      */
+    void pushBatch(const T *items, int n)
+    {
+        int i = 0;
+        while (i < n) {
+            int i0 = i;
+            while (i < n && enqueue(items[i])) ++i;
+            if (i0 < i) notEmpty_.notify(i - i0);
+            if (i == n) break;
+            uint32_t epoch = notFull_.prepareWait();
+            if (enqueue(items[i])) {
+                notFull_.cancelWait();
+                notEmpty_.notify();
+                ++i;
+                continue;
+            }
+            notFull_.wait(epoch);
+        }
+    }
+
+    /** Wait for at least one item and pop up to \a maxCount items without further waiting.
+      * Returns the number of items popped.
+      */
+    int popBatch(T *items, int maxCount)
+    {
+        if (maxCount <= 0) return 0;
+        pop(items);
+        int n = 1;
+        while (n < maxCount && dequeue(items + n)) ++n;
+        if (n > 1) notFull_.notify(n - 1);
+        return n;
+    }
+
+    inline int capacity() const { return mask_ + 1; }
+
+    inline int count() const {
+        size_t h = __atomic_load_n(&dequeuePos_, __ATOMIC_RELAXED);
+        size_t t = __atomic_load_n(&enqueuePos_, __ATOMIC_RELAXED);
+        return (t > h) ? int(t - h) : 0;
+    }
+
+private:
+    BoundedChannel(int capacity):
+        mask_(2)
+    {
+        while (int(mask_) < capacity) mask_ <<= 1;
+        cells_ = new Cell[mask_];
+        for (size_t i = 0; i < mask_; ++i) cells_[i].sequence = i;
+        --mask_;
+        enqueuePos_ = 0;
+        dequeuePos_ = 0;
+    }
+
+    bool enqueue(const T &item)
+    {
+        size_t pos = 0;
+        Cell *cell = claim(&pos);
+        if (!cell) return false;
+        cell->value = item;
+        __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_SEQ_CST);
+        return true;
+    }
+
+    bool enqueueTransfer(T *item)
+    {
+        size_t pos = 0;
+        Cell *cell = claim(&pos);
+        if (!cell) return false;
+        move(cell->value, *item);
+        *item = T();
+        __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_SEQ_CST);
+        return true;
+    }
+
+    struct Cell;
+
+    Cell *claim(size_t *pos)
+    {
+        Cell *cell = 0;
+        size_t p = __atomic_load_n(&enqueuePos_, __ATOMIC_RELAXED);
+        while (true) {
+            cell = &cells_[p & mask_];
+            size_t seq = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+            intptr_t d = intptr_t(seq) - intptr_t(p);
+            if (d == 0) {
+                if (__atomic_compare_exchange_n(&enqueuePos_, &p, p + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                    break;
+            }
+            else if (d < 0) return 0;
+            else p = __atomic_load_n(&enqueuePos_, __ATOMIC_RELAXED);
+        }
+        *pos = p;
+        return cell;
+    }
+
+    bool dequeue(T *item)
+    {
+        Cell *cell = 0;
+        size_t pos = __atomic_load_n(&dequeuePos_, __ATOMIC_RELAXED);
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+            intptr_t d = intptr_t(seq) - intptr_t(pos + 1);
+            if (d == 0) {
+                if (__atomic_compare_exchange_n(&dequeuePos_, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                    break;
+            }
+            else if (d < 0) return false;
+            else pos = __atomic_load_n(&dequeuePos_, __ATOMIC_RELAXED);
+        }
+        move(*item, cell->value);
+        cell->value = T();
+        __atomic_store_n(&cell->sequence, pos + mask_ + 1, __ATOMIC_SEQ_CST);
+        return true;
+    }
+
+    struct Cell {
+        size_t sequence;
+        T value;
+    };
+
+    Cell *cells_;
+    size_t mask_;
+    char pad0_[64];
+    size_t enqueuePos_;
+    char pad1_[64];
+    size_t dequeuePos_;
+    char pad2_[64];
+    EventCount notEmpty_;
+    EventCount notFull_;
+};
+
+} // namespace flux
+
+#endif // FLUX_BOUNDEDCHANNEL_H
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/strings>
+#include <flux/BufferedStream>
+
+namespace flux {
+
+Ref<BufferedStream> BufferedStream::open(Stream *stream, int capacity)
+{
+    return new BufferedStream(stream, capacity);
+}
+
+BufferedStream::BufferedStream(Stream *stream, int capacity):
+    stream_(stream),
+    capacity_(capacity > 0 ? capacity : 0x4000),
+    i_(0), n_(0),
+    eoi_(false),
+    fill_(0)
+{}
+
+BufferedStream::~BufferedStream()
+{
+    try {
+        flush();
+    }
+    catch (...)
+    {}
+}
+
+bool BufferedStream::readyRead(double interval) const
+{
+    return i_ < n_ || eoi_ || stream_->readyRead(interval);
+}
+
+int BufferedStream::read(ByteArray *data)
+{
+    if (i_ == n_) {
+        if (data->count() >= capacity_ && !eoi_) {
+            flush();
+            int n = stream_->read(data);
+            if (n == 0) eoi_ = true;
+            return n;
+        }
+        if (!fill()) return 0;
+    }
+    int n = n_ - i_;
+    if (n > data->count()) n = data->count();
+    memcpy(data->bytes(), input_->bytes() + i_, n);
+    i_ += n;
+    return n;
+}
+
+/** Read up to the next occurence of \a delimiter. The delimiter is consumed, but
+  * not included in the returned record. The last record of the input is returned
+  * even if it is not terminated by \a delimiter.
+  * \return view into the input buffer, valid until the next read, or null at end of input
+  */
+ByteArray *BufferedStream::readUntil(char delimiter)
+{
+    int j = i_;
+    while (true) {
+        if (j < n_) {
+            const uint8_t *s = input_->bytes();
+            const uint8_t *p = static_cast<const uint8_t *>(memchr(s + j, delimiter, n_ - j));
+            if (p) {
+                int k = p - s;
+                slice_->reselect(i_, k);
+                i_ = k + 1;
+                return slice_;
+            }
+        }
+        int m = n_ - i_;
+        if (!fill()) break;
+        j = i_ + m;
+    }
+    if (i_ == n_) return 0;
+    slice_->reselect(i_, n_);
+    i_ = n_;
+    return slice_;
+}
+
+/** Read the next line terminated by "\n" or "\r\n"
+  * \return view into the input buffer, valid until the next read, or null at end of input
+  */
+ByteArray *BufferedStream::readLine()
+{
+    ByteArray *line = readUntil('\n');
+    if (line) {
+        int n = line->count();
+        if (n > 0 && line->bytes()[n - 1] == '\r') {
+            int i0 = line->bytes() - input_->bytes();
+            slice_->reselect(i0, i0 + n - 1);
+        }
+    }
+    return line;
+}
+
+void BufferedStream::write(const ByteArray *data)
+{
+    int n = data->count();
+    if (fill_ + n > capacity_) {
+        if (n >= capacity_) {
+            if (fill_ == 0) {
+                stream_->write(data);
+                return;
+            }
+            Ref<StringList> parts = StringList::create();
+            parts->append(data);
+            write(parts.get());
+            return;
+        }
+        flush();
+    }
+    if (!output_) output_ = ByteArray::allocate(capacity_);
+    memcpy(output_->bytes() + fill_, data->bytes(), n);
+    fill_ += n;
+}
+
+/** Small writes are collected in the output buffer. Parts too large for the output
+  * buffer are handed over to the underlying stream together with the buffered data
+  * in a single gathering write, without copying.
+  */
+void BufferedStream::write(const StringList *parts)
+{
+    int total = 0;
+    for (int i = 0; i < parts->count(); ++i)
+        total += parts->at(i)->count();
+    if (total >= capacity_) {
+        if (fill_ == 0) {
+            stream_->write(parts);
+            return;
+        }
+        Ref<StringList> gather = StringList::create();
+        gather->append(output_->select(0, fill_));
+        gather->appendList(parts);
+        fill_ = 0;
+        stream_->write(gather);
+        return;
+    }
+    if (fill_ + total > capacity_) flush();
+    if (!output_) output_ = ByteArray::allocate(capacity_);
+    for (int i = 0; i < parts->count(); ++i) {
+        ByteArray *part = parts->at(i);
+        memcpy(output_->bytes() + fill_, part->bytes(), part->count());
+        fill_ += part->count();
+    }
+}
+
+/** Flushes the output buffer, so data handed over to the direct sink is kept in order
+  */
+SystemStream *BufferedStream::directSink()
+{
+    flush();
+    return stream_->directSink();
+}
+
+void BufferedStream::directWritten(off_t count)
+{
+    stream_->directWritten(count);
+}
+
+/** Forward all buffered writes to the underlying stream
+  */
+void BufferedStream::flush()
+{
+    if (fill_ == 0) return;
+    int n = fill_;
+    fill_ = 0;
+    stream_->write(output_->select(0, n));
+}
+
+/** Move pending input to the front of the input buffer and append the next block
+  * read from the underlying stream. The buffer grows when it is already filled up
+  * by a single record.
+  * \return false at end of input
+  */
+bool BufferedStream::fill()
+{
+    if (eoi_) return false;
+    if (!input_) {
+        input_ = ByteArray::allocate(capacity_);
+        window_ = input_->select(0, 0);
+        slice_ = input_->select(0, 0);
+    }
+    flush();
+    if (i_ > 0) {
+        memmove(input_->bytes(), input_->bytes() + i_, n_ - i_);
+        n_ -= i_;
+        i_ = 0;
+    }
+    if (n_ == input_->count()) input_->resize(2 * n_);
+    int n = stream_->read(window_->reselect(n_, input_->count()));
+    if (n == 0) {
+        eoi_ = true;
+        return false;
+    }
+    n_ += n;
+    return true;
+}
+
+} // namespace flux
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_BUFFEREDSTREAM_H
+#define FLUX_BUFFEREDSTREAM_H
+
+#include <flux/Stream>
+
+namespace flux {
+
+/** \brief Buffered input and output on top of another stream
+  *
+  * Reads fetch data from the underlying stream in blocks of capacity() bytes.
+  * readUntil() and readLine() return views into the input buffer, which stay
+  * valid until the next read operation. Records longer than the buffer make it
+  * grow as needed.
+  *
+  * Writes are collected in an output buffer of capacity() bytes and forwarded
+  * to the underlying stream when the buffer is full, when flush() is called, before
+  * blocking on input or when the stream is destroyed.
+  * \see LineSource
+  */
+class BufferedStream: public Stream
+{
+public:
+    static Ref<BufferedStream> open(Stream *stream, int capacity = 0x4000);
+    ~BufferedStream();
+
+    inline Stream *stream() const { return stream_; }
+    inline int capacity() const { return capacity_; }
+
+    virtual bool readyRead(double interval) const;
+    virtual int read(ByteArray *data);
+
+    ByteArray *readUntil(char delimiter);
+    ByteArray *readLine();
+
+    virtual void write(const ByteArray *data);
+    virtual void write(const StringList *parts);
+
+    inline void write(Ref<ByteArray> data) { write(data.get()); }
+    inline void write(String s) { write(s.get()); }
+    inline void write(const char *s) { write(String(s)); }
+
+    virtual SystemStream *directSink();
+    virtual void directWritten(off_t count);
+
+    void flush();
+
+private:
+    BufferedStream(Stream *stream, int capacity);
+
+    bool fill();
+
+    Ref<Stream> stream_;
+    int capacity_;
+
+    Ref<ByteArray> input_;
+    Ref<ByteArray> window_;
+    Ref<ByteArray> slice_;
+    int i_, n_;
+    bool eoi_;
+
+    Ref<ByteArray> output_;
+    int fill_;
+};
+
+} // namespace flux
+
+#endif // FLUX_BUFFEREDSTREAM_H
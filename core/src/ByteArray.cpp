@@ -8,11 +8,8 @@
 
 #include <math.h>
 #include <flux/List>
-#include <flux/Unicode>
-#include <flux/Utf8Source>
 #include <flux/Utf8Sink>
-#include <flux/Utf16Source>
-#include <flux/Utf16Sink>
+#include <flux/utf16>
 #include <flux/Format>
 #include <flux/ByteArray>
 
@@ -204,6 +201,20 @@ ByteArray &ByteArray::operator^=(const ByteArray &b)
     return *this;
 }
 
+/** Move a selection to the range [i0, i1) of its parent
+  */
+ByteArray *ByteArray::reselect(int i0, int i1)
+{
+    FLUX_ASSERT(parent_);
+    if (i0 < 0) i0 = 0;
+    else if (i0 > parent_->size_) i0 = parent_->size_;
+    if (i1 < i0) i1 = i0;
+    else if (i1 > parent_->size_) i1 = parent_->size_;
+    size_ = i1 - i0;
+    data_ = parent_->data_ + i0;
+    return this;
+}
+
 Ref<ByteArray> ByteArray::copy(int i0, int i1) const
 {
     if (i0 < 0) i0 = 0;
@@ -642,24 +653,40 @@ bool ByteArray::linePosToOffset(int line, int pos, int *offset) const
     return true;
 }
 
-Ref<ByteArray> ByteArray::fromUtf16(ByteArray *utf16, int endian)
+inline static uint16_t swapBytes(uint16_t x) { return (x << 8) | (x >> 8); }
+
+Ref<ByteArray> ByteArray::fromUtf16(ByteArray *source, int endian)
 {
-    if (utf16->count() == 0) return ByteArray::create();
+    if (source->count() == 0) return ByteArray::create();
+    if (source->count() % 2 != 0) throw utf16::DecodeError();
 
-    Ref<ByteArray> out;
-    {
-        int n = 0;
-        Ref<Utf16Source> source = Utf16Source::open(utf16, endian);
-        for (uchar_t ch; source->read(&ch);)
-            n += utf8::encodedSize(ch);
-        out = ByteArray::create(n);
+    Ref<ByteArray> words;
+    const uint16_t *s = reinterpret_cast<const uint16_t *>(source->bytes());
+    int n = source->count() / 2;
+
+    uint16_t first;
+    memcpy(&first, s, 2);
+    if (endian != localEndian()) first = swapBytes(first);
+    if (first == 0xFFFE) {
+        endian = (endian == BigEndian) ? LittleEndian : BigEndian;
+        ++s;
+        --n;
     }
 
-    Ref<Utf16Source> source = Utf16Source::open(utf16, endian);
-    Ref<Utf8Sink> sink = Utf8Sink::open(out);
-    for (uchar_t ch; source->read(&ch);)
-        sink->write(ch);
+    if (endian != localEndian() || (uintptr_t(s) & 1) != 0) {
+        words = ByteArray::copy(reinterpret_cast<const char *>(s), 2 * n);
+        uint16_t *w = reinterpret_cast<uint16_t *>(words->bytes());
+        if (endian != localEndian()) {
+            for (int i = 0; i < n; ++i)
+                w[i] = swapBytes(w[i]);
+        }
+        s = w;
+    }
 
+    int m = utf16::utf8Size(s, n);
+    if (m < 0) throw utf16::DecodeError();
+    Ref<ByteArray> out = ByteArray::create(m);
+    utf16::toUtf8(s, n, out->chars());
     return out;
 }
 
@@ -668,59 +695,50 @@ Ref<ByteArray> ByteArray::fromUtf16(ByteArray *utf16, int endian)
   * The number of bytes required to fully represent the string in UTF-16 is
   * returned with the 'size' argument. Passing a zero for 'size' allows to
   * determine the required buffer size. No zero termination is written or
-  * or accounted for.
+  * or accounted for. Malformed input is replaced by the replacement character (0xFFFD).
   */
 bool ByteArray::toUtf16(void *buf, int *size)
 {
-    uint16_t *buf2 = reinterpret_cast<uint16_t*>(buf);
-    int j = 0, n = *size / 2;
-    Ref<Unicode> chars = Unicode::open(this);
-    for (int i = 0; i < chars->count(); ++i) {
-        uchar_t ch = chars->at(i);
-        if (ch < 0x10000) {
-            if (j < n) buf2[j] = ch;
-            ++j;
-        }
-        else if (ch <= 0x10FFFF) {
-            if (j + 1 < n) {
-                buf2[j] = (ch >> 10) + 0xB800;
-                buf2[j + 1] = (ch & 0x3FF) + 0xBC00;
-            }
-            j += 2;
-        }
-        else {
-            if (j < n) buf2[j] = 0xFFFD/*replacement character*/;
-            ++j;
-        }
-    }
-    *size = 2 * j;
-    return (j <= n);
+    const char *s = reinterpret_cast<const char *>(bytes_);
+    int n = utf8::utf16Size(s, size_);
+    bool fits = (2 * n <= *size);
+    if (fits && n > 0) utf8::toUtf16(s, size_, reinterpret_cast<uint16_t *>(buf));
+    *size = 2 * n;
+    return fits;
 }
 
 Ref<ByteArray> ByteArray::toUtf16(int endian)
 {
-    Ref<ByteArray> out;
-    Ref<Unicode> chars = Unicode::open(this);
-    {
-        int n = 0;
-        for (int i = 0; i < chars->count(); ++i)
-            n += utf16::encodedSize(chars->at(i));
-        out = ByteArray::create(n + 2);
-        out->at(n) = 0;
-        out->at(n + 1) = 0;
-    }
-    if (out->count() > 0) {
-        Ref<Utf16Sink> sink = Utf16Sink::open(out, endian);
-        for (int i = 0; i < chars->count(); ++i)
-            sink->write(chars->at(i));
+    const char *s = reinterpret_cast<const char *>(bytes_);
+    int n = utf8::utf16Size(s, size_);
+    Ref<ByteArray> out = ByteArray::create(2 * n + 2);
+    uint16_t *w = reinterpret_cast<uint16_t *>(out->bytes());
+    utf8::toUtf16(s, size_, w);
+    if (endian != localEndian()) {
+        for (int i = 0; i < n; ++i)
+            w[i] = swapBytes(w[i]);
     }
+    w[n] = 0;
     return out;
 }
 
 void ByteArray::checkUtf8() const
 {
-    Ref<Utf8Source> source = Utf8Source::open(const_cast<ByteArray *>(this));
-    for (uchar_t ch = 0; source->read(&ch););
+    if (!isValidUtf8()) throw utf8::DecodeError();
+}
+
+/** Check if this string is well-formed UTF-8
+  */
+bool ByteArray::isValidUtf8() const
+{
+    return utf8::isValid(reinterpret_cast<const char *>(bytes_), size_);
+}
+
+/** Number of Unicode characters of this (well-formed UTF-8) string
+  */
+int ByteArray::countCodePoints() const
+{
+    return utf8::count(reinterpret_cast<const char *>(bytes_), size_);
 }
 
 Ref<ByteArray> ByteArray::hex() const
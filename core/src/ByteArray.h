@@ -9,8 +9,10 @@
 #ifndef FLUX_BYTEARRAY_H
 #define FLUX_BYTEARRAY_H
 
+#include <limits>
 #include <flux/containers>
 #include <flux/strings>
+#include <flux/numbers>
 
 namespace flux {
 
@@ -96,6 +98,7 @@ public:
 
     inline Ref<ByteArray> copy() const { return new ByteArray(*this); }
     inline Ref<ByteArray> select(int i0, int i1) { return new ByteArray(this, i0, i1); }
+    ByteArray *reselect(int i0, int i1);
 
     template<class Range>
     inline Ref<ByteArray> copy(Range *range) const {
@@ -199,6 +202,8 @@ public:
     bool linePosToOffset(int line, int pos, int *offset = 0) const;
 
     void checkUtf8() const;
+    bool isValidUtf8() const;
+    int countCodePoints() const;
 
     static Ref<ByteArray> fromUtf16(ByteArray *utf16, int endian = localEndian());
     bool toUtf16(void *buf, int *size);
@@ -280,6 +285,23 @@ int ByteArray::scanNumber(T *value, int base, int i0, int i1) const
         }
     }
     T x = 0;
+    if (base == 10 && i < i1) {
+        if (isFloating) {
+            if (('0' <= at(i) && at(i) <= '9') || at(i) == '.') {
+                float64_t y = 0;
+                int n = parseFloat64(data_ + i, i1 - i, &y);
+                if (n > 0) {
+                    *value = sign * T(y);
+                    return i + n;
+                }
+            }
+        }
+        else {
+            uint64_t y = 0;
+            i += parseDigits(data_ + i, i1 - i, std::numeric_limits<T>::digits10, &y);
+            x = (sign < 0) ? T(0) - T(y) : T(y);
+        }
+    }
     while (i < i1) {
         char ch = at(i);
         int z = -1;
@@ -41,6 +41,18 @@ public:
         notEmpty_->signal();
     }
 
+    /** Push \a item to the back and leave it empty. A thread-local object is switched
+      * to atomic reference counting on the way (see Object::setThreadLocal()).
+      */
+    void transfer(T *item, int priority = 0)
+    {
+        share(*item);
+        Guard<Mutex> guard(mutex_);
+        queue_->pushBack(*item, priority);
+        *item = T();
+        notEmpty_->signal();
+    }
+
     T popBack(T *item = 0)
     {
         Guard<Mutex> guard(mutex_);
@@ -11,11 +11,15 @@
 
 #include <flux/types>
 #include <flux/strings>
-#include <flux/ByteArray>
+#include <flux/String>
 
 namespace flux {
 
 /** \brief CRC-32 check sum generator
+  *
+  * Processes eight bytes per step (slice-by-8). The check sum is not inverted
+  * on output, so ~sum() yields the value of the well-known CRC-32 (IEEE 802.3).
+  * \see Crc32c, Hash64
   */
 class Crc32
 {
@@ -49,6 +53,48 @@ inline uint32_t crc32(ByteArray *buf) {
     return crc.sum();
 }
 
+inline uint32_t crc32(const String &s) { return crc32(s.get()); }
+
+/** \brief CRC-32C (Castagnoli) check sum generator
+  *
+  * Uses the SSE4.2 crc32 instruction if the CPU supports it and falls back
+  * to slice-by-8 otherwise. Like Crc32 the check sum is not inverted on output.
+  * \see Crc32
+  */
+class Crc32c
+{
+public:
+    Crc32c(uint32_t seed = ~uint32_t(0))
+        : crc_(seed)
+    {}
+
+    void feed(const void *buf, int bufFill);
+    inline uint32_t sum() const { return crc_; }
+
+private:
+    uint32_t crc_;
+};
+
+inline uint32_t crc32c(const void *buf, int bufSize) {
+    Crc32c crc;
+    if (buf) crc.feed(buf, bufSize);
+    return crc.sum();
+}
+
+inline uint32_t crc32c(const char *s) {
+    Crc32c crc;
+    if (s) crc.feed(s, strlen(s));
+    return crc.sum();
+}
+
+inline uint32_t crc32c(ByteArray *buf) {
+    Crc32c crc;
+    if (buf) crc.feed(buf->bytes(), buf->count());
+    return crc.sum();
+}
+
+inline uint32_t crc32c(const String &s) { return crc32c(s.get()); }
+
 } // namespace flux
 
 #endif // FLUX_CRC32_H
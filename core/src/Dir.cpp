@@ -6,7 +6,11 @@
  *
  */
 
-#include <sys/stat.h> // mkdir
+#include <sys/stat.h> // mkdir, fstatat
+#include <sys/syscall.h> // SYS_getdents64
+#include <fcntl.h> // open, openat
+#include <dirent.h> // DT_UNKNOWN, DTTOIF
+#include <unistd.h> // close, syscall
 #include <flux/File>
 #include <flux/FileStatus>
 #include <flux/exceptions>
@@ -14,26 +18,47 @@
 
 namespace flux {
 
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+enum { DirBufferSize = 0x8000 };
+
 Ref<Dir> Dir::tryOpen(String path)
 {
-    DIR *dir = ::opendir(path);
-    if (dir) return new Dir(path, dir);
+    int fd = ::open(path, O_RDONLY|O_DIRECTORY|O_CLOEXEC);
+    if (fd != -1) return new Dir(path, fd);
+    return 0;
+}
+
+/** Open subdirectory \a name of directory \a parent
+  */
+Ref<Dir> Dir::tryOpenAt(Dir *parent, String name, bool followSymlink)
+{
+    int fd = ::openat(parent->fd_, name, O_RDONLY|O_DIRECTORY|O_CLOEXEC|(followSymlink ? 0 : O_NOFOLLOW));
+    if (fd != -1) return new Dir(parent->path(name), fd);
     return 0;
 }
 
-Dir::Dir(String path, DIR *dir)
+Dir::Dir(String path, int fd)
     : path_(path),
-      dir_(dir)
+      fd_(fd),
+      offset_(0),
+      fill_(0)
 {
-    if (!dir_) {
-        dir_ = ::opendir(path_);
-        if (!dir_) FLUX_SYSTEM_RESOURCE_ERROR(errno, path);
+    if (fd_ == -1) {
+        fd_ = ::open(path_, O_RDONLY|O_DIRECTORY|O_CLOEXEC);
+        if (fd_ == -1) FLUX_SYSTEM_RESOURCE_ERROR(errno, path);
     }
 }
 
 Dir::~Dir()
 {
-    if (::closedir(dir_) == -1)
+    if (::close(fd_) == -1)
         FLUX_SYSTEM_DEBUG_ERROR(errno);
 }
 
@@ -46,21 +71,49 @@ String Dir::path(String name) const
     return path_ + "/" + name;
 }
 
+const char *Dir::next(int *type)
+{
+    if (offset_ == fill_) {
+        if (!buffer_) buffer_ = ByteArray::create(DirBufferSize);
+        long ret = ::syscall(SYS_getdents64, fd_, buffer_->bytes(), buffer_->count());
+        if (ret == -1) FLUX_SYSTEM_DEBUG_ERROR(errno);
+        offset_ = 0;
+        fill_ = ret;
+        if (fill_ == 0) return 0;
+    }
+    LinuxDirent64 *entry = reinterpret_cast<LinuxDirent64 *>(buffer_->bytes() + offset_);
+    offset_ += entry->d_reclen;
+    if (type) *type = (entry->d_type == DT_UNKNOWN) ? 0 : DTTOIF(entry->d_type);
+    return entry->d_name;
+}
+
 bool Dir::read(String *name)
 {
-    struct dirent buf;
-    struct dirent *result;
-    memclr(&buf, sizeof(buf));
-    int ret = ::readdir_r(dir_, &buf, &result);
-    if (ret != 0) FLUX_SYSTEM_DEBUG_ERROR(ret);
-    if (result)
-        *name = buf.d_name;
-    return result;
+    return read(name, 0);
+}
+
+/** Read the next entry \a name and its \a type (see File::Type).
+  * The type is zero if the file system does not provide it (see typeAt()).
+  */
+bool Dir::read(String *name, int *type)
+{
+    const char *h = next(type);
+    if (h) *name = h;
+    return h;
+}
+
+/** Retrieve the type of entry \a name (see File::Type), zero if it does not exist
+  */
+int Dir::typeAt(String name, bool followSymlink) const
+{
+    struct stat buf;
+    if (::fstatat(fd_, name, &buf, followSymlink ? 0 : AT_SYMLINK_NOFOLLOW) == -1) return 0;
+    return buf.st_mode & S_IFMT;
 }
 
 bool Dir::access(String path, int flags)
 {
-    return access(path, flags);
+    return File::access(path, flags);
 }
 
 bool Dir::exists(String path)
@@ -73,8 +126,8 @@ int Dir::count(String path)
     Ref<Dir> dir = tryOpen(path);
     if (!dir) return 0;
     int n = 0;
-    for (String name; dir->read(&name);) {
-        if (name != "." && name != "..")
+    for (const char *name; (name = dir->next(0));) {
+        if (strcmp(name, ".") != 0 && strcmp(name, "..") != 0)
             ++n;
     }
     return n;
@@ -10,13 +10,17 @@
 #define FLUX_DIR_H
 
 #include <sys/types.h> // mode_t
-#include <dirent.h> // DIR, opendir, closedir, readdir_r
 #include <flux/generics>
 #include <flux/String>
 
 namespace flux {
 
 /** \brief Read, create and unlink directory files
+  *
+  * Directory entries are read in large batches (getdents64). Besides the entry name
+  * read() can deliver the file type (see File::Type) as reported by the file system,
+  * which saves a separate stat for most entries. Subdirectories can be opened relative
+  * to an open directory (openat), which saves resolving the full path again.
   * \see DirWalker
   */
 class Dir: public Source<String>
@@ -24,10 +28,16 @@ class Dir: public Source<String>
 public:
     inline static Ref<Dir> open(String path) { return new Dir(path); }
     static Ref<Dir> tryOpen(String path);
+    static Ref<Dir> tryOpenAt(Dir *parent, String name, bool followSymlink = true);
 
     String path() const;
     String path(String name) const;
     bool read(String *name);
+    bool read(String *name, int *type);
+
+    int typeAt(String name, bool followSymlink = true) const;
+
+    inline int fd() const { return fd_; }
 
     static bool access(String path, int flags);
     static bool exists(String path);
@@ -37,11 +47,16 @@ public:
     static void unlink(String path);
 
 protected:
-    Dir(String path, DIR *dir = 0);
+    Dir(String path, int fd = -1);
     ~Dir();
 
+    const char *next(int *type);
+
     String path_;
-    DIR *dir_;
+    int fd_;
+    Ref<ByteArray> buffer_;
+    int offset_;
+    int fill_;
 };
 
 } // namespace flux
@@ -6,12 +6,168 @@
  *
  */
 
+#include <flux/exceptions>
 #include <flux/Dir>
 #include <flux/File>
+#include <flux/TaskGroup>
 #include <flux/DirWalker>
+#include "futex.h"
 
 namespace flux {
 
+/** Check, if entry \a name of \a dir is a directory and if it should be descended into
+  */
+static bool classify(Dir *dir, String name, int type, bool followSymlink, bool *isDir)
+{
+    if (type == 0) type = dir->typeAt(name, false);
+    if (type == File::Symlink) {
+        *isDir = (dir->typeAt(name, true) == File::Directory);
+        return *isDir && followSymlink;
+    }
+    *isDir = (type == File::Directory);
+    return *isDir;
+}
+
+/** \internal
+  * \brief Entry of a directory listed ahead of the reader
+  */
+class DirEntry
+{
+public:
+    DirEntry(): isDir_(false) {}
+    DirEntry(String path, bool isDir, DirListing *child):
+        path_(path), isDir_(isDir), child_(child)
+    {}
+
+    String path_;
+    bool isDir_;
+    Ref<DirListing> child_;
+};
+
+/** \internal
+  * \brief Directory listed ahead of the reader
+  */
+class DirListing: public Object
+{
+public:
+    DirListing(String path, int depth):
+        path_(path),
+        depth_(depth),
+        entries_(List<DirEntry>::create()),
+        next_(0),
+        pending_(1),
+        failed_(false),
+        done_(0)
+    {}
+
+    void finish()
+    {
+        __atomic_store_n(&done_, 1, __ATOMIC_RELEASE);
+        futex::wake(&done_, intMax);
+    }
+
+    void wait()
+    {
+        while (!__atomic_load_n(&done_, __ATOMIC_ACQUIRE))
+            futex::wait(&done_, 0);
+    }
+
+    String path_;
+    int depth_;
+    Ref< List<DirEntry> > entries_;
+    int next_; // read position, owned by the reader
+    int pending_; // listings started, but not yet taken by the reader (kept in the root)
+    bool failed_; // listing terminated with an exception or was skipped
+    volatile int done_;
+};
+
+class DirListTask: public Task
+{
+public:
+    DirListTask(DirWalker *walker, DirListing *listing, TaskGroup *group, Channel< Ref<DirListing> > *ready):
+        maxDepth_(walker->maxDepth()),
+        ignoreHidden_(walker->ignoreHidden()),
+        followSymlink_(walker->followSymlink()),
+        listing_(listing),
+        root_(listing),
+        group_(group),
+        ready_(ready)
+    {}
+
+    void run()
+    {
+        try {
+            list();
+        }
+        catch (...) {
+            complete(true);
+            throw;
+        }
+        complete(false);
+    }
+
+    void skip()
+    {
+        complete(true);
+    }
+
+private:
+    DirListTask(DirListTask *parentTask, Dir *parent, String name, DirListing *listing):
+        maxDepth_(parentTask->maxDepth_),
+        ignoreHidden_(parentTask->ignoreHidden_),
+        followSymlink_(parentTask->followSymlink_),
+        parent_(parent),
+        name_(name),
+        listing_(listing),
+        root_(parentTask->root_),
+        group_(parentTask->group_),
+        ready_(parentTask->ready_)
+    {}
+
+    void list()
+    {
+        Ref<Dir> dir = parent_ ? Dir::tryOpenAt(parent_, name_) : Dir::tryOpen(listing_->path_);
+        parent_ = 0;
+        if (dir) {
+            String name;
+            int type = 0;
+            while (dir->read(&name, &type)) {
+                if (name == "." || name == "..") continue;
+                if (ignoreHidden_) if (name->at(0) == '.') continue;
+                bool isDir = false;
+                bool descend = classify(dir, name, type, followSymlink_, &isDir) && listing_->depth_ != maxDepth_;
+                Ref<DirListing> child;
+                if (descend) {
+                    child = new DirListing(dir->path(name), listing_->depth_ + 1);
+                    if (ready_) __atomic_add_fetch(&root_->pending_, 1, __ATOMIC_RELAXED);
+                    group_->run(new DirListTask(this, dir, name, child));
+                }
+                listing_->entries_->append(DirEntry(dir->path(name), isDir, child));
+            }
+        }
+    }
+
+    /** Hand the listing over to the reader, also if listing failed
+      */
+    void complete(bool failed)
+    {
+        parent_ = 0;
+        listing_->failed_ = failed;
+        listing_->finish();
+        if (ready_) ready_->push(listing_);
+    }
+
+    int maxDepth_;
+    bool ignoreHidden_;
+    bool followSymlink_;
+    Ref<Dir> parent_;
+    String name_;
+    Ref<DirListing> listing_;
+    Ref<DirListing> root_;
+    Ref<TaskGroup> group_;
+    Ref< Channel< Ref<DirListing> > > ready_;
+};
+
 Ref<DirWalker> DirWalker::open(String path)
 {
     return new DirWalker(path);
@@ -30,14 +186,23 @@ DirWalker::DirWalker(String path, Dir *dir):
     ignoreHidden_(false),
     followSymlink_(false),
     deleteOrder_(false),
+    parallel_(false),
+    ordered_(true),
     depth_(0),
     dir_(dir)
 {
     if (!dir_) dir_ = Dir::open(path);
 }
 
+DirWalker::~DirWalker()
+{
+    if (group_) group_->cancel();
+}
+
 bool DirWalker::read(String *path, bool *isDir)
 {
+    if (parallel_ || group_) return readParallel(path, isDir);
+
     if (child_) {
         if (child_->read(path, isDir))
             return true;
@@ -50,35 +215,94 @@ bool DirWalker::read(String *path, bool *isDir)
         child_ = 0;
     }
     String name;
-    while (dir_->read(&name)) {
+    int type = 0;
+    while (dir_->read(&name, &type)) {
         if (name == "" || name == "." || name == "..") continue;
         if (ignoreHidden_) if (name->at(0) == '.') continue;
-        String h = dir_->path(name);
-        child_ = tryOpen(h);
-        bool d = child_;
-        if (child_) {
-            if (depth_ != maxDepth_) {
-                if (!followSymlink_ && File::readlink(h) != "") {
-                    child_ = 0;
-                }
-                else {
-                    child_->maxDepth_ = maxDepth_;
-                    child_->followSymlink_ = followSymlink_;
-                    child_->deleteOrder_ = deleteOrder_;
-                    child_->depth_ = depth_ + 1;
-                    if (deleteOrder_)
-                        return read(path, isDir);
-                }
-            }
-            else {
-                child_ = 0;
+        bool d = false;
+        if (classify(dir_, name, type, followSymlink_, &d) && depth_ != maxDepth_) {
+            Ref<Dir> dir = Dir::tryOpenAt(dir_, name);
+            if (dir) {
+                child_ = new DirWalker(dir->path(), dir);
+                child_->maxDepth_ = maxDepth_;
+                child_->ignoreHidden_ = ignoreHidden_;
+                child_->followSymlink_ = followSymlink_;
+                child_->deleteOrder_ = deleteOrder_;
+                child_->depth_ = depth_ + 1;
+                if (deleteOrder_)
+                    return read(path, isDir);
             }
         }
-        *path = h;
+        *path = dir_->path(name);
         if (isDir) *isDir = d;
         return true;
     }
     return false;
 }
 
+bool DirWalker::readParallel(String *path, bool *isDir)
+{
+    if (!group_) {
+        group_ = TaskGroup::create();
+        Ref<DirListing> root = new DirListing(dir_->path(), depth_);
+        if (ordered_ || deleteOrder_) {
+            stack_ = ListingStack::create();
+            stack_->append(root);
+        }
+        else {
+            ready_ = ListingChannel::create();
+            root_ = root;
+        }
+        group_->run(new DirListTask(this, root, group_, ready_));
+    }
+
+    if (stack_) {
+        while (stack_->count() > 0) {
+            Ref<DirListing> top = stack_->at(stack_->count() - 1);
+            top->wait();
+            if (top->failed_) fail();
+            if (top->next_ < top->entries_->count()) {
+                const DirEntry &entry = top->entries_->at(top->next_++);
+                if (entry.child_) {
+                    stack_->append(entry.child_);
+                    if (deleteOrder_) continue;
+                }
+                *path = entry.path_;
+                if (isDir) *isDir = entry.isDir_;
+                return true;
+            }
+            stack_->popBack();
+            if (deleteOrder_ && stack_->count() > 0) {
+                *path = top->path_;
+                if (isDir) *isDir = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    while (true) {
+        if (current_ && current_->next_ < current_->entries_->count()) {
+            const DirEntry &entry = current_->entries_->at(current_->next_++);
+            *path = entry.path_;
+            if (isDir) *isDir = entry.isDir_;
+            return true;
+        }
+        current_ = 0;
+        if (!root_) break;
+        current_ = ready_->pop();
+        if (__atomic_sub_fetch(&root_->pending_, 1, __ATOMIC_ACQ_REL) == 0) root_ = 0;
+        if (current_->failed_) fail();
+    }
+    return false;
+}
+
+/** Report the error which made a listing task fail
+  */
+void DirWalker::fail()
+{
+    group_->wait(); // throws the task's error
+    FLUX_DEBUG_ERROR("Directory listing canceled");
+}
+
 } // namespace flux
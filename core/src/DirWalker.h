@@ -10,12 +10,26 @@
 #define FLUX_DIRWALKER_H
 
 #include <flux/String>
+#include <flux/Channel>
 
 namespace flux {
 
 class Dir;
+class DirListing;
+class TaskGroup;
 
 /** \brief Recursive directory tree walker
+  *
+  * Entries are classified by the file type reported along with the directory entry,
+  * subdirectories are opened relative to their parent.
+  *
+  * In parallel mode the subdirectories are listed ahead of the reader by tasks on
+  * the Executor. By default the entries are delivered in exactly the same order as
+  * in sequential mode. With ordering turned off entries are delivered directory by
+  * directory as soon as they have been listed (delete order implies ordering).
+  * Subdirectories which cannot be opened are skipped in both modes. If listing a
+  * directory fails otherwise, the error is thrown by read() once the reader gets
+  * there (as TaskError in parallel mode).
   * \see Dir
   */
 class DirWalker: public Source<String>
@@ -36,18 +50,39 @@ public:
     inline bool deleteOrder() const { return deleteOrder_; }
     inline void setDeleteOrder(bool on) { deleteOrder_ = on; }
 
+    inline bool parallel() const { return parallel_; }
+    inline void setParallel(bool on) { parallel_ = on; }
+
+    inline bool ordered() const { return ordered_; }
+    inline void setOrdered(bool on) { ordered_ = on; }
+
     bool read(String *path, bool *isDir);
     bool read(String *path) { return read(path, 0); }
 
 private:
     DirWalker(String path, Dir *dir = 0);
+    ~DirWalker();
+
+    bool readParallel(String *path, bool *isDir);
+    void fail();
+
     int maxDepth_;
     bool ignoreHidden_;
     bool followSymlink_;
     bool deleteOrder_;
+    bool parallel_;
+    bool ordered_;
     int depth_;
     Ref<Dir> dir_;
     Ref<DirWalker> child_;
+
+    typedef List< Ref<DirListing> > ListingStack;
+    typedef Channel< Ref<DirListing> > ListingChannel;
+    Ref<TaskGroup> group_;
+    Ref<ListingStack> stack_;
+    Ref<ListingChannel> ready_;
+    Ref<DirListing> current_;
+    Ref<DirListing> root_;
 };
 
 } // namespace flux
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/exceptions>
+#include <flux/EventCount>
+#include "futex.h"
+
+namespace flux {
+
+/** Block until notify() is called or the system time reaches \a timeout (see System::now()),
+  * a negative \a timeout means to wait forever. The \a epoch needs to be obtained by
+  * prepareWait() beforehand. Returns false on timeout.
+  */
+bool EventCount::wait(uint32_t epoch, double timeout)
+{
+    bool success = true;
+    if (epoch_ == epoch) {
+        int ret = futex::wait(&epoch_, epoch, timeout);
+        if (ret == ETIMEDOUT) success = false;
+        else if (ret != 0 && ret != EAGAIN && ret != EINTR) FLUX_SYSTEM_DEBUG_ERROR(ret);
+    }
+    __sync_sub_and_fetch(&waiters_, 1);
+    return success;
+}
+
+void EventCount::wake(int n)
+{
+    futex::wake(&epoch_, n);
+}
+
+} // namespace flux
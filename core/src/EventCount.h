@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_EVENTCOUNT_H
+#define FLUX_EVENTCOUNT_H
+
+#include <flux/types>
+
+namespace flux {
+
+/** \brief Futex-based blocking fallback for lock-free data structures
+  *
+  * A waiting thread first announces itself with prepareWait(), then re-checks its
+  * condition and finally either calls cancelWait() or wait(). A notifying thread
+  * changes the condition and then calls notify(), which only enters the kernel if
+  * there are announced waiters.
+  * \see BoundedChannel
+  */
+class EventCount
+{
+public:
+    EventCount(): epoch_(0), waiters_(0) {}
+
+    inline uint32_t prepareWait() {
+        __sync_add_and_fetch(&waiters_, 1);
+        return __sync_add_and_fetch(&epoch_, 0);
+    }
+
+    inline void cancelWait() {
+        __sync_sub_and_fetch(&waiters_, 1);
+    }
+
+    bool wait(uint32_t epoch, double timeout = -1);
+
+    inline void notify(int n = 1) {
+        __sync_add_and_fetch(&epoch_, 1);
+        if (waiters_ > 0) wake(n);
+    }
+
+    inline void notifyAll() { notify(intMax); }
+
+private:
+    EventCount(const EventCount &);
+    EventCount &operator=(const EventCount &);
+
+    void wake(int n);
+
+    volatile uint32_t epoch_;
+    volatile int waiters_;
+};
+
+} // namespace flux
+
+#endif // FLUX_EVENTCOUNT_H
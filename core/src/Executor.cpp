@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <sched.h>
+#include <exception>
+#include <flux/Thread>
+#include <flux/System>
+#include <flux/TaskGroup>
+#include <flux/Executor>
+
+namespace flux {
+
+/** Chase-Lev work-stealing deque (Lê, Pop, Cohen, Zappa Nardelli: "Correct and Efficient
+  * Work-Stealing for Weak Memory Models", PPoPP 2013). The owner pushes and takes at the
+  * bottom, thieves steal from the top. Retired arrays are kept until destruction,
+  * because concurrent thieves may still read from them.
+  */
+class WorkDeque
+{
+public:
+    WorkDeque():
+        top_(0),
+        bottom_(0),
+        array_(new Array(256, 0))
+    {}
+
+    ~WorkDeque()
+    {
+        for (Array *a = array_; a;) {
+            Array *b = a->retired_;
+            delete a;
+            a = b;
+        }
+    }
+
+    void push(Task *task)
+    {
+        long b = __atomic_load_n(&bottom_, __ATOMIC_RELAXED);
+        long t = __atomic_load_n(&top_, __ATOMIC_ACQUIRE);
+        Array *a = __atomic_load_n(&array_, __ATOMIC_RELAXED);
+        if (b - t > a->size_ - 1) {
+            a = a->grow(t, b);
+            __atomic_store_n(&array_, a, __ATOMIC_RELEASE);
+        }
+        a->put(b, task);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        __atomic_store_n(&bottom_, b + 1, __ATOMIC_RELAXED);
+    }
+
+    Task *take()
+    {
+        long b = __atomic_load_n(&bottom_, __ATOMIC_RELAXED) - 1;
+        Array *a = __atomic_load_n(&array_, __ATOMIC_RELAXED);
+        __atomic_store_n(&bottom_, b, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        long t = __atomic_load_n(&top_, __ATOMIC_RELAXED);
+        Task *task = 0;
+        if (t <= b) {
+            task = a->get(b);
+            if (t == b) {
+                if (!__atomic_compare_exchange_n(&top_, &t, t + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+                    task = 0;
+                __atomic_store_n(&bottom_, b + 1, __ATOMIC_RELAXED);
+            }
+        }
+        else {
+            __atomic_store_n(&bottom_, b + 1, __ATOMIC_RELAXED);
+        }
+        return task;
+    }
+
+    Task *steal(bool *retry)
+    {
+        long t = __atomic_load_n(&top_, __ATOMIC_ACQUIRE);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        long b = __atomic_load_n(&bottom_, __ATOMIC_ACQUIRE);
+        if (t >= b) return 0;
+        Array *a = __atomic_load_n(&array_, __ATOMIC_ACQUIRE);
+        Task *task = a->get(t);
+        if (!__atomic_compare_exchange_n(&top_, &t, t + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            *retry = true;
+            return 0;
+        }
+        return task;
+    }
+
+private:
+    class Array
+    {
+    public:
+        Array(long size, Array *retired):
+            size_(size),
+            mask_(size - 1),
+            tasks_(new Task *[size]),
+            retired_(retired)
+        {}
+
+        ~Array() { delete[] tasks_; }
+
+        inline Task *get(long i) const { return __atomic_load_n(&tasks_[i & mask_], __ATOMIC_RELAXED); }
+        inline void put(long i, Task *task) { __atomic_store_n(&tasks_[i & mask_], task, __ATOMIC_RELAXED); }
+
+        Array *grow(long t, long b)
+        {
+            Array *a = new Array(2 * size_, this);
+            for (long i = t; i < b; ++i) a->put(i, get(i));
+            return a;
+        }
+
+        long size_;
+        long mask_;
+        Task **tasks_;
+        Array *retired_;
+    };
+
+    char pad0_[64];
+    long top_;
+    char pad1_[64];
+    long bottom_;
+    Array *array_;
+};
+
+class ExecutorWorker: public Thread
+{
+public:
+    ExecutorWorker(Executor *executor, int index):
+        executor_(executor),
+        index_(index),
+        seed_(2463534242U + index)
+    {}
+
+    inline uint32_t random() {
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 17;
+        seed_ ^= seed_ << 5;
+        return seed_;
+    }
+
+    Executor *executor_;
+    int index_;
+    uint32_t seed_;
+    WorkDeque deque_;
+
+private:
+    void run();
+};
+
+static FLUX_THREAD_LOCAL ExecutorWorker *currentWorker = 0;
+
+void ExecutorWorker::run()
+{
+    currentWorker = this;
+
+    if (executor_->pinned_) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index_ % System::concurrency(), &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    while (true) {
+        Task *task = executor_->findTask(this);
+        if (task) {
+            executor_->execute(task);
+            continue;
+        }
+        uint32_t epoch = executor_->idle_.prepareWait();
+        if (executor_->shutdown_) {
+            executor_->idle_.cancelWait();
+            break;
+        }
+        task = executor_->findTask(this);
+        if (task) {
+            executor_->idle_.cancelWait();
+            executor_->execute(task);
+            continue;
+        }
+        executor_->idle_.wait(epoch);
+    }
+}
+
+/** Shared executor with one worker thread per core
+  */
+Executor *Executor::instance()
+{
+    return Singleton<Executor>::instance();
+}
+
+Executor::Executor(int concurrency, bool pinned):
+    concurrency_(concurrency > 0 ? concurrency : System::concurrency()),
+    pinned_(pinned),
+    workers_(new ExecutorWorker *[concurrency_]),
+    injection_(BoundedChannel<Task *>::create(0x10000)),
+    shutdown_(false)
+{
+    for (int i = 0; i < concurrency_; ++i) {
+        workers_[i] = new ExecutorWorker(this, i);
+        workers_[i]->incRefCount();
+    }
+    for (int i = 0; i < concurrency_; ++i)
+        workers_[i]->start();
+}
+
+Executor::~Executor()
+{
+    shutdown_ = true;
+    idle_.notifyAll();
+    for (int i = 0; i < concurrency_; ++i)
+        workers_[i]->wait();
+    for (int i = 0; i < concurrency_; ++i)
+        workers_[i]->decRefCount();
+    delete[] workers_;
+}
+
+/** Schedule \a task for execution
+  */
+void Executor::run(Task *task)
+{
+    schedule(task);
+}
+
+/** Check if the calling thread is one of this executor's workers
+  */
+bool Executor::isWorker() const
+{
+    return currentWorker && currentWorker->executor_ == this;
+}
+
+void Executor::schedule(Task *task)
+{
+    task->incRefCount();
+    ExecutorWorker *self = currentWorker;
+    if (self && self->executor_ == this)
+        self->deque_.push(task);
+    else
+        injection_->push(task);
+    idle_.notify();
+}
+
+Task *Executor::findTask(ExecutorWorker *self)
+{
+    Task *task = 0;
+    if (self) {
+        task = self->deque_.take();
+        if (task) return task;
+    }
+    if (injection_->tryPop(&task)) return task;
+
+    int start = self ? self->random() % concurrency_ : 0;
+    bool retry = true;
+    while (retry) {
+        retry = false;
+        for (int k = 0; k < concurrency_; ++k) {
+            ExecutorWorker *victim = workers_[(start + k) % concurrency_];
+            if (victim == self) continue;
+            task = victim->deque_.steal(&retry);
+            if (task) return task;
+        }
+    }
+    return 0;
+}
+
+bool Executor::helpOnce()
+{
+    ExecutorWorker *self = currentWorker;
+    if (self && self->executor_ != this) self = 0;
+    Task *task = findTask(self);
+    if (!task) return false;
+    execute(task);
+    return true;
+}
+
+void Executor::execute(Task *task)
+{
+    TaskGroup *group = task->group_;
+    try {
+        if (!group || !group->canceled_) task->run();
+        else task->skip();
+    }
+    catch (Exception &ex) {
+        if (group) group->fail(ex.message());
+    }
+    catch (std::exception &ex) {
+        if (group) group->fail(ex.what());
+    }
+    catch (...) {
+        if (group) group->fail("Unknown exception");
+    }
+    task->group_ = 0;
+    task->decRefCount();
+    if (group) {
+        group->finish();
+        group->decRefCount();
+    }
+}
+
+} // namespace flux
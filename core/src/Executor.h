@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_EXECUTOR_H
+#define FLUX_EXECUTOR_H
+
+#include <flux/Singleton>
+#include <flux/BoundedChannel>
+#include <flux/EventCount>
+#include <flux/Task>
+
+namespace flux {
+
+class ExecutorWorker;
+
+/** \brief Work-stealing task executor
+  *
+  * Runs tasks on a fixed set of worker threads (one per core by default). Each worker
+  * keeps its own Chase-Lev deque: tasks spawned by a worker are pushed to and taken
+  * from the bottom of its deque, idle workers steal from the top of the others'.
+  * Tasks scheduled from outside the executor go through a shared injection queue.
+  * Optionally the workers are pinned to distinct cores.
+  * \see Task, TaskGroup, parallelFor()
+  */
+class Executor: public Object
+{
+public:
+    static Ref<Executor> create(int concurrency = -1, bool pinned = false) {
+        return new Executor(concurrency, pinned);
+    }
+
+    static Executor *instance();
+
+    ~Executor();
+
+    inline int concurrency() const { return concurrency_; }
+
+    void run(Task *task);
+
+    bool isWorker() const;
+
+private:
+    friend class Singleton<Executor>;
+    friend class TaskGroup;
+    friend class ExecutorWorker;
+
+    Executor(int concurrency = -1, bool pinned = false);
+
+    void schedule(Task *task);
+    Task *findTask(ExecutorWorker *self);
+    bool helpOnce();
+    void execute(Task *task);
+
+    int concurrency_;
+    bool pinned_;
+    ExecutorWorker **workers_;
+    Ref< BoundedChannel<Task *> > injection_;
+    EventCount idle_;
+    volatile bool shutdown_;
+};
+
+} // namespace flux
+
+#endif // FLUX_EXECUTOR_H
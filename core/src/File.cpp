@@ -114,7 +114,7 @@ off_t File::transfer(off_t count, Stream *sink, ByteArray *buf)
         else ret = ::lseek(fd_, 0, SEEK_END);
         if (ret != -1) return count;
     }
-    return Stream::transfer(count, sink, buf);
+    return SystemStream::transfer(count, sink, buf);
 }
 
 class MappedByteArray: public ByteArray
@@ -127,6 +127,7 @@ public:
 
 private:
     friend class MappedByteArray;
+    friend class IoRing;
 
     static int translateOpenFlags(int openFlags);
 
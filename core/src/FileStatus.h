@@ -55,6 +55,8 @@ public:
     inline bool exists() const { return exists_; }
 
 private:
+    friend class IoRing;
+
     FileStatus(int fd);
     FileStatus(String path, bool resolve = true);
 
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/exceptions>
+#include <flux/System>
+#include <flux/SpinLock>
+#include <flux/FutexMutex>
+#include "futex.h"
+
+namespace flux {
+
+static int maxSpinCount()
+{
+    static int n = (System::concurrency() > 1) ? 100 : 0;
+    return n;
+}
+
+void FutexMutex::acquireContended()
+{
+    double t0 = stats_ ? System::now() : 0;
+
+    // spinning only pays off if the owner is running on another core
+    int spinLimit = 2 * spinAverage_ + 10;
+    if (spinLimit > maxSpinCount()) spinLimit = maxSpinCount();
+    int n = 0;
+    while (n < spinLimit) {
+        ++n;
+        if (state_ == 0 && __sync_bool_compare_and_swap(&state_, 0, 1)) {
+            spinAverage_ += (n - spinAverage_) / 8;
+            if (stats_) stats_->waited(System::now() - t0);
+            return;
+        }
+        cpuRelax();
+    }
+    spinAverage_ += (n - spinAverage_) / 8;
+
+    acquireSleeping();
+    if (stats_) stats_->waited(System::now() - t0);
+}
+
+void FutexMutex::acquireSleeping()
+{
+    while (__atomic_exchange_n(&state_, 2, __ATOMIC_ACQUIRE) != 0)
+        futex::wait(&state_, 2);
+}
+
+void FutexMutex::releaseContended(int previous)
+{
+    if (previous == 2) futex::wake(&state_, 1);
+    #ifndef NDEBUG
+    else FLUX_SYSTEM_DEBUG_ERROR(EPERM);
+    #endif
+}
+
+} // namespace flux
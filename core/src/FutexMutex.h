@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_FUTEXMUTEX_H
+#define FLUX_FUTEXMUTEX_H
+
+#include <flux/LockStats>
+
+namespace flux {
+
+class WaitCondition;
+
+/** \brief Embeddable mutual exclusion lock
+  *
+  * A single futex word (U. Drepper: "Futexes Are Tricky", mutex #3): taking and
+  * releasing an uncontended lock is one atomic instruction each, the kernel is only
+  * entered if threads actually need to sleep. Before going to sleep a contending
+  * thread spins for a bounded number of iterations, adapted to how long
+  * the lock was held recently. A FutexMutex needs no heap allocation and can be
+  * a plain member or static variable.
+  * \see Mutex, WaitCondition, Guard
+  */
+class FutexMutex
+{
+public:
+    FutexMutex(LockStats *stats = 0):
+        state_(0),
+        spinAverage_(0),
+        stats_(stats)
+    {}
+
+    inline bool tryAcquire() {
+        bool ok = __sync_bool_compare_and_swap(&state_, 0, 1);
+        if (ok && stats_) stats_->acquired();
+        return ok;
+    }
+
+    inline void acquire() {
+        if (!__sync_bool_compare_and_swap(&state_, 0, 1)) acquireContended();
+        if (stats_) stats_->acquired();
+    }
+
+    inline void release() {
+        int previous = __atomic_exchange_n(&state_, 0, __ATOMIC_RELEASE);
+        if (previous != 1) releaseContended(previous);
+    }
+
+    /// Attach contention counters (pass zero to detach)
+    inline void setStats(LockStats *stats) { stats_ = stats; }
+    inline LockStats *stats() const { return stats_; }
+
+private:
+    friend class WaitCondition;
+
+    FutexMutex(const FutexMutex &);
+    FutexMutex &operator=(const FutexMutex &);
+
+    void acquireContended();
+    void acquireSleeping();
+    void releaseContended(int previous);
+
+    volatile int state_; // 0: free, 1: taken, 2: taken and threads may be sleeping
+    int spinAverage_;
+    LockStats *stats_;
+};
+
+} // namespace flux
+
+#endif // FLUX_FUTEXMUTEX_H
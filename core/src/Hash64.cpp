@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/strings>
+#include <flux/Hash64>
+
+namespace flux {
+
+static const uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t prime3 = 0x165667B19E3779F9ULL;
+static const uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+inline static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline static uint64_t read64(const uint8_t *p)
+{
+    #if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    uint64_t x;
+    memcpy(&x, p, 8);
+    return x;
+    #else
+    uint64_t x = 0;
+    for (int i = 7; i >= 0; --i) x = (x << 8) | p[i];
+    return x;
+    #endif
+}
+
+inline static uint32_t read32(const uint8_t *p)
+{
+    #if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    uint32_t x;
+    memcpy(&x, p, 4);
+    return x;
+    #else
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    #endif
+}
+
+inline static uint64_t hashRound(uint64_t v, uint64_t x)
+{
+    v += x * prime2;
+    v = rotl(v, 31);
+    return v * prime1;
+}
+
+inline static uint64_t merge(uint64_t h, uint64_t v)
+{
+    h ^= hashRound(0, v);
+    return h * prime1 + prime4;
+}
+
+Hash64::Hash64(uint64_t seed):
+    seed_(seed),
+    total_(0),
+    pendingFill_(0)
+{
+    v_[0] = seed + prime1 + prime2;
+    v_[1] = seed + prime2;
+    v_[2] = seed;
+    v_[3] = seed - prime1;
+}
+
+void Hash64::feed(const void *buf, int bufFill)
+{
+    if (bufFill <= 0) return;
+
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
+    const uint8_t *e = p + bufFill;
+    total_ += bufFill;
+
+    if (pendingFill_ + bufFill < 32) {
+        memcpy(pending_ + pendingFill_, p, bufFill);
+        pendingFill_ += bufFill;
+        return;
+    }
+
+    uint64_t v0 = v_[0], v1 = v_[1], v2 = v_[2], v3 = v_[3];
+
+    if (pendingFill_ > 0) {
+        int n = 32 - pendingFill_;
+        memcpy(pending_ + pendingFill_, p, n);
+        p += n;
+        v0 = hashRound(v0, read64(pending_));
+        v1 = hashRound(v1, read64(pending_ + 8));
+        v2 = hashRound(v2, read64(pending_ + 16));
+        v3 = hashRound(v3, read64(pending_ + 24));
+        pendingFill_ = 0;
+    }
+
+    for (; p + 32 <= e; p += 32) {
+        v0 = hashRound(v0, read64(p));
+        v1 = hashRound(v1, read64(p + 8));
+        v2 = hashRound(v2, read64(p + 16));
+        v3 = hashRound(v3, read64(p + 24));
+    }
+
+    v_[0] = v0; v_[1] = v1; v_[2] = v2; v_[3] = v3;
+
+    if (p < e) {
+        pendingFill_ = e - p;
+        memcpy(pending_, p, pendingFill_);
+    }
+}
+
+uint64_t Hash64::sum() const
+{
+    uint64_t h = 0;
+
+    if (total_ >= 32) {
+        h = rotl(v_[0], 1) + rotl(v_[1], 7) + rotl(v_[2], 12) + rotl(v_[3], 18);
+        for (int i = 0; i < 4; ++i)
+            h = merge(h, v_[i]);
+    }
+    else {
+        h = seed_ + prime5;
+    }
+
+    h += total_;
+
+    const uint8_t *p = pending_;
+    const uint8_t *e = pending_ + pendingFill_;
+
+    for (; p + 8 <= e; p += 8) {
+        h ^= hashRound(0, read64(p));
+        h = rotl(h, 27) * prime1 + prime4;
+    }
+
+    if (p + 4 <= e) {
+        h ^= uint64_t(read32(p)) * prime1;
+        h = rotl(h, 23) * prime2 + prime3;
+        p += 4;
+    }
+
+    for (; p < e; ++p) {
+        h ^= (*p) * prime5;
+        h = rotl(h, 11) * prime1;
+    }
+
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    h *= prime3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+} // namespace flux
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_HASH64_H
+#define FLUX_HASH64_H
+
+#include <flux/types>
+#include <flux/strings>
+#include <flux/String>
+
+namespace flux {
+
+/** \brief Fast seeded 64-bit hash sum generator
+  *
+  * Implements the XXH64 algorithm. The hash sum is not cryptographically secure,
+  * but well suited for hash tables, cache keys and deduplication.
+  * Input can be fed in pieces of any size and sum() can be called at any time.
+  * \see Crc32, crypto::Sha1
+  */
+class Hash64
+{
+public:
+    Hash64(uint64_t seed = 0);
+
+    void feed(const void *buf, int bufFill);
+    uint64_t sum() const;
+
+private:
+    uint64_t seed_;
+    uint64_t v_[4];
+    uint64_t total_;
+    uint8_t pending_[32];
+    int pendingFill_;
+};
+
+inline uint64_t hash64(const void *buf, int bufSize, uint64_t seed = 0) {
+    Hash64 h(seed);
+    if (buf) h.feed(buf, bufSize);
+    return h.sum();
+}
+
+inline uint64_t hash64(const char *s) {
+    Hash64 h;
+    if (s) h.feed(s, strlen(s));
+    return h.sum();
+}
+
+inline uint64_t hash64(const ByteArray *buf) {
+    Hash64 h;
+    if (buf) h.feed(buf->bytes(), buf->count());
+    return h.sum();
+}
+
+inline uint64_t hash64(const String &s) { return hash64(s.get()); }
+
+} // namespace flux
+
+#endif // FLUX_HASH64_H
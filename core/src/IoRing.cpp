@@ -0,0 +1,701 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h> // SYS_io_uring_setup, SYS_io_uring_enter, SYS_io_uring_register
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // struct statx
+#include <sys/sysmacros.h> // makedev
+#include <sys/uio.h> // struct iovec
+#include <unistd.h> // syscall, pipe2
+#include <fcntl.h> // AT_FDCWD, F_SETPIPE_SZ, splice
+#include <signal.h> // _NSIG
+#include <errno.h>
+#include <math.h> // modf
+#include <flux/exceptions>
+#include <flux/File>
+#include <flux/Dir>
+#include <flux/IoRing>
+
+namespace flux {
+
+void IoRequest::check() const
+{
+    if (!failed()) return;
+    int errorCode = error();
+    if (errorCode == ECONNRESET || errorCode == EPIPE) throw ConnectionResetByPeer();
+    FLUX_SYSTEM_ERROR(errorCode, path_);
+}
+
+Ref<IoRing> IoRing::create(int entries)
+{
+    Ref<IoRing> ring = tryCreate(entries);
+    if (!ring) FLUX_SYSTEM_DEBUG_ERROR(errno ? errno : ENOSYS);
+    return ring;
+}
+
+/** Setup a new ring with room for \a entries prepared requests, return a null
+  * reference if the kernel does not provide all features needed
+  */
+Ref<IoRing> IoRing::tryCreate(int entries)
+{
+    struct io_uring_params params;
+    memclr(&params, sizeof(params));
+    int fd = ::syscall(SYS_io_uring_setup, entries, &params);
+    if (fd == -1) return 0;
+
+    const int features = IORING_FEAT_SINGLE_MMAP|IORING_FEAT_NODROP|IORING_FEAT_RW_CUR_POS|IORING_FEAT_EXT_ARG;
+    if ((params.features & features) != features) {
+        ::close(fd);
+        errno = ENOSYS;
+        return 0;
+    }
+
+    const int opcodes[] = {
+        IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED, IORING_OP_WRITEV,
+        IORING_OP_ACCEPT, IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_SPLICE,
+        IORING_OP_TIMEOUT, IORING_OP_LINK_TIMEOUT, IORING_OP_ASYNC_CANCEL
+    };
+    const int probeSize = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    Ref<ByteArray> buffer = ByteArray::create(probeSize);
+    memclr(buffer->bytes(), probeSize);
+    struct io_uring_probe *probe = (struct io_uring_probe *)buffer->bytes();
+    bool supported = (::syscall(SYS_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) == 0);
+    for (unsigned i = 0; supported && i < sizeof(opcodes) / sizeof(opcodes[0]); ++i) {
+        int op = opcodes[i];
+        supported = (op <= probe->last_op) && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+    }
+    if (!supported) {
+        ::close(fd);
+        errno = ENOSYS;
+        return 0;
+    }
+
+    Ref<IoRing> ring = new IoRing(fd, &params);
+    if (!ring->cancelsAny()) {
+        errno = ENOSYS;
+        return 0;
+    }
+    return ring;
+}
+
+IoRing::IoRing(int fd, struct io_uring_params *params):
+    fd_(fd),
+    features_(params->features),
+    sqEntries_(params->sq_entries),
+    unsubmitted_(0),
+    inFlight_(0),
+    lastSqe_(0),
+    reaped_(IoCompletion::create()),
+    pipes_(IoStreamList::create()),
+    pipeSize_(0)
+{
+    sqRingSize_ = params->sq_off.array + params->sq_entries * sizeof(unsigned);
+    cqRingSize_ = params->cq_off.cqes + params->cq_entries * sizeof(struct io_uring_cqe);
+    if (cqRingSize_ > sqRingSize_) sqRingSize_ = cqRingSize_;
+    cqRingSize_ = 0; // both rings share a single mapping
+    sqesSize_ = params->sq_entries * sizeof(struct io_uring_sqe);
+
+    sqRing_ = ::mmap(0, sqRingSize_, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sqRing_ == MAP_FAILED) FLUX_SYSTEM_DEBUG_ERROR(errno);
+    cqRing_ = sqRing_;
+    void *sqes = ::mmap(0, sqesSize_, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) FLUX_SYSTEM_DEBUG_ERROR(errno);
+    sqes_ = (struct io_uring_sqe *)sqes;
+
+    char *sq = (char *)sqRing_;
+    sqHead_ = (unsigned *)(sq + params->sq_off.head);
+    sqTail_ = (unsigned *)(sq + params->sq_off.tail);
+    sqMask_ = (unsigned *)(sq + params->sq_off.ring_mask);
+    sqArray_ = (unsigned *)(sq + params->sq_off.array);
+
+    char *cq = (char *)cqRing_;
+    cqHead_ = (unsigned *)(cq + params->cq_off.head);
+    cqTail_ = (unsigned *)(cq + params->cq_off.tail);
+    cqMask_ = (unsigned *)(cq + params->cq_off.ring_mask);
+    cqes_ = (struct io_uring_cqe *)(cq + params->cq_off.cqes);
+}
+
+IoRing::~IoRing()
+{
+    if (inFlight_ > 0) {
+        // buffers must not be released while the kernel may still access them
+        Ref<IoRequest> request = new IoRequest(IoRequest::Cancel);
+        request->internal_ = true;
+        struct io_uring_sqe *sqe = prepare(request, IORING_OP_ASYNC_CANCEL, -1, 1);
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+        try {
+            while (inFlight_ > 0) wait(-1, inFlight_);
+        }
+        catch (...)
+        {}
+    }
+    ::munmap(sqes_, sqesSize_);
+    ::munmap(sqRing_, sqRingSize_);
+    ::close(fd_);
+}
+
+/** Check if the kernel cancels all pending requests at once (Linux 5.19 or newer),
+  * which the destructor relies on
+  */
+bool IoRing::cancelsAny()
+{
+    Ref<IoRequest> request = new IoRequest(IoRequest::Cancel);
+    request->internal_ = true;
+    struct io_uring_sqe *sqe = prepare(request, IORING_OP_ASYNC_CANCEL, -1, 1);
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+    while (!request->done_) wait(-1, 1);
+    return request->result_ != -EINVAL; // older kernels reject any cancel flags
+}
+
+/** Prepare reading into \a buffer from \a stream at \a offset (or the current position)
+  */
+IoRequest *IoRing::read(SystemStream *stream, ByteArray *buffer, off_t offset)
+{
+    IoRequest *request = new IoRequest(IoRequest::Read, buffer);
+    int index = bufferIndex(buffer);
+    struct io_uring_sqe *sqe = prepare(request, (index >= 0) ? IORING_OP_READ_FIXED : IORING_OP_READ, stream);
+    sqe->addr = (uintptr_t)buffer->bytes();
+    sqe->len = buffer->count();
+    sqe->off = offset;
+    if (index >= 0) sqe->buf_index = index;
+    return request;
+}
+
+/** Prepare writing \a data to \a stream at \a offset (or the current position)
+  */
+IoRequest *IoRing::write(SystemStream *stream, const ByteArray *data, off_t offset)
+{
+    IoRequest *request = new IoRequest(IoRequest::Write, const_cast<ByteArray *>(data));
+    int index = bufferIndex(data);
+    struct io_uring_sqe *sqe = prepare(request, (index >= 0) ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE, stream);
+    sqe->addr = (uintptr_t)data->bytes();
+    sqe->len = data->count();
+    sqe->off = offset;
+    if (index >= 0) sqe->buf_index = index;
+    return request;
+}
+
+/** Prepare writing \a parts to \a stream at \a offset (or the current position) in one go
+  */
+IoRequest *IoRing::write(SystemStream *stream, const IoBufferList *parts, off_t offset)
+{
+    IoRequest *request = new IoRequest(IoRequest::Write, ByteArray::create(parts->count() * sizeof(struct iovec)));
+    request->parts_ = const_cast<IoBufferList *>(parts);
+    struct iovec *iov = (struct iovec *)request->buffer_->bytes();
+    for (int i = 0; i < parts->count(); ++i) {
+        iov[i].iov_base = parts->at(i)->bytes();
+        iov[i].iov_len = parts->at(i)->count();
+    }
+    struct io_uring_sqe *sqe = prepare(request, IORING_OP_WRITEV, stream);
+    sqe->addr = (uintptr_t)iov;
+    sqe->len = parts->count();
+    sqe->off = offset;
+    return request;
+}
+
+/** Prepare accepting a new connection on \a listener, the connection is delivered by IoRequest::stream()
+  */
+IoRequest *IoRing::accept(SystemStream *listener)
+{
+    IoRequest *request = new IoRequest(IoRequest::Accept);
+    prepare(request, IORING_OP_ACCEPT, listener);
+    return request;
+}
+
+/** Prepare opening the file \a path (relative to \a dir), the file is delivered by IoRequest::stream()
+  */
+IoRequest *IoRing::open(String path, int flags, int mode, Dir *dir)
+{
+    IoRequest *request = new IoRequest(IoRequest::Open);
+    request->path_ = path;
+    request->flags_ = flags;
+    struct io_uring_sqe *sqe = prepare(request, IORING_OP_OPENAT, dir ? dir->fd() : AT_FDCWD);
+    sqe->addr = (uintptr_t)request->path_->chars();
+    sqe->len = mode;
+    sqe->open_flags = flags;
+    return request;
+}
+
+/** Prepare reading the status of file \a path (relative to \a dir), the status is
+  * delivered by IoRequest::status()
+  */
+IoRequest *IoRing::status(String path, bool resolve, Dir *dir)
+{
+    IoRequest *request = new IoRequest(IoRequest::Status, ByteArray::create(sizeof(struct statx)));
+    request->path_ = path;
+    struct io_uring_sqe *sqe = prepare(request, IORING_OP_STATX, dir ? dir->fd() : AT_FDCWD);
+    sqe->addr = (uintptr_t)request->path_->chars();
+    sqe->len = STATX_BASIC_STATS;
+    sqe->off = (uintptr_t)request->buffer_->bytes();
+    sqe->statx_flags = resolve ? 0 : AT_SYMLINK_NOFOLLOW;
+    return request;
+}
+
+/** Prepare transferring \a size bytes from file \a source at \a offset to \a sink
+  * without copying the data to user space. The data is spliced through a pipe,
+  * which limits the number of bytes transferred by a single request to the pipe's
+  * capacity. IoRequest::result() tells the number of bytes transferred.
+  */
+IoRequest *IoRing::sendFile(SystemStream *sink, SystemStream *source, off_t offset, int size)
+{
+    IoRequest *feed = new IoRequest(IoRequest::SendFile);
+    feed->internal_ = true;
+    takePipe(feed);
+    if (size > pipeSize_) size = pipeSize_;
+
+    IoRequest *request = new IoRequest(IoRequest::SendFile);
+    request->feed_ = feed;
+    request->stream_ = sink;
+
+    struct io_uring_sqe *sqe = prepare(feed, IORING_OP_SPLICE, feed->pipe_[1], 3);
+    sqe->splice_fd_in = source->fd();
+    sqe->splice_off_in = offset;
+    sqe->off = (uint64_t)-1;
+    sqe->len = size;
+    sqe->splice_flags = SPLICE_F_MOVE;
+    link();
+
+    sqe = prepare(request, IORING_OP_SPLICE, sink, 1);
+    sqe->splice_fd_in = feed->pipe_[0]->fd();
+    sqe->splice_off_in = (uint64_t)-1;
+    sqe->off = (uint64_t)-1;
+    sqe->len = size;
+    sqe->splice_flags = SPLICE_F_MOVE;
+
+    return request;
+}
+
+/** Prepare a timer request, which completes with -ETIME after \a interval seconds
+  */
+IoRequest *IoRing::timeout(double interval)
+{
+    IoRequest *request = new IoRequest(IoRequest::Timeout);
+    setTimeout(request, interval);
+    struct io_uring_sqe *sqe = prepare(request, IORING_OP_TIMEOUT, -1);
+    sqe->addr = (uintptr_t)request->timeout_;
+    sqe->len = 1;
+    return request;
+}
+
+/** Prepare canceling the pending \a request
+  */
+IoRequest *IoRing::cancel(IoRequest *target)
+{
+    IoRequest *request = new IoRequest(IoRequest::Cancel);
+    struct io_uring_sqe *sqe = prepare(request, IORING_OP_ASYNC_CANCEL, -1);
+    sqe->addr = (uintptr_t)target;
+    return request;
+}
+
+/** Start the next prepared request only after the last prepared request completed successfully
+  */
+void IoRing::link()
+{
+    if (lastSqe_) lastSqe_->flags |= IOSQE_IO_LINK;
+}
+
+/** Limit the time the last prepared request may take to \a interval seconds,
+  * the request is canceled on expiry.
+  */
+IoRequest *IoRing::linkTimeout(double interval)
+{
+    FLUX_ASSERT(lastSqe_);
+    link();
+    IoRequest *request = new IoRequest(IoRequest::Timeout);
+    setTimeout(request, interval);
+    struct io_uring_sqe *sqe = prepare(request, IORING_OP_LINK_TIMEOUT, -1, 1);
+    sqe->addr = (uintptr_t)request->timeout_;
+    sqe->len = 1;
+    return request;
+}
+
+/** Register \a streams with the ring (should be called while no requests are pending)
+  */
+void IoRing::registerFiles(IoStreamList *streams)
+{
+    if (files_) {
+        if (::syscall(SYS_io_uring_register, fd_, IORING_UNREGISTER_FILES, 0, 0) == -1)
+            FLUX_SYSTEM_DEBUG_ERROR(errno);
+        files_ = 0;
+        fileIndex_ = 0;
+    }
+    if (!streams || streams->count() == 0) return;
+    Ref< Array<int> > fds = Array<int>::create(streams->count());
+    for (int i = 0; i < streams->count(); ++i)
+        fds->at(i) = streams->at(i)->fd();
+    if (::syscall(SYS_io_uring_register, fd_, IORING_REGISTER_FILES, fds->data(), fds->count()) == -1)
+        FLUX_SYSTEM_DEBUG_ERROR(errno);
+    files_ = IoStreamList::create();
+    fileIndex_ = FileIndex::create();
+    for (int i = 0; i < streams->count(); ++i) {
+        files_->append(streams->at(i));
+        fileIndex_->insert(streams->at(i)->fd(), i);
+    }
+}
+
+/** Register \a buffers with the ring (should be called while no requests are pending)
+  */
+void IoRing::registerBuffers(IoBufferList *buffers)
+{
+    if (buffers_) {
+        if (::syscall(SYS_io_uring_register, fd_, IORING_UNREGISTER_BUFFERS, 0, 0) == -1)
+            FLUX_SYSTEM_DEBUG_ERROR(errno);
+        buffers_ = 0;
+        bufferIndex_ = 0;
+    }
+    if (!buffers || buffers->count() == 0) return;
+    Ref< Array<struct iovec> > iov = Array<struct iovec>::create(buffers->count());
+    for (int i = 0; i < buffers->count(); ++i) {
+        iov->at(i).iov_base = buffers->at(i)->bytes();
+        iov->at(i).iov_len = buffers->at(i)->count();
+    }
+    if (::syscall(SYS_io_uring_register, fd_, IORING_REGISTER_BUFFERS, iov->data(), iov->count()) == -1)
+        FLUX_SYSTEM_DEBUG_ERROR(errno);
+    buffers_ = IoBufferList::create();
+    bufferIndex_ = BufferIndex::create();
+    for (int i = 0; i < buffers->count(); ++i) {
+        buffers_->append(buffers->at(i));
+        bufferIndex_->insert(buffers->at(i), i);
+    }
+}
+
+/** Hand over all prepared requests to the kernel
+  * \return number of requests submitted
+  */
+int IoRing::submit()
+{
+    int n = 0;
+    while (unsubmitted_ > 0) {
+        int ret = enter(unsubmitted_, 0, -1);
+        if (ret == 0) break;
+        n += ret;
+    }
+    return n;
+}
+
+/** Submit all prepared requests and wait up to \a timeout seconds for at least
+  * \a minCount requests to complete
+  * \return completed requests
+  */
+Ref<IoCompletion> IoRing::wait(double timeout, int minCount)
+{
+    Ref<IoCompletion> completion = reaped_;
+    reaped_ = IoCompletion::create();
+    reap(completion);
+    while (true) {
+        int need = minCount - completion->count();
+        if (need > inFlight_) need = inFlight_;
+        if (need < 0) need = 0;
+        if (unsubmitted_ == 0 && need == 0) break;
+        bool expired = false;
+        enter(unsubmitted_, need, timeout, &expired);
+        reap(completion);
+        if (expired) break;
+    }
+    return completion;
+}
+
+struct io_uring_sqe *IoRing::prepare(IoRequest *request, int opcode, SystemStream *stream, int reserve)
+{
+    int index = -1;
+    if (fileIndex_) fileIndex_->lookup(stream->fd(), &index);
+    struct io_uring_sqe *sqe = prepare(request, opcode, (index >= 0) ? index : stream->fd(), reserve);
+    if (index >= 0) sqe->flags |= IOSQE_FIXED_FILE;
+    return sqe;
+}
+
+/** Take the next free submission queue entry for \a request, making sure \a reserve
+  * entries are available (so that requests can be linked or timed out without a submit
+  * in between)
+  */
+struct io_uring_sqe *IoRing::prepare(IoRequest *request, int opcode, int fd, int reserve)
+{
+    unsigned need = (reserve < 1) ? 1 : unsigned(reserve);
+    if (need > sqEntries_) need = sqEntries_;
+    while (sqEntries_ - (*sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE)) < need) {
+        if (submit() > 0) continue;
+        // the kernel refuses submissions while completions are backlogged (EBUSY)
+        int inFlight = inFlight_;
+        reap(reaped_);
+        if (inFlight_ < inFlight) continue;
+        if (inFlight_ == unsubmitted_) FLUX_SYSTEM_DEBUG_ERROR(EAGAIN);
+        enter(0, 1, -1);
+        reap(reaped_);
+    }
+    unsigned tail = *sqTail_;
+    unsigned index = tail & *sqMask_;
+    struct io_uring_sqe *sqe = sqes_ + index;
+    memclr(sqe, sizeof(struct io_uring_sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->user_data = (uintptr_t)request;
+    sqArray_[index] = index;
+    __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+
+    request->incRefCount();
+    ++unsubmitted_;
+    ++inFlight_;
+    lastSqe_ = sqe;
+    return sqe;
+}
+
+void IoRing::setTimeout(IoRequest *request, double interval)
+{
+    if (interval < 0) interval = 0;
+    double sec = 0;
+    request->timeout_[1] = modf(interval, &sec) * 1e9;
+    request->timeout_[0] = sec;
+}
+
+/** Submit \a submitCount requests and wait for \a minCount completions (at most \a timeout seconds)
+  * \return number of requests submitted
+  */
+int IoRing::enter(int submitCount, int minCount, double timeout, bool *expired)
+{
+    int flags = 0;
+    void *arg = 0;
+    size_t argSize = _NSIG / 8;
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg eventsArg;
+    if (minCount > 0) {
+        flags |= IORING_ENTER_GETEVENTS;
+        if (timeout >= 0 && timeout != inf) {
+            double sec = 0;
+            ts.tv_nsec = modf(timeout, &sec) * 1e9;
+            ts.tv_sec = sec;
+            memclr(&eventsArg, sizeof(eventsArg));
+            eventsArg.sigmask_sz = _NSIG / 8;
+            eventsArg.ts = (uintptr_t)&ts;
+            flags |= IORING_ENTER_EXT_ARG;
+            arg = &eventsArg;
+            argSize = sizeof(eventsArg);
+        }
+    }
+    int ret = ::syscall(SYS_io_uring_enter, fd_, submitCount, minCount, flags, arg, argSize);
+    if (ret == -1) {
+        if (errno == ETIME) {
+            if (expired) *expired = true;
+            return 0;
+        }
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY) return 0;
+        FLUX_SYSTEM_DEBUG_ERROR(errno);
+    }
+    unsubmitted_ -= ret;
+    lastSqe_ = 0;
+    return ret;
+}
+
+void IoRing::reap(IoCompletion *completion)
+{
+    unsigned head = *cqHead_;
+    unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        struct io_uring_cqe *cqe = cqes_ + (head & *cqMask_);
+        IoRequest *request = (IoRequest *)(uintptr_t)cqe->user_data;
+        int result = cqe->res;
+        __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+        --inFlight_;
+        complete(request, result);
+        if (!request->internal_) completion->append(request);
+        request->decRefCount();
+    }
+}
+
+void IoRing::complete(IoRequest *request, int result)
+{
+    request->done_ = true;
+    request->result_ = result;
+
+    if (request->operation_ == IoRequest::Accept) {
+        if (result >= 0) request->stream_ = SystemStream::create(result);
+    }
+    else if (request->operation_ == IoRequest::Open) {
+        if (result >= 0) request->stream_ = new File(request->path_, request->flags_, result);
+    }
+    else if (request->operation_ == IoRequest::Status) {
+        Ref<FileStatus> status = FileStatus::read(-1);
+        status->path_ = request->path_;
+        if (result == 0) {
+            const struct statx *stx = (const struct statx *)request->buffer_->bytes();
+            status->st_dev = makedev(stx->stx_dev_major, stx->stx_dev_minor);
+            status->st_ino = stx->stx_ino;
+            status->st_mode = stx->stx_mode;
+            status->st_nlink = stx->stx_nlink;
+            status->st_uid = stx->stx_uid;
+            status->st_gid = stx->stx_gid;
+            status->st_rdev = makedev(stx->stx_rdev_major, stx->stx_rdev_minor);
+            status->st_size = stx->stx_size;
+            status->st_blksize = stx->stx_blksize;
+            status->st_blocks = stx->stx_blocks;
+            status->st_atim.tv_sec = stx->stx_atime.tv_sec;
+            status->st_atim.tv_nsec = stx->stx_atime.tv_nsec;
+            status->st_mtim.tv_sec = stx->stx_mtime.tv_sec;
+            status->st_mtim.tv_nsec = stx->stx_mtime.tv_nsec;
+            status->st_ctim.tv_sec = stx->stx_ctime.tv_sec;
+            status->st_ctim.tv_nsec = stx->stx_ctime.tv_nsec;
+            status->exists_ = true;
+        }
+        request->status_ = status;
+        request->buffer_ = 0;
+    }
+    else if (request->operation_ == IoRequest::SendFile && request->feed_) {
+        // a short splice into the pipe cancels the second half, move what is left over by hand
+        IoRequest *feed = request->feed_;
+        if (feed->result_ < 0) {
+            request->result_ = feed->result_;
+        }
+        else if (result >= 0 || result == -ECANCELED) {
+            int moved = (result > 0) ? result : 0;
+            int errorCode = 0;
+            while (moved < feed->result_) {
+                ssize_t ret = ::splice(feed->pipe_[0]->fd(), 0, request->stream_->fd(), 0, feed->result_ - moved, SPLICE_F_MOVE);
+                if (ret == -1) {
+                    if (errno == EINTR) continue;
+                    errorCode = errno;
+                    break;
+                }
+                moved += ret;
+            }
+            request->result_ = (moved == 0 && errorCode != 0) ? -errorCode : moved;
+        }
+        if (request->result_ == feed->result_) returnPipe(feed);
+        request->feed_ = 0;
+    }
+}
+
+int IoRing::bufferIndex(const ByteArray *buffer) const
+{
+    int index = -1;
+    if (bufferIndex_) bufferIndex_->lookup(buffer, &index);
+    return index;
+}
+
+void IoRing::takePipe(IoRequest *request)
+{
+    if (pipes_->count() > 0) {
+        request->pipe_[1] = pipes_->at(pipes_->count() - 1);
+        pipes_->popBack();
+        request->pipe_[0] = pipes_->at(pipes_->count() - 1);
+        pipes_->popBack();
+        return;
+    }
+    int fd[2];
+    if (::pipe2(fd, O_CLOEXEC) == -1) FLUX_SYSTEM_DEBUG_ERROR(errno);
+    request->pipe_[0] = SystemStream::create(fd[0]);
+    request->pipe_[1] = SystemStream::create(fd[1]);
+    if (pipeSize_ == 0) {
+        ::fcntl(fd[1], F_SETPIPE_SZ, 0x100000);
+        pipeSize_ = ::fcntl(fd[1], F_GETPIPE_SZ);
+        if (pipeSize_ <= 0) pipeSize_ = 0x10000;
+    }
+    else {
+        ::fcntl(fd[1], F_SETPIPE_SZ, pipeSize_);
+    }
+}
+
+void IoRing::returnPipe(IoRequest *request)
+{
+    pipes_->append(request->pipe_[0]);
+    pipes_->append(request->pipe_[1]);
+    request->pipe_[0] = 0;
+    request->pipe_[1] = 0;
+}
+
+/** Wrap \a stream into a RingStream writing through \a ring, if a ring is given
+  * (see IoRing::tryCreate()), otherwise return \a stream itself
+  */
+Ref<Stream> RingStream::create(SystemStream *stream, IoRing *ring, int bufferSize)
+{
+    if (!ring) return stream;
+    return new RingStream(stream, ring, bufferSize);
+}
+
+RingStream::RingStream(SystemStream *stream, IoRing *ring, int bufferSize):
+    stream_(stream),
+    ring_(ring),
+    current_(0),
+    fill_(0)
+{
+    buffer_[0] = ByteArray::allocate(bufferSize);
+    buffer_[1] = ByteArray::allocate(bufferSize);
+}
+
+RingStream::~RingStream()
+{
+    try {
+        flush();
+    }
+    catch (...)
+    {}
+}
+
+bool RingStream::readyRead(double interval) const
+{
+    return stream_->readyRead(interval);
+}
+
+int RingStream::read(ByteArray *data)
+{
+    flush();
+    return stream_->read(data);
+}
+
+void RingStream::write(const ByteArray *data)
+{
+    ByteArray *buffer = buffer_[current_];
+    if (fill_ + data->count() > buffer->count()) {
+        submit();
+        if (data->count() > buffer->count()) {
+            complete();
+            stream_->write(data);
+            return;
+        }
+        buffer = buffer_[current_];
+    }
+    memcpy(buffer->bytes() + fill_, data->bytes(), data->count());
+    fill_ += data->count();
+}
+
+void RingStream::write(const StringList *parts)
+{
+    for (int i = 0; i < parts->count(); ++i)
+        write(parts->at(i));
+}
+
+/** Hand over all buffered writes to the kernel and wait for their completion
+  */
+void RingStream::flush()
+{
+    submit();
+    complete();
+}
+
+void RingStream::submit()
+{
+    complete();
+    if (fill_ == 0) return;
+    pending_ = ring_->write(stream_, buffer_[current_]->select(0, fill_));
+    ring_->submit();
+    current_ = 1 - current_;
+    fill_ = 0;
+}
+
+void RingStream::complete()
+{
+    if (!pending_) return;
+    while (!pending_->done()) ring_->wait();
+    Ref<IoRequest> request = pending_;
+    pending_ = 0;
+    request->check();
+    ByteArray *data = request->buffer();
+    if (request->result() < data->count())
+        stream_->write(data->select(request->result(), data->count()));
+}
+
+} // namespace flux
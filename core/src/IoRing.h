@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_IORING_H
+#define FLUX_IORING_H
+
+#include <flux/SystemStream>
+#include <flux/FileStatus>
+#include <flux/Map>
+
+struct io_uring_params;
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace flux {
+
+class Dir;
+class IoRing;
+class IoRequest;
+
+typedef List< Ref<IoRequest> > IoCompletion;
+typedef List< Ref<SystemStream> > IoStreamList;
+typedef List< Ref<ByteArray> > IoBufferList;
+
+/** \brief Asynchronous I/O request
+  * \see IoRing
+  */
+class IoRequest: public Object
+{
+public:
+    enum Operation {
+        Read,
+        Write,
+        Accept,
+        Open,
+        Status,
+        SendFile,
+        Timeout,
+        Cancel
+    };
+
+    inline int operation() const { return operation_; }
+
+    /// request has completed
+    inline bool done() const { return done_; }
+
+    /// number of bytes transferred, file descriptor or negative error code
+    inline int result() const { return result_; }
+
+    inline bool failed() const { return done_ && result_ < 0; }
+    inline int error() const { return result_ < 0 ? -result_ : 0; }
+
+    /// buffer read into or written from
+    inline ByteArray *buffer() const { return buffer_; }
+
+    /// buffers written from by a gathering write
+    inline IoBufferList *parts() const { return parts_; }
+
+    /// accepted connection or opened file
+    inline SystemStream *stream() const { return stream_; }
+
+    /// file status delivered by IoRing::status()
+    inline FileStatus *status() const { return status_; }
+
+    void check() const;
+
+private:
+    friend class IoRing;
+
+    IoRequest(int operation, ByteArray *buffer = 0):
+        operation_(operation),
+        done_(false),
+        result_(0),
+        buffer_(buffer),
+        flags_(0),
+        internal_(false)
+    {
+        timeout_[0] = timeout_[1] = 0;
+    }
+
+    int operation_;
+    bool done_;
+    int result_;
+    Ref<ByteArray> buffer_;
+    Ref<IoBufferList> parts_;
+    Ref<SystemStream> stream_;
+    Ref<FileStatus> status_;
+    String path_;
+    int flags_;
+    bool internal_;
+    int64_t timeout_[2];
+    Ref<IoRequest> feed_;
+    Ref<SystemStream> pipe_[2];
+};
+
+/** \brief Completion queue driven asynchronous I/O (io_uring)
+  *
+  * Requests are prepared by the operations below and handed over to the kernel in
+  * batches by submit() or wait(). Completed requests are reported by wait().
+  * All buffers and streams involved are kept alive until their request completes.
+  *
+  * Streams and buffers registered with the ring are used by index automatically,
+  * which saves the kernel from looking up file descriptors and pinning pages on
+  * each request.
+  *
+  * The ring requires a Linux kernel 5.19 or newer. Where io_uring is not available
+  * (older kernels, io_uring disabled by sysctl or seccomp) tryCreate() returns a
+  * null reference and callers stay with synchronous I/O and IoMonitor.
+  *
+  * A ring is meant to be driven by a single thread.
+  * \see RingStream, IoMonitor
+  */
+class IoRing: public Object
+{
+public:
+    static Ref<IoRing> create(int entries = 256);
+    static Ref<IoRing> tryCreate(int entries = 256);
+    ~IoRing();
+
+    inline int entries() const { return sqEntries_; }
+
+    IoRequest *read(SystemStream *stream, ByteArray *buffer, off_t offset = -1);
+    IoRequest *write(SystemStream *stream, const ByteArray *data, off_t offset = -1);
+    IoRequest *write(SystemStream *stream, const IoBufferList *parts, off_t offset = -1);
+    IoRequest *accept(SystemStream *listener);
+    IoRequest *open(String path, int flags = 0, int mode = 0644, Dir *dir = 0);
+    IoRequest *status(String path, bool resolve = true, Dir *dir = 0);
+    IoRequest *sendFile(SystemStream *sink, SystemStream *source, off_t offset, int size);
+    IoRequest *timeout(double interval);
+    IoRequest *cancel(IoRequest *request);
+
+    void link();
+    IoRequest *linkTimeout(double interval);
+
+    void registerFiles(IoStreamList *streams);
+    void registerBuffers(IoBufferList *buffers);
+
+    int submit();
+    Ref<IoCompletion> wait(double timeout = -1, int minCount = 1);
+
+    /// number of requests not completed, yet
+    inline int pending() const { return inFlight_; }
+
+private:
+    IoRing(int fd, struct io_uring_params *params);
+    bool cancelsAny();
+
+    struct io_uring_sqe *prepare(IoRequest *request, int opcode, SystemStream *stream, int reserve = 2);
+    struct io_uring_sqe *prepare(IoRequest *request, int opcode, int fd, int reserve = 2);
+    void setTimeout(IoRequest *request, double interval);
+    int enter(int submitCount, int minCount, double timeout, bool *expired = 0);
+    void reap(IoCompletion *completion);
+    void complete(IoRequest *request, int result);
+    int bufferIndex(const ByteArray *buffer) const;
+    void takePipe(IoRequest *request);
+    void returnPipe(IoRequest *request);
+
+    int fd_;
+    int features_;
+    unsigned sqEntries_;
+
+    void *sqRing_;
+    size_t sqRingSize_;
+    void *cqRing_;
+    size_t cqRingSize_;
+    struct io_uring_sqe *sqes_;
+    size_t sqesSize_;
+
+    unsigned *sqHead_;
+    unsigned *sqTail_;
+    unsigned *sqMask_;
+    unsigned *sqArray_;
+    unsigned *cqHead_;
+    unsigned *cqTail_;
+    unsigned *cqMask_;
+    struct io_uring_cqe *cqes_;
+
+    int unsubmitted_;
+    int inFlight_;
+    struct io_uring_sqe *lastSqe_;
+
+    typedef Map<int, int> FileIndex;
+    Ref<IoStreamList> files_;
+    Ref<FileIndex> fileIndex_;
+
+    typedef Map<const ByteArray *, int> BufferIndex;
+    Ref<IoBufferList> buffers_;
+    Ref<BufferIndex> bufferIndex_;
+
+    Ref<IoCompletion> reaped_;
+    Ref<IoStreamList> pipes_;
+    int pipeSize_;
+};
+
+/** \brief Synchronous stream facade batching writes through an IoRing
+  *
+  * Writes are collected in a buffer, which is handed over to the kernel as a single
+  * write request once it is full. The caller continues to fill a second buffer while
+  * the first one is written. Writing is completed when a read is requested, flush()
+  * is called or the stream is destroyed. Reads go to the underlying stream directly
+  * after flushing.
+  *
+  * Any number of streams driven by the same thread can share a single ring. Other
+  * requests completing while a stream waits for its writes are marked done, but not
+  * reported by IoRing::wait().
+  * \see IoRing
+  */
+class RingStream: public Stream
+{
+public:
+    static Ref<Stream> create(SystemStream *stream, IoRing *ring, int bufferSize = 0x10000);
+    ~RingStream();
+
+    inline SystemStream *stream() const { return stream_; }
+
+    virtual bool readyRead(double interval) const;
+    virtual int read(ByteArray *data);
+
+    virtual void write(const ByteArray *data);
+    virtual void write(const StringList *parts);
+
+    void flush();
+
+private:
+    RingStream(SystemStream *stream, IoRing *ring, int bufferSize);
+
+    void submit();
+    void complete();
+
+    Ref<SystemStream> stream_;
+    Ref<IoRing> ring_;
+    Ref<ByteArray> buffer_[2];
+    int current_;
+    int fill_;
+    Ref<IoRequest> pending_;
+};
+
+} // namespace flux
+
+#endif // FLUX_IORING_H
@@ -6,6 +6,7 @@
  *
  */
 
+#include <flux/strings>
 #include <flux/LineSource>
 
 namespace flux {
@@ -25,6 +26,7 @@ LineSource::LineSource(Stream *stream, ByteArray *buf)
       i_(0), n_(0)
 {
     if (!buf) buf_ = ByteArray::allocate(0x4000);
+    else if (!stream) n_ = buf->count();
 }
 
 bool LineSource::read(String *line)
@@ -34,38 +36,29 @@ bool LineSource::read(String *line)
         return false;
     }
 
-    Ref<StringList> backlog;
+    int j = i_;
 
     while (true) {
-        if (i_ < n_) {
-            int i0 = i_;
-            i_ = findEol(buf_, n_, i_);
-            if (i_ < n_) {
-                if (backlog) {
-                    backlog->append(buf_->copy(i0, i_));
-                    *line = backlog->join();
-                }
-                else {
-                    *line = buf_->copy(i0, i_);
-                }
-                i_ = skipEol(buf_, n_, i_);
-                return true;
+        j += memscan(reinterpret_cast<const char *>(buf_->bytes()) + j, n_ - j, '\n', '\r');
+        if (j < n_) {
+            if (j + 1 == n_ && buf_->at(j) == '\r' && stream_) {
+                int m = j - i_;
+                if (fill()) j = i_ + m;
             }
-            if (!backlog)
-                backlog = StringList::create();
-            backlog->append(buf_->copy(i0, i_));
+            *line = buf_->copy(i_, j);
+            i_ = skipEol(buf_, n_, j);
+            return true;
         }
-
         if (!stream_) break;
-
-        n_ = stream_->read(buf_);
-        if (n_ == 0) break;
-        i_ = 0;
+        int m = j - i_;
+        if (!fill()) break;
+        j = i_ + m;
     }
 
     eoi_ = true;
-    if (backlog) {
-        *line = backlog->join();
+    if (i_ < n_) {
+        *line = buf_->copy(i_, n_);
+        i_ = n_;
         return true;
     }
     *line = String();
@@ -85,14 +78,21 @@ String LineSource::pendingData() const
     return buf_->copy(i_, n_);
 }
 
-int LineSource::findEol(ByteArray *buf, int n, int i) const
+/** Move the unread part of the buffer to its front and append the next block
+  * read from the stream, growing the buffer if it is filled up by a single line
+  */
+bool LineSource::fill()
 {
-    for (; i < n; ++i) {
-        char ch = buf->at(i);
-        if (ch == '\n' || ch == '\r')
-            break;
+    if (i_ > 0) {
+        memmove(buf_->bytes(), buf_->bytes() + i_, n_ - i_);
+        n_ -= i_;
+        i_ = 0;
     }
-    return i;
+    if (n_ == buf_->count()) buf_->resize(n_ > 0 ? 2 * n_ : 0x4000);
+    int n = stream_->read(buf_->select(n_, buf_->count()));
+    if (n == 0) return false;
+    n_ += n;
+    return true;
 }
 
 int LineSource::skipEol(ByteArray *buf, int n, int i) const
@@ -15,6 +15,10 @@
 namespace flux {
 
 /** \brief Line input buffer
+  *
+  * Lines may be terminated by "\n", "\r\n" or "\r". The buffer grows if a single
+  * line does not fit into it.
+  * \see BufferedStream
   */
 class LineSource: public Source<String>
 {
@@ -33,7 +37,7 @@ public:
 private:
     LineSource(Stream *stream, ByteArray *buf);
 
-    int findEol(ByteArray *buf, int n, int i) const;
+    bool fill();
     int skipEol(ByteArray *buf, int n, int i) const;
 
     Ref<Stream> stream_;
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <sched.h>
+#include <flux/LockStats>
+
+namespace flux {
+
+// plain statics: zero-initialized before any constructor runs
+static LockStats *registryHead = 0;
+static volatile int registryLock = 0;
+
+void LockStats::lockRegistry()
+{
+    while (__sync_lock_test_and_set(&registryLock, 1)) sched_yield();
+}
+
+void LockStats::unlockRegistry()
+{
+    __sync_lock_release(&registryLock);
+}
+
+LockStats::LockStats(const char *name):
+    name_(name),
+    acquisitions_(0),
+    contentions_(0),
+    waitTime_(0),
+    prev_(0),
+    next_(0)
+{
+    lockRegistry();
+    next_ = registryHead;
+    if (next_) next_->prev_ = this;
+    registryHead = this;
+    unlockRegistry();
+}
+
+LockStats::~LockStats()
+{
+    lockRegistry();
+    if (prev_) prev_->next_ = next_;
+    else registryHead = next_;
+    if (next_) next_->prev_ = prev_;
+    unlockRegistry();
+}
+
+void LockStats::reset()
+{
+    acquisitions_ = 0;
+    contentions_ = 0;
+    waitTime_ = 0;
+}
+
+/** First of all living LockStats objects (the most recently created one)
+  */
+LockStats *LockStats::first()
+{
+    return registryHead;
+}
+
+void LockStats::waited(double duration)
+{
+    __sync_add_and_fetch(&contentions_, 1);
+    __sync_add_and_fetch(&waitTime_, uint64_t(duration * 1e9));
+}
+
+} // namespace flux
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_LOCKSTATS_H
+#define FLUX_LOCKSTATS_H
+
+#include <flux/types>
+
+namespace flux {
+
+/** \brief Contention counters of a lock
+  *
+  * Counting is opt-in: a lock only updates its statistics if a LockStats object
+  * has been attached to it (see FutexMutex::setStats()). All living LockStats objects
+  * are listed by first() and next(), which allows to find hot locks at runtime.
+  * \see FutexMutex, ReadWriteLock
+  */
+class LockStats
+{
+public:
+    LockStats(const char *name);
+    ~LockStats();
+
+    inline const char *name() const { return name_; }
+
+    /// Number of times the lock was taken
+    inline uint64_t acquisitions() const { return acquisitions_; }
+
+    /// Number of times a thread needed to wait for the lock
+    inline uint64_t contentions() const { return contentions_; }
+
+    /// Total time spent waiting for the lock (in seconds)
+    inline double waitTime() const { return waitTime_ * 1e-9; }
+
+    void reset();
+
+    static LockStats *first();
+    inline LockStats *next() const { return next_; }
+
+    inline void acquired() { __sync_add_and_fetch(&acquisitions_, 1); }
+    void waited(double duration);
+
+private:
+    LockStats(const LockStats &);
+    LockStats &operator=(const LockStats &);
+
+    static void lockRegistry();
+    static void unlockRegistry();
+
+    const char *name_;
+    volatile uint64_t acquisitions_;
+    volatile uint64_t contentions_;
+    volatile uint64_t waitTime_;
+    LockStats *prev_;
+    LockStats *next_;
+};
+
+} // namespace flux
+
+#endif // FLUX_LOCKSTATS_H
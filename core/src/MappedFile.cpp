@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <fcntl.h> // posix_fadvise
+#include <errno.h>
+#include <flux/exceptions>
+#include <flux/System>
+#include <flux/MappedFile>
+
+namespace flux {
+
+class MappedRange: public ByteArray
+{
+public:
+    MappedRange(void *base, size_t length, char *data, int size):
+        ByteArray(data, size, keep),
+        base_(base),
+        length_(length)
+    {}
+
+    ~MappedRange()
+    {
+        ::munmap(base_, length_);
+    }
+
+    bool isZeroTerminated() const { return false; }
+
+private:
+    static void keep(ByteArray *) {}
+
+    void *base_;
+    size_t length_;
+};
+
+Ref<MappedFile> MappedFile::open(String path, int advice, int options, int windowSize)
+{
+    return new MappedFile(File::open(path), advice, options, windowSize);
+}
+
+Ref<MappedFile> MappedFile::open(File *file, int advice, int options, int windowSize)
+{
+    return new MappedFile(file, advice, options, windowSize);
+}
+
+static const int hugePageSize = 0x200000;
+
+MappedFile::MappedFile(File *file, int advice, int options, int windowSize):
+    file_(file),
+    advice_(advice),
+    options_(options),
+    windowSize_(windowSize),
+    size_(file->status()->size()),
+    offset_(0)
+{
+    int alignment = (options_ & HugePages) ? hugePageSize : System::pageSize();
+    if (windowSize_ <= 0) windowSize_ = 0x1000000;
+    windowSize_ = (windowSize_ + alignment - 1) / alignment * alignment;
+}
+
+/** Map \a count bytes starting at \a offset (clipped to the end of file)
+  */
+Ref<ByteArray> MappedFile::map(off_t offset, int count)
+{
+    if (offset < 0) offset = 0;
+    if (offset > size_) offset = size_;
+    if (count < 0 || count > size_ - offset) count = size_ - offset;
+    if (count == 0) return ByteArray::create();
+
+    off_t offset0 = offset - offset % System::pageSize();
+    size_t length = count + (offset - offset0);
+
+    int flags = MAP_PRIVATE;
+    #ifdef MAP_POPULATE
+    if (options_ & Populate) flags |= MAP_POPULATE;
+    #endif
+
+    void *p = 0;
+    if ((options_ & HugePages) && length >= size_t(hugePageSize)) {
+        #ifndef MAP_ANONYMOUS
+        #define MAP_ANONYMOUS MAP_ANON
+        #endif
+        size_t reserve = length + hugePageSize;
+        void *q = ::mmap(0, reserve, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (q == MAP_FAILED) FLUX_SYSTEM_DEBUG_ERROR(errno);
+        char *a = reinterpret_cast<char *>((size_t(q) + hugePageSize - 1) & ~size_t(hugePageSize - 1));
+        p = ::mmap(a, length, PROT_READ, flags | MAP_FIXED, file_->fd(), offset0);
+        if (p == MAP_FAILED) {
+            int error = errno;
+            ::munmap(q, reserve);
+            FLUX_SYSTEM_ERROR(error, file_->path());
+        }
+        char *b = a + (length + hugePageSize - 1) / hugePageSize * hugePageSize;
+        if (a > reinterpret_cast<char *>(q)) ::munmap(q, a - reinterpret_cast<char *>(q));
+        if (b < reinterpret_cast<char *>(q) + reserve) ::munmap(b, reinterpret_cast<char *>(q) + reserve - b);
+        #ifdef MADV_HUGEPAGE
+        ::madvise(p, length, MADV_HUGEPAGE);
+        #endif
+        length = b - a;
+    }
+    else {
+        p = ::mmap(0, length, PROT_READ, flags, file_->fd(), offset0);
+        if (p == MAP_FAILED) FLUX_SYSTEM_ERROR(errno, file_->path());
+    }
+
+    if (advice_ != Normal) ::madvise(p, length, advice_);
+
+    return new MappedRange(p, length, reinterpret_cast<char *>(p) + (offset - offset0), count);
+}
+
+/** Map the next window of the file
+  * \return false at end of file
+  */
+bool MappedFile::read(String *window)
+{
+    if (offset_ >= size_) {
+        *window = String();
+        return false;
+    }
+    off_t offset = offset_;
+    off_t count = windowSize_;
+    if (count > size_ - offset) count = size_ - offset;
+    offset_ += count;
+    if (advice_ == Sequential && offset_ < size_) willNeed(offset_, windowSize_);
+    Ref<ByteArray> next = map(offset, count);
+    *window = next;
+    if ((options_ & DropBehind) && offset > 0) {
+        off_t previous = offset - windowSize_;
+        if (previous < 0) previous = 0;
+        dontNeed(previous, offset - previous);
+    }
+    return true;
+}
+
+/** Start reading \a count bytes at \a offset into the page cache in the background
+  */
+void MappedFile::willNeed(off_t offset, off_t count)
+{
+    #ifdef POSIX_FADV_WILLNEED
+    ::posix_fadvise(file_->fd(), offset, count, POSIX_FADV_WILLNEED);
+    #endif
+}
+
+/** Evict \a count bytes at \a offset from the page cache (pages still mapped are kept)
+  */
+void MappedFile::dontNeed(off_t offset, off_t count)
+{
+    #ifdef POSIX_FADV_DONTNEED
+    ::posix_fadvise(file_->fd(), offset, count, POSIX_FADV_DONTNEED);
+    #endif
+}
+
+} // namespace flux
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_MAPPEDFILE_H
+#define FLUX_MAPPEDFILE_H
+
+#include <sys/mman.h> // MADV_*
+#include <flux/generics>
+#include <flux/File>
+
+namespace flux {
+
+/** \brief Memory mapped read access to a file
+  *
+  * map() maps an arbitrary range of the file. read() streams through the file in
+  * windows of windowSize() bytes. Each window is unmapped as soon as the caller
+  * drops it, so files of any size can be processed with a bounded resident set.
+  * In Sequential mode the window following the current one is prefetched
+  * asynchronously (POSIX_FADV_WILLNEED).
+  *
+  * The mapped ranges are not terminated by zero and stay valid independently of
+  * the MappedFile. Mappings are private and read-only.
+  * \see File::map()
+  */
+class MappedFile: public Source<String>
+{
+public:
+    enum Advice {
+        Normal     = MADV_NORMAL,
+        Sequential = MADV_SEQUENTIAL,
+        Random     = MADV_RANDOM
+    };
+
+    enum Options {
+        Populate   = 1, ///< prefault the pages of each mapping (MAP_POPULATE)
+        HugePages  = 2, ///< align mappings to huge pages and ask for transparent huge pages
+        DropBehind = 4  ///< evict windows passed by read() from the page cache
+    };
+
+    static Ref<MappedFile> open(String path, int advice = Sequential, int options = 0, int windowSize = 0);
+    static Ref<MappedFile> open(File *file, int advice = Sequential, int options = 0, int windowSize = 0);
+
+    inline File *file() const { return file_; }
+    inline off_t size() const { return size_; }
+    inline int windowSize() const { return windowSize_; }
+
+    /// file offset of the next window delivered by read()
+    inline off_t offset() const { return offset_; }
+    inline void seek(off_t offset) { offset_ = offset; }
+
+    Ref<ByteArray> map(off_t offset, int count);
+    bool read(String *window);
+
+    void willNeed(off_t offset, off_t count);
+    void dontNeed(off_t offset, off_t count);
+
+private:
+    MappedFile(File *file, int advice, int options, int windowSize);
+
+    Ref<File> file_;
+    int advice_;
+    int options_;
+    int windowSize_;
+    off_t size_;
+    off_t offset_;
+};
+
+} // namespace flux
+
+#endif // FLUX_MAPPEDFILE_H
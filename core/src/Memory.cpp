@@ -12,7 +12,7 @@
 #include <new>
 #include <flux/check>
 #include <flux/types>
-#include <flux/Mutex>
+#include <flux/FutexMutex>
 #include <flux/Memory>
 
 #ifndef MAP_ANONYMOUS
@@ -41,7 +41,7 @@ void Memory::operator delete(void *data, size_t size)
     check(::munmap(data, ::sysconf(_SC_PAGE_SIZE)) == 0);
 }
 
-class Memory::BucketHeader: public Mutex
+class Memory::BucketHeader: public FutexMutex
 {
 public:
     uint32_t bytesDirty_;
@@ -9,30 +9,23 @@
 #ifndef FLUX_MUTEX_H
 #define FLUX_MUTEX_H
 
-#include <pthread.h>
 #include <flux/generics>
+#include <flux/FutexMutex>
 
 namespace flux {
 
-class WaitCondition;
-class ScopeGuard;
-
 /** \brief Thread synchronization primitive: mutual exclusive access
+  *
+  * Reference counted variant of FutexMutex.
+  * \see WaitCondition, Guard
   */
-class Mutex: public Object, public NonCopyable
+class Mutex: public Object, public FutexMutex, public NonCopyable
 {
 public:
-    inline static Ref<Mutex> create() { return new Mutex; }
-    ~Mutex();
-
-    bool tryAcquire();
-    void acquire();
-    void release();
+    inline static Ref<Mutex> create(LockStats *stats = 0) { return new Mutex(stats); }
 
 protected:
-    friend class WaitCondition;
-    Mutex();
-    pthread_mutex_t mutex_;
+    Mutex(LockStats *stats = 0): FutexMutex(stats) {}
 };
 
 } // namespace flux
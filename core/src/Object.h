@@ -20,11 +20,18 @@ namespace flux {
   *   - combination of static allocation and dynamic destruction
   *   - manual detruction by delete operator
   * In debug mode in both cases a DebugException is thrown.
+  *
+  * The reference count is maintained by atomic operations by default. An object, which
+  * is confined to a single thread, can be marked thread-local right after allocation
+  * (setThreadLocal()) to have its reference count maintained by plain increments and
+  * decrements instead. Before any other thread may get hold of a reference the object
+  * needs to be made shared again. Channel::transfer() does so while handing an object
+  * over to the receiving thread.
   */
 class Object
 {
 public:
-    Object(): refCount_(0) {}
+    Object(): refCount_(0), threadLocal_(false) {}
 
     virtual ~Object() {
         FLUX_ASSERT2(refCount_ == 0, "Deleting object, which is still in use");
@@ -32,12 +39,19 @@ public:
 
     inline int refCount() const { return refCount_; }
 
+    inline bool isThreadLocal() const { return threadLocal_; }
+    inline void setThreadLocal(bool on) const { threadLocal_ = on; }
+
     inline void incRefCount() const {
-        __sync_add_and_fetch(&refCount_, 1);
+        if (threadLocal_) ++refCount_;
+        else __sync_add_and_fetch(&refCount_, 1);
     }
 
     inline void decRefCount() const {
-        if (__sync_sub_and_fetch(&refCount_, 1) == 0)
+        if (threadLocal_) {
+            if (--refCount_ == 0) delete this;
+        }
+        else if (__sync_sub_and_fetch(&refCount_, 1) == 0)
             delete this;
     }
 
@@ -46,6 +60,7 @@ private:
     const Object &operator=(const Object &);
 
     mutable volatile int refCount_;
+    mutable bool threadLocal_;
 };
 
 } // namespace flux
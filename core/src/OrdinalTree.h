@@ -298,7 +298,7 @@ void OrdinalTree<Node>::pop(int index, Item *item)
     Node *ko = 0;
     if (!lookupByIndex(index, &ko))
         FLUX_ASSERT(false);
-    *item = ko->item_;
+    move(*item, ko->item_);
     Node *k = static_cast<Node *>(BinaryTree::pred(ko));
     if (k) --index;
     else k = static_cast<Node *>(BinaryTree::succ(ko));
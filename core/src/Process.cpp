@@ -24,6 +24,7 @@
 #endif
 #include <flux/exceptions>
 #include <flux/Format>
+#include <flux/stdio>
 #include <flux/Thread>
 #include <flux/ProcessFactory>
 #include <flux/Process>
@@ -338,6 +339,7 @@ void Process::exit(int exitCode)
 
 void Process::daemonize()
 {
+    flushStdOut();
     pid_t pid = ::fork();
     if (pid == -1) FLUX_SYSTEM_DEBUG_ERROR(errno);
     if (pid != 0) ::exit(0);
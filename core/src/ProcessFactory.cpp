@@ -13,11 +13,19 @@
 #include <fcntl.h> // open
 #include <stdlib.h> // exit, posix_openpt, grantpt, unlockpt
 #include <termios.h> // tcgetattr, tcsetattr
+#include <spawn.h> // posix_spawn
 #include <flux/Format>
 #include <flux/File>
+#include <flux/stdio>
 #include <flux/exceptions>
 #include <flux/ProcessFactory>
 
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 29)
+#define FLUX_SPAWN_CHDIR // posix_spawn_file_actions_addchdir_np()
+#endif
+#endif
+
 namespace flux {
 
 ProcessFactory::ProcessFactory(int type):
@@ -62,11 +70,35 @@ void ProcessFactory::setCommand(String command)
     setExecPath(path);
 }
 
+/** Close the descriptors of \a fd which are open (not -1)
+  */
+static void closeAll(const int *fd, int n)
+{
+    for (int i = 0; i < n; ++i)
+        if (fd[i] != -1) ::close(fd[i]);
+}
+
+/** Release the argument list and the environment built by produce()
+  */
+static void freeAll(char **argv, char **envp, bool ownEnv)
+{
+    if (argv) {
+        for (int i = 0; argv[i]; ++i)
+            flux::free(argv[i]);
+        delete[] argv;
+    }
+    if (ownEnv && envp) {
+        for (int i = 0; envp[i]; ++i)
+            flux::free(envp[i]);
+        delete[] envp;
+    }
+}
+
 Ref<Process> ProcessFactory::produce()
 {
-    int inputPipe[2];
-    int outputPipe[2];
-    int errorPipe[2];
+    int inputPipe[2] = { -1, -1 };
+    int outputPipe[2] = { -1, -1 };
+    int errorPipe[2] = { -1, -1 };
 
     int ptyMaster = -1, ptySlave = -1;
 
@@ -81,17 +113,17 @@ Ref<Process> ProcessFactory::produce()
     }
     else
     {
-        if (ioPolicy_ & Process::ForwardInput)
-            if (::pipe(inputPipe) == -1)
-                FLUX_SYSTEM_DEBUG_ERROR(errno);
-
-        if (ioPolicy_ & Process::ForwardOutput)
-            if (::pipe(outputPipe) == -1)
-                FLUX_SYSTEM_DEBUG_ERROR(errno);
-
-        if (ioPolicy_ & Process::ForwardError)
-            if (::pipe(errorPipe) == -1)
-                FLUX_SYSTEM_DEBUG_ERROR(errno);
+        if (
+            ((ioPolicy_ & Process::ForwardInput) && ::pipe(inputPipe) == -1) ||
+            ((ioPolicy_ & Process::ForwardOutput) && ::pipe(outputPipe) == -1) ||
+            ((ioPolicy_ & Process::ForwardError) && ::pipe(errorPipe) == -1)
+        ) {
+            int errorCode = errno;
+            closeAll(inputPipe, 2);
+            closeAll(outputPipe, 2);
+            closeAll(errorPipe, 2);
+            FLUX_SYSTEM_DEBUG_ERROR(errorCode);
+        }
     }
 
     char **argv = 0, **envp = 0;
@@ -131,7 +163,9 @@ Ref<Process> ProcessFactory::produce()
         }
     }
 
-    int ret = ::fork();
+    flushStdOut();
+
+    int ret = spawnable() ? spawn(argv, envp, inputPipe, outputPipe, errorPipe) : ::fork();
 
     if (ret == 0)
     {
@@ -223,16 +257,7 @@ Ref<Process> ProcessFactory::produce()
     {
         // parent process
 
-        if (argv) {
-            for (int i = 0; argv[i]; ++i)
-                flux::free(argv[i]);
-            delete[] argv;
-        }
-        if (envMap_) {
-            for (int i = 0; envp[i]; ++i)
-                flux::free(envp[i]);
-            delete[] envp;
-        }
+        freeAll(argv, envp, envMap_);
 
         Ref<SystemStream> in = in_;
         Ref<SystemStream> out = out_;
@@ -271,13 +296,105 @@ Ref<Process> ProcessFactory::produce()
     }
     else if (ret < 0)
     {
-        FLUX_SYSTEM_DEBUG_ERROR(errno);
+        // failed to fork or to load the program
+
+        int errorCode = errno;
+        freeAll(argv, envp, envMap_);
+        closeAll(inputPipe, 2);
+        closeAll(outputPipe, 2);
+        closeAll(errorPipe, 2);
+        if (ptyMaster != -1) ::close(ptyMaster);
+        if (ptySlave != -1) ::close(ptySlave);
+        FLUX_SYSTEM_ERROR(errorCode, execPath_);
     }
 
     FLUX_ASSERT(0 == 1);
     return 0;
 }
 
+/** Check if the child can be launched without fork()ing the address space of the parent
+  */
+bool ProcessFactory::spawnable() const
+{
+    if (execPath_ == "") return false; // custom child hook, see incarnate()
+    if (ioPolicy_ & Process::ForwardByPseudoTerminal) return false;
+    if (fileCreationMask_ >= 0) return false;
+#ifndef POSIX_SPAWN_SETSID
+    if (type_ == Process::SessionLeader) return false;
+#endif
+#ifndef FLUX_SPAWN_CHDIR
+    if (workingDirectory_ != "") return false;
+#endif
+    return true;
+}
+
+/** Launch the child by posix_spawn(), which suspends the parent instead of copying its page tables
+  * (clone(CLONE_VM|CLONE_VFORK) in current C libraries). Mirrors the child side of produce().
+  * Returns the process ID of the child or -1 (errno set).
+  */
+int ProcessFactory::spawn(char **argv, char **envp, int *inputPipe, int *outputPipe, int *errorPipe)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    ::posix_spawn_file_actions_init(&actions);
+    ::posix_spawnattr_init(&attr);
+
+    short flags = 0;
+    if (type_ == Process::GroupLeader) {
+        flags |= POSIX_SPAWN_SETPGROUP;
+        ::posix_spawnattr_setpgroup(&attr, 0);
+    }
+#ifdef POSIX_SPAWN_SETSID
+    else if (type_ == Process::SessionLeader)
+        flags |= POSIX_SPAWN_SETSID;
+#endif
+    if (signalMask_) {
+        flags |= POSIX_SPAWN_SETSIGMASK;
+        ::posix_spawnattr_setsigmask(&attr, signalMask_->rawSet());
+    }
+    ::posix_spawnattr_setflags(&attr, flags);
+
+#ifdef FLUX_SPAWN_CHDIR
+    if (workingDirectory_ != "")
+        ::posix_spawn_file_actions_addchdir_np(&actions, workingDirectory_);
+#endif
+
+    if (ioPolicy_ & Process::CloseInput) ::posix_spawn_file_actions_addclose(&actions, 0);
+    if (ioPolicy_ & Process::CloseOutput) ::posix_spawn_file_actions_addclose(&actions, 1);
+    if (ioPolicy_ & Process::CloseError) ::posix_spawn_file_actions_addclose(&actions, 2);
+
+    if (in_) ::posix_spawn_file_actions_adddup2(&actions, in_->fd(), 0);
+    if (out_) ::posix_spawn_file_actions_adddup2(&actions, out_->fd(), 1);
+    if (err_) ::posix_spawn_file_actions_adddup2(&actions, err_->fd(), 2);
+
+    if (ioPolicy_ & Process::ForwardInput) {
+        ::posix_spawn_file_actions_addclose(&actions, inputPipe[1]);
+        ::posix_spawn_file_actions_adddup2(&actions, inputPipe[0], 0);
+    }
+    if (ioPolicy_ & Process::ForwardOutput) {
+        ::posix_spawn_file_actions_addclose(&actions, outputPipe[0]);
+        ::posix_spawn_file_actions_adddup2(&actions, outputPipe[1], 1);
+    }
+    if (ioPolicy_ & Process::ForwardError) {
+        ::posix_spawn_file_actions_addclose(&actions, errorPipe[0]);
+        ::posix_spawn_file_actions_adddup2(&actions, errorPipe[1], 2);
+    }
+
+    if (ioPolicy_ & Process::ErrorToOutput) ::posix_spawn_file_actions_adddup2(&actions, 1, 2);
+
+    pid_t pid = -1;
+    int ret = ::posix_spawn(&pid, execPath_, &actions, &attr, argv, envp);
+
+    ::posix_spawnattr_destroy(&attr);
+    ::posix_spawn_file_actions_destroy(&actions);
+
+    if (ret != 0) {
+        errno = ret;
+        return -1;
+    }
+    return pid;
+}
+
 int ProcessFactory::incarnate() { return 0; }
 
 } // namespace flux
@@ -19,6 +19,11 @@ namespace flux {
 class SystemStream;
 
 /** \brief Child process factory
+  *
+  * Programs are launched by posix_spawn(), which does not copy the page tables of the
+  * parent process and therefore costs the same regardless of the parent's size.
+  * produce() falls back to fork() for custom child processes (see incarnate()),
+  * pseudo-terminal forwarding and file creation masks.
   * \see ThreadFactory
   */
 class ProcessFactory: public Object
@@ -53,6 +58,9 @@ protected:
     ProcessFactory(int type = Process::GroupMember);
 
 private:
+    bool spawnable() const;
+    int spawn(char **argv, char **envp, int *inputPipe, int *outputPipe, int *errorPipe);
+
     int type_;
     int ioPolicy_;
     String workingDirectory_;
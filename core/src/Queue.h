@@ -85,7 +85,7 @@ public:
         T h;
         if (!item) item = &h;
         Node *node = tail_;
-        *item = node->item_;
+        move(*item, node->item_);
         tail_ = node->prev_;
         if (!tail_) head_ = 0;
         else tail_->next_ = 0;
@@ -100,7 +100,7 @@ public:
         T h;
         if (!item) item = &h;
         Node *node = head_;
-        *item = node->item_;
+        move(*item, node->item_);
         head_ = node->next_;
         if (!head_) tail_ = 0;
         else head_->prev_ = 0;
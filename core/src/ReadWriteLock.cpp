@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/System>
+#include <flux/ReadWriteLock>
+#include "futex.h"
+
+namespace flux {
+
+void ReadWriteLock::acquireReadContended()
+{
+    double t0 = stats_ ? System::now() : 0;
+    while (true) {
+        unsigned s = state_;
+        if (s & Writer) sleep(s);
+        else if (writersWaiting_ > 0) waitAtGate();
+        else if (__sync_bool_compare_and_swap(&state_, s, s + 1)) break;
+    }
+    if (stats_) stats_->waited(System::now() - t0);
+}
+
+void ReadWriteLock::acquireWriteContended()
+{
+    double t0 = stats_ ? System::now() : 0;
+    __sync_add_and_fetch(&writersWaiting_, 1);
+    while (true) {
+        unsigned s = state_;
+        if ((s & ~unsigned(Waiting)) == 0) {
+            if (__sync_bool_compare_and_swap(&state_, s, s | Writer)) break;
+        }
+        else {
+            sleep(s);
+        }
+    }
+    __sync_sub_and_fetch(&writersWaiting_, 1);
+    if (stats_) stats_->waited(System::now() - t0);
+}
+
+void ReadWriteLock::sleep(unsigned s)
+{
+    if (!(s & Waiting)) {
+        if (!__sync_bool_compare_and_swap(&state_, s, s | Waiting)) return;
+        s |= Waiting;
+    }
+    futex::wait(&state_, s);
+}
+
+/** Sleep until a writer releases the lock, the waiting writers are not reflected in the state word
+  */
+void ReadWriteLock::waitAtGate()
+{
+    int g = gate_;
+    __sync_fetch_and_or(&gateWaiting_, 1);
+    if (writersWaiting_ > 0) futex::wait(&gate_, g);
+}
+
+void ReadWriteLock::openGate()
+{
+    gateWaiting_ = 0;
+    __sync_add_and_fetch(&gate_, 1);
+    futex::wake(&gate_, intMax);
+}
+
+void ReadWriteLock::wakeAll()
+{
+    __sync_fetch_and_and(&state_, ~unsigned(Waiting));
+    futex::wake(&state_, intMax);
+}
+
+} // namespace flux
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_READWRITELOCK_H
+#define FLUX_READWRITELOCK_H
+
+#include <flux/LockStats>
+
+namespace flux {
+
+/** \brief Embeddable reader/writer lock
+  *
+  * Any number of readers or a single writer may hold the lock. Taking and releasing
+  * a read lock is one atomic instruction each as long as no writer is involved, which
+  * makes it a good fit for read-mostly data. Writers take precedence: once a writer is
+  * waiting new readers queue up behind it.
+  * \see ReadGuard, WriteGuard, FutexMutex
+  */
+class ReadWriteLock
+{
+public:
+    ReadWriteLock(LockStats *stats = 0):
+        state_(0),
+        writersWaiting_(0),
+        gate_(0),
+        gateWaiting_(0),
+        stats_(stats)
+    {}
+
+    inline void acquireRead() {
+        unsigned s = state_;
+        if ((s & Writer) || writersWaiting_ > 0 || !__sync_bool_compare_and_swap(&state_, s, s + 1))
+            acquireReadContended();
+        if (stats_) stats_->acquired();
+    }
+
+    inline void releaseRead() {
+        unsigned s = __sync_sub_and_fetch(&state_, 1);
+        if (s == Waiting) wakeAll();
+    }
+
+    inline void acquireWrite() {
+        if (!__sync_bool_compare_and_swap(&state_, 0, Writer))
+            acquireWriteContended();
+        if (stats_) stats_->acquired();
+    }
+
+    inline void releaseWrite() {
+        unsigned s = __sync_fetch_and_and(&state_, ~Writer);
+        if (s & Waiting) wakeAll();
+        if (gateWaiting_) openGate();
+    }
+
+    inline void setStats(LockStats *stats) { stats_ = stats; }
+    inline LockStats *stats() const { return stats_; }
+
+private:
+    ReadWriteLock(const ReadWriteLock &);
+    ReadWriteLock &operator=(const ReadWriteLock &);
+
+    enum {
+        Writer = 1u << 31,
+        Waiting = 1u << 30
+    };
+
+    void acquireReadContended();
+    void acquireWriteContended();
+    void sleep(unsigned s);
+    void wakeAll();
+    void waitAtGate();
+    void openGate();
+
+    volatile unsigned state_; // writer flag, sleeper flag and number of readers
+    volatile int writersWaiting_;
+    volatile int gate_; // readers held back by waiting writers sleep here
+    volatile int gateWaiting_;
+    LockStats *stats_;
+};
+
+/** \brief Read lock guard
+  */
+class ReadGuard
+{
+public:
+    ReadGuard(ReadWriteLock *lock): lock_(lock) { lock_->acquireRead(); }
+    ~ReadGuard() { lock_->releaseRead(); }
+private:
+    ReadWriteLock *lock_;
+};
+
+/** \brief Write lock guard
+  */
+class WriteGuard
+{
+public:
+    WriteGuard(ReadWriteLock *lock): lock_(lock) { lock_->acquireWrite(); }
+    ~WriteGuard() { lock_->releaseWrite(); }
+private:
+    ReadWriteLock *lock_;
+};
+
+} // namespace flux
+
+#endif // FLUX_READWRITELOCK_H
@@ -85,6 +85,25 @@ public:
         }
     }
 
+    /** Take over the reference held by \a b and leave \a b null,
+      * without touching the reference count
+      */
+    inline void move(Ref &b) {
+        if (this != &b) {
+            if (a_) a_->decRefCount();
+            a_ = b.a_;
+            b.a_ = 0;
+        }
+    }
+
+    /** Exchange the objects referred to, without touching the reference counts
+      */
+    inline void swap(Ref &b) {
+        T *h = a_;
+        a_ = b.a_;
+        b.a_ = h;
+    }
+
     template<class T2>
     inline Ref<T> &operator<<(T2 x) {
         FLUX_ASSERT2(a_, "Null reference on shift left");
@@ -106,6 +125,24 @@ private:
 template<class U, class T>
 inline U *cast(const Ref<T>& p) { return cast<U>(p.get()); }
 
+/** Assign \a b to \a a, where \a b is not going to be used any more.
+  * For references this saves the reference counting, for other types it is a plain copy.
+  */
+template<class T>
+inline void move(T &a, T &b) { a = b; }
+
+template<class T>
+inline void move(Ref<T> &a, Ref<T> &b) { a.move(b); }
+
+/** Switch the object referred to by \a a to atomic reference counting before it is
+  * handed over to another thread (see Object::setThreadLocal()), no-op for other types
+  */
+template<class T>
+inline void share(T &) {}
+
+template<class T>
+inline void share(Ref<T> &a) { if (a) a->setThreadLocal(false); }
+
 } // namespace flux
 
 #endif // FLUX_REF_H
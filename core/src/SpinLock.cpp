@@ -6,7 +6,7 @@
  *
  */
 
-#include <pthread.h>
+#include <sched.h>
 #include <flux/SpinLock>
 #include "helgrind.h"
 
@@ -27,7 +27,7 @@ SpinLock::~SpinLock()
 bool SpinLock::tryAcquire()
 {
     VALGRIND_HG_MUTEX_LOCK_PRE(&flag_, 1);
-    bool ok = __sync_bool_compare_and_swap(&flag_, 0, 1);
+    bool ok = !__sync_lock_test_and_set(&flag_, 1);
     VALGRIND_HG_MUTEX_LOCK_POST(&flag_);
     return ok;
 }
@@ -35,21 +35,32 @@ bool SpinLock::tryAcquire()
 void SpinLock::acquire()
 {
     VALGRIND_HG_MUTEX_LOCK_PRE(&flag_, 0);
-    while (!__sync_bool_compare_and_swap(&flag_, 0, 1)) yield();
+    if (__sync_lock_test_and_set(&flag_, 1)) acquireContended();
     VALGRIND_HG_MUTEX_LOCK_POST(&flag_);
 }
 
 void SpinLock::release()
 {
     VALGRIND_HG_MUTEX_UNLOCK_PRE(&flag_);
-    __sync_bool_compare_and_swap(&flag_, 1, 0);
+    __sync_lock_release(&flag_);
     VALGRIND_HG_MUTEX_UNLOCK_POST(&flag_);
 }
 #endif // ndef NDEBUG
 
-void SpinLock::yield()
+void SpinLock::acquireContended()
 {
-    pthread_yield();
+    int backoff = 1;
+    do {
+        while (flag_) {
+            if (backoff < 1024) {
+                for (int i = 0; i < backoff; ++i) cpuRelax();
+                backoff <<= 1;
+            }
+            else {
+                sched_yield();
+            }
+        }
+    } while (__sync_lock_test_and_set(&flag_, 1));
 }
 
 } // namespace flux
@@ -11,7 +11,19 @@
 
 namespace flux {
 
+/// Hint to the CPU that the calling thread is busy waiting
+inline void cpuRelax()
+{
+    #if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+    #endif
+}
+
 /** \brief Thread synchronization primitive: spinning lock
+  *
+  * A contending thread spins on reading the flag with exponential backoff
+  * and yields the CPU after a while.
+  * \see FutexMutex, TicketLock
   */
 class SpinLock
 {
@@ -23,16 +35,16 @@ public:
     void release();
 
 private:
-    void yield();
+    void acquireContended();
     volatile char flag_;
 };
 
 #ifdef NDEBUG
 inline SpinLock::SpinLock(): flag_(0) {}
 inline SpinLock::~SpinLock() {}
-inline bool SpinLock::tryAcquire() { return __sync_bool_compare_and_swap(&flag_, 0, 1); }
-inline void SpinLock::acquire() { while (!__sync_bool_compare_and_swap(&flag_, 0, 1)) yield(); }
-inline void SpinLock::release() { flag_ = 0; }
+inline bool SpinLock::tryAcquire() { return !__sync_lock_test_and_set(&flag_, 1); }
+inline void SpinLock::acquire() { if (__sync_lock_test_and_set(&flag_, 1)) acquireContended(); }
+inline void SpinLock::release() { __sync_lock_release(&flag_); }
 #endif // def NDEBUG
 
 } // namespace flux
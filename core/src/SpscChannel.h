@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_SPSCCHANNEL_H
+#define FLUX_SPSCCHANNEL_H
+
+#include <flux/EventCount>
+
+namespace flux {
+
+/** \brief Lock-free bounded channel for exactly one producer and one consumer thread
+  *
+  * Wait-free ring buffer: push and pop each take one acquire load and one release store
+  * in the common case. Batched pushes and pops publish all items with a single store.
+  * Threads only block (on a futex) if the channel is full or empty.
+  * \see BoundedChannel, Channel
+  */
+template<class T>
+class SpscChannel: public Object
+{
+public:
+    static Ref<SpscChannel> create(int capacity = 1024) {
+        return new SpscChannel(capacity);
+    }
+
+    ~SpscChannel() { delete[] buffer_; }
+
+    bool tryPush(const T &item)
+    {
+        if (!enqueue(&item, 1)) return false;
+        notEmpty_.notify();
+        return true;
+    }
+
+    bool tryPop(T *item)
+    {
+        if (!dequeue(item, 1)) return false;
+        notFull_.notify();
+        return true;
+    }
+
+    inline void push(const T &item) { pushBatch(&item, 1); }
+
+    T pop(T *item = 0)
+    {
+        T h;
+        if (!item) item = &h;
+        popBefore(-1, item);
+        return *item;
+    }
+
+    bool popBefore(double timeout, T *item = 0)
+    {
+        T h;
+        if (!item) item = &h;
+        while (!dequeue(item, 1)) {
+            uint32_t epoch = notEmpty_.prepareWait();
+            if (dequeue(item, 1)) {
+                notEmpty_.cancelWait();
+                break;
+            }
+            if (!notEmpty_.wait(epoch, timeout)) {
+                if (!dequeue(item, 1)) return false;
+                break;
+            }
+        }
+        notFull_.notify();
+        return true;
+    }
+
+    /** Push \a n items, publishing as many as fit at once
+      */
+    void pushBatch(const T *items, int n)
+    {
+        while (n > 0) {
+            int m = enqueue(items, n);
+            if (m > 0) {
+                notEmpty_.notify();
+                items += m;
+                n -= m;
+                continue;
+            }
+            uint32_t epoch = notFull_.prepareWait();
+            if (freeCount() > 0) {
+                notFull_.cancelWait();
+                continue;
+            }
+            notFull_.wait(epoch);
+        }
+    }
+
+    /** Wait for at least one item and pop up to \a maxCount items without further waiting.
+      * Returns the number of items popped.
+      */
+    int popBatch(T *items, int maxCount)
+    {
+        if (maxCount <= 0) return 0;
+        int n = dequeue(items, maxCount);
+        if (n == 0) {
+            pop(items);
+            n = 1 + dequeue(items + 1, maxCount - 1);
+        }
+        notFull_.notify();
+        return n;
+    }
+
+    inline int capacity() const { return mask_ + 1; }
+
+    inline int count() const {
+        return int(__atomic_load_n(&tail_, __ATOMIC_ACQUIRE) - __atomic_load_n(&head_, __ATOMIC_ACQUIRE));
+    }
+
+private:
+    SpscChannel(int capacity):
+        mask_(1),
+        head_(0),
+        cachedTail_(0),
+        tail_(0),
+        cachedHead_(0)
+    {
+        while (int(mask_) < capacity) mask_ <<= 1;
+        buffer_ = new T[mask_];
+        --mask_;
+    }
+
+    inline int freeCount() const {
+        return int(mask_ + 1 - (tail_ - __atomic_load_n(&head_, __ATOMIC_SEQ_CST)));
+    }
+
+    int enqueue(const T *items, int n)
+    {
+        size_t t = tail_;
+        size_t room = mask_ + 1 - (t - cachedHead_);
+        if (room < size_t(n)) {
+            cachedHead_ = __atomic_load_n(&head_, __ATOMIC_ACQUIRE);
+            room = mask_ + 1 - (t - cachedHead_);
+        }
+        if (size_t(n) > room) n = room;
+        for (int i = 0; i < n; ++i)
+            buffer_[(t + i) & mask_] = items[i];
+        if (n > 0) __atomic_store_n(&tail_, t + n, __ATOMIC_SEQ_CST);
+        return n;
+    }
+
+    int dequeue(T *items, int n)
+    {
+        size_t h = head_;
+        size_t fill = cachedTail_ - h;
+        if (fill < size_t(n)) {
+            cachedTail_ = __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+            fill = cachedTail_ - h;
+        }
+        if (size_t(n) > fill) n = fill;
+        for (int i = 0; i < n; ++i) {
+            T &slot = buffer_[(h + i) & mask_];
+            move(items[i], slot);
+            slot = T();
+        }
+        if (n > 0) __atomic_store_n(&head_, h + n, __ATOMIC_SEQ_CST);
+        return n;
+    }
+
+    T *buffer_;
+    size_t mask_;
+    char pad0_[64];
+    size_t head_; // written by consumer
+    size_t cachedTail_; // consumer's view of tail_
+    char pad1_[64];
+    size_t tail_; // written by producer
+    size_t cachedHead_; // producer's view of head_
+    char pad2_[64];
+    EventCount notEmpty_;
+    EventCount notFull_;
+};
+
+} // namespace flux
+
+#endif // FLUX_SPSCCHANNEL_H
@@ -56,6 +56,22 @@ off_t Stream::transfer(off_t count, Stream *sink, ByteArray *buf)
     return total;
 }
 
+/** Return the system stream all data written to this stream ends up in unmodified
+  * or null if there is none. A kernel-side transfer() from a system stream hands data
+  * over to the direct sink immediately, bypassing write(). Decorators which only look
+  * at the amount of data written may opt in by returning the direct sink of the stream
+  * they decorate and by overloading directWritten().
+  */
+SystemStream *Stream::directSink()
+{
+    return 0;
+}
+
+/** Account for \a count bytes handed over to directSink() by the kernel
+  */
+void Stream::directWritten(off_t count)
+{}
+
 int Stream::readAll(ByteArray *data)
 {
     const int w = data->count();
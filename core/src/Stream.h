@@ -13,6 +13,8 @@
 
 namespace flux {
 
+class SystemStream;
+
 /** \brief Abstract data stream
   */
 class Stream: public Object
@@ -31,6 +33,9 @@ public:
     inline off_t skip(off_t count) { return transfer(count); }
     inline void drain() { transfer(); }
 
+    virtual SystemStream *directSink();
+    virtual void directWritten(off_t count);
+
     int readAll(ByteArray *data);
     String readAll(int count = -1);
 };
@@ -94,6 +94,9 @@ inline Ref<StringList> operator+(const String &a, const String &b) {
 }
 inline Ref<StringList> operator+(Ref<StringList> &a, const String &b) { a->append(b); return a; }
 
+inline void move(String &a, String &b) { a.move(b); }
+inline void share(String &a) { if (a.get()) a->setThreadLocal(false); }
+
 inline bool operator==(const String &a, const String &b) { return a->count() == b->count() && strcmp(a->chars(), b->chars()) == 0; }
 inline bool operator!=(const String &a, const String &b) { return a->count() != b->count() || strcmp(a->chars(), b->chars()) != 0; }
 inline bool operator< (const String &a, const String &b) { return strcmp(a->chars(), b->chars()) <  0; }
@@ -9,12 +9,17 @@
 #include <sys/types.h>
 #include <sys/ioctl.h> // ioctl
 #include <sys/uio.h> // readv
+#include <sys/stat.h> // fstat
+#include <sys/sendfile.h> // sendfile
+#include <sys/socket.h> // recv
+#include <poll.h> // poll
 #include <errno.h>
 #include <string.h>
-#include <unistd.h> // read, write, select, sysconf
-#include <fcntl.h> // fcntl
-#include <math.h> // modf
+#include <unistd.h> // read, write, sysconf
+#include <fcntl.h> // fcntl, splice
+#include <math.h> // ceil
 #include <flux/exceptions>
+#include <flux/System>
 #include <flux/SystemStream>
 
 namespace flux {
@@ -29,7 +34,9 @@ Ref<SystemStream> SystemStream::duplicate(SystemStream *other)
 SystemStream::SystemStream(int fd, bool iov):
     fd_(fd),
     iov_(iov),
-    iovMax_(0)
+    iovMax_(0),
+    socket_(-1),
+    readDeadline_(inf)
 {}
 
 SystemStream::~SystemStream()
@@ -47,29 +54,76 @@ bool SystemStream::isatty() const
 
 bool SystemStream::readyRead(double interval) const
 {
-    fd_set set;
-    FD_ZERO(&set);
-    FD_SET(fd_, &set);
-    struct timeval tv, *to = 0;
-    if (interval != inf) {
-        if (interval < 0) interval = 0;
-        to = &tv;
-        double sec = 0;
-        to->tv_usec = modf(interval, &sec) * 1e6;
-        to->tv_sec = sec;
-    }
-    int ret = ::select(fd_ + 1, &set, 0, 0, to);
+    struct pollfd fds;
+    fds.fd = fd_;
+    fds.events = POLLIN;
+    fds.revents = 0;
+    int timeout = -1;
+    if (interval != inf) timeout = (interval > 0) ? int(ceil(interval * 1000)) : 0;
+    int ret = ::poll(&fds, 1, timeout);
     if (ret == -1) FLUX_SYSTEM_DEBUG_ERROR(errno);
     return (ret > 0);
 }
 
+/** Limit all following reads to complete before \a deadline (absolute time,
+  * see System::now()), inf turns the limit off again. The file status flags of the
+  * descriptor are left untouched.
+  */
+void SystemStream::setReadDeadline(double deadline)
+{
+    readDeadline_ = deadline;
+}
+
+bool SystemStream::isSocket() const
+{
+    if (socket_ == -1) {
+        struct stat status;
+        socket_ = (::fstat(fd_, &status) == 0 && S_ISSOCK(status.st_mode));
+    }
+    return socket_;
+}
+
+/** Wait until \a events are signalled or \a deadline has passed
+  */
+bool SystemStream::waitFor(int events, double deadline) const
+{
+    struct pollfd fds;
+    fds.fd = fd_;
+    fds.events = events;
+    while (true) {
+        fds.revents = 0;
+        int timeout = -1;
+        if (deadline != inf) {
+            double interval = deadline - System::now();
+            if (interval <= 0) return false;
+            timeout = int(ceil(interval * 1000));
+        }
+        int ret = ::poll(&fds, 1, timeout);
+        if (ret == -1) {
+            if (errno == EINTR) continue;
+            FLUX_SYSTEM_DEBUG_ERROR(errno);
+        }
+        if (ret > 0) return true;
+    }
+}
+
 int SystemStream::read(ByteArray *data)
 {
     ssize_t ret = 0;
     while (true) {
-        ret = ::read(fd_, data->bytes(), data->count());
+        if (readDeadline_ == inf)
+            ret = ::read(fd_, data->bytes(), data->count());
+        else if (isSocket()) // non-blocking for this call only
+            ret = ::recv(fd_, data->bytes(), data->count(), MSG_DONTWAIT);
+        else if (waitFor(POLLIN, readDeadline_))
+            ret = ::read(fd_, data->bytes(), data->count());
+        else
+            throw Timeout();
         if (ret == -1) {
-            if (errno == EWOULDBLOCK) throw Timeout();
+            if (errno == EWOULDBLOCK) {
+                if (readDeadline_ != inf && waitFor(POLLIN, readDeadline_)) continue;
+                throw Timeout();
+            }
             if (errno == ECONNRESET) throw ConnectionResetByPeer();
             FLUX_SYSTEM_DEBUG_ERROR(errno);
         }
@@ -121,10 +175,93 @@ void SystemStream::write(const StringList *parts)
             if (errno == EPIPE) throw ConnectionResetByPeer(); // FIXME: inprecise
             FLUX_SYSTEM_DEBUG_ERROR(errno);
         }
-        i += n;
+        while (i < iov->count()) {
+            struct iovec *v = &iov->at(i);
+            if (size_t(ret) < v->iov_len) {
+                v->iov_base = (char *)v->iov_base + ret;
+                v->iov_len -= ret;
+                break;
+            }
+            ret -= v->iov_len;
+            ++i;
+        }
     }
 }
 
+off_t SystemStream::transfer(off_t count, Stream *sink, ByteArray *buf)
+{
+    if (count == 0) return 0;
+    SystemStream *target = sink ? sink->directSink() : 0;
+    if (target) {
+        off_t total = 0;
+        if (transferDirect(count, sink, target, &total)) return total;
+        if (count > 0) {
+            count -= total;
+            if (count == 0) return total;
+        }
+        return total + Stream::transfer(count, sink, buf);
+    }
+    return Stream::transfer(count, sink, buf);
+}
+
+SystemStream *SystemStream::directSink()
+{
+    return this;
+}
+
+/** Move up to \a count bytes (or everything if \a count < 0) to \a target inside the kernel
+  * \return false if the kernel can't take over (the bytes transferred so far are stored in \a total)
+  */
+bool SystemStream::transferDirect(off_t count, Stream *sink, SystemStream *target, off_t *total)
+{
+    enum Method { CopyFileRange, Splice, SendFile };
+
+    struct stat sourceStatus, targetStatus;
+    if (::fstat(fd_, &sourceStatus) == -1) return false;
+    if (::fstat(target->fd_, &targetStatus) == -1) return false;
+
+    int method = -1;
+    if (S_ISREG(sourceStatus.st_mode) && S_ISREG(targetStatus.st_mode)) method = CopyFileRange;
+    else if (S_ISFIFO(sourceStatus.st_mode) || S_ISFIFO(targetStatus.st_mode)) method = Splice;
+    else if (S_ISREG(sourceStatus.st_mode)) method = SendFile;
+    else return false;
+
+    const size_t chunkSize = 0x40000000;
+
+    while (count < 0 || *total < count) {
+        size_t n = chunkSize;
+        if (count > 0 && count - *total < off_t(n)) n = count - *total;
+        ssize_t ret = -1;
+        if (method == Splice && readDeadline_ != inf && !waitFor(POLLIN, readDeadline_)) throw Timeout();
+        if (method == CopyFileRange) ret = ::copy_file_range(fd_, 0, target->fd_, 0, n, 0);
+        else if (method == Splice) ret = ::splice(fd_, 0, target->fd_, 0, n, SPLICE_F_MOVE);
+        else ret = ::sendfile(target->fd_, fd_, 0, n);
+        if (ret == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EWOULDBLOCK) {
+                // a descriptor in non-blocking mode, wait until both ends are ready
+                if (!waitFor(POLLIN, readDeadline_)) throw Timeout();
+                target->waitFor(POLLOUT, inf);
+                continue;
+            }
+            if (*total == 0) {
+                if (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP || errno == EBADF) {
+                    if (method != CopyFileRange) return false;
+                    method = SendFile;
+                    continue;
+                }
+            }
+            if (errno == ECONNRESET || errno == EPIPE) throw ConnectionResetByPeer();
+            FLUX_SYSTEM_DEBUG_ERROR(errno);
+        }
+        if (ret == 0) break;
+        *total += ret;
+        sink->directWritten(ret);
+    }
+
+    return true;
+}
+
 void SystemStream::closeOnExec()
 {
     if (::fcntl(fd_, F_SETFD, FD_CLOEXEC) == -1)
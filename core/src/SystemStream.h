@@ -15,6 +15,18 @@
 namespace flux {
 
 /** \brief System streams: files, character devices, stream sockets, etc.
+  *
+  * Reads can be limited by a deadline (setReadDeadline()). A read which does not
+  * complete before the deadline throws a Timeout exception. Sockets are then read
+  * with MSG_DONTWAIT and the stream only waits for the socket to become ready when
+  * there is no data at hand, other descriptors are polled before each read. The
+  * descriptor itself is never switched to non-blocking mode, because its file
+  * description may be shared with other descriptors and processes.
+  *
+  * transfer() lets the kernel move the data if the sink ends up in a system stream
+  * (see Stream::directSink()): by copy_file_range(2) between regular files, by
+  * splice(2) from or to a pipe and by sendfile(2) from a regular file to any other
+  * stream. Other combinations are copied in user space.
   * \see File, SocketPair
   */
 class SystemStream: public Stream
@@ -31,6 +43,9 @@ public:
 
     bool readyRead(double interval) const;
 
+    inline double readDeadline() const { return readDeadline_; }
+    void setReadDeadline(double deadline);
+
     virtual int read(ByteArray *data);
     virtual void write(const ByteArray *data);
     virtual void write(const StringList *parts);
@@ -39,6 +54,9 @@ public:
     inline void write(String s) { write(s.get()); }
     inline void write(const char *s) { write(String(s)); }
 
+    virtual off_t transfer(off_t count = -1, Stream *sink = 0, ByteArray *buf = 0);
+    virtual SystemStream *directSink();
+
     void closeOnExec();
 
     int ioctl(int request, void *arg);
@@ -48,9 +66,16 @@ public:
 protected:
     SystemStream(int fd, bool iov = true);
 
+    bool isSocket() const;
+    bool waitFor(int events, double deadline) const;
+
+    bool transferDirect(off_t count, Stream *sink, SystemStream *target, off_t *total);
+
     int fd_;
     bool iov_;
     int iovMax_;
+    mutable int socket_;
+    double readDeadline_;
 };
 
 class ConnectionResetByPeer: public Exception
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_TASK_H
+#define FLUX_TASK_H
+
+#include <flux/Object>
+
+namespace flux {
+
+class TaskGroup;
+
+/** \brief Unit of work scheduled on an Executor
+  *
+  * Subclasses implement run(). The executor takes a reference on the task when
+  * it is scheduled and releases it after run() returned. If the task's group was
+  * canceled before the task started skip() is called instead of run(), which gives
+  * the task a chance to complete what other parties are waiting for.
+  * \see Executor, TaskGroup
+  */
+class Task: public Object
+{
+public:
+    virtual void run() = 0;
+    virtual void skip() {}
+
+protected:
+    Task(): group_(0) {}
+
+private:
+    friend class Executor;
+    friend class TaskGroup;
+    TaskGroup *group_;
+};
+
+} // namespace flux
+
+#endif // FLUX_TASK_H
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/System>
+#include <flux/TaskGroup>
+
+namespace flux {
+
+TaskGroup::TaskGroup(Executor *executor):
+    executor_(executor),
+    pending_(0),
+    canceled_(false),
+    failed_(0)
+{}
+
+/** Schedule \a task as part of this group
+  */
+void TaskGroup::run(Task *task)
+{
+    FLUX_ASSERT(!task->group_);
+    __sync_add_and_fetch(&pending_, 1);
+    incRefCount();
+    task->group_ = this;
+    executor_->schedule(task);
+}
+
+/** Wait until all tasks of this group are finished (or skipped, if canceled).
+  * While waiting the calling thread executes pending tasks of the executor.
+  * If a task of the group failed a TaskError is thrown afterwards.
+  */
+void TaskGroup::wait()
+{
+    bool isWorker = executor_->isWorker();
+    while (pending_ > 0) {
+        if (executor_->helpOnce()) continue;
+        if (isWorker) {
+            // keep looking for work which other tasks of this group might depend on
+            uint32_t epoch = executor_->idle_.prepareWait();
+            if (pending_ == 0) {
+                executor_->idle_.cancelWait();
+                break;
+            }
+            executor_->idle_.wait(epoch, System::now() + 0.001);
+        }
+        else {
+            uint32_t epoch = done_.prepareWait();
+            if (pending_ == 0) {
+                done_.cancelWait();
+                break;
+            }
+            done_.wait(epoch);
+        }
+    }
+    if (failed_) throw TaskError(error_);
+}
+
+void TaskGroup::fail(String message)
+{
+    canceled_ = true;
+    if (__sync_bool_compare_and_swap(&failed_, 0, 1))
+        error_ = message;
+}
+
+void TaskGroup::finish()
+{
+    if (__sync_sub_and_fetch(&pending_, 1) == 0) {
+        done_.notifyAll();
+        executor_->idle_.notifyAll();
+    }
+}
+
+} // namespace flux
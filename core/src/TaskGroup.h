@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_TASKGROUP_H
+#define FLUX_TASKGROUP_H
+
+#include <flux/EventCount>
+#include <flux/Executor>
+
+namespace flux {
+
+/** \brief A task of a TaskGroup terminated with an exception
+  */
+class TaskError: public Exception
+{
+public:
+    TaskError(String message): message_(message) {}
+    ~TaskError() throw() {}
+
+    virtual String message() const { return message_; }
+
+private:
+    String message_;
+};
+
+/** \brief Set of tasks which can be waited for and canceled collectively
+  *
+  * Tasks of a group may spawn further tasks into the same group. A thread waiting
+  * for the group helps executing pending tasks. Canceling a group skips all of its
+  * tasks not yet started (see Task::skip()). A task terminating with an exception
+  * cancels its group and the message of the first such exception is rethrown by
+  * wait() as a TaskError. The executor needs to outlive the group.
+  * \see Executor, parallelFor()
+  */
+class TaskGroup: public Object
+{
+public:
+    static Ref<TaskGroup> create(Executor *executor = 0) {
+        return new TaskGroup(executor ? executor : Executor::instance());
+    }
+
+    void run(Task *task);
+    void wait();
+
+    inline void cancel() { canceled_ = true; }
+    inline bool isCanceled() const { return canceled_; }
+
+    /// a task of this group terminated with an exception
+    inline bool hasFailed() const { return failed_; }
+
+    inline Executor *executor() const { return executor_; }
+
+private:
+    friend class Executor;
+
+    TaskGroup(Executor *executor);
+    void fail(String message);
+    void finish();
+
+    Executor *executor_;
+    volatile int pending_;
+    volatile bool canceled_;
+    volatile int failed_;
+    String error_;
+    EventCount done_;
+};
+
+} // namespace flux
+
+#endif // FLUX_TASKGROUP_H
@@ -11,6 +11,7 @@
 #include <flux/ThreadFactory>
 #include <flux/System>
 #include <flux/Thread>
+#include "futex.h"
 
 namespace flux {
 
@@ -36,18 +37,23 @@ void Thread::start(int stackSize)
 
 void Thread::wait()
 {
+    if (carried_) {
+        while (!finished_) futex::wait(&finished_, 0);
+        return;
+    }
     int ret = pthread_join(tid_, 0);
     if (ret != 0) FLUX_SYSTEM_DEBUG_ERROR(ret);
 }
 
 void Thread::kill(int signal)
 {
-    int ret = pthread_kill(tid_, signal);
+    int ret = carried_ ? ThreadFactory::signalCarried(this, signal) : pthread_kill(tid_, signal);
     if (ret != 0) FLUX_SYSTEM_DEBUG_ERROR(ret);
 }
 
 bool Thread::stillAlive() const
 {
+    if (carried_) return !finished_;
     int ret = pthread_kill(tid_, 0);
     if ((ret != 0) && (ret != ESRCH))
         FLUX_SYSTEM_DEBUG_ERROR(ret);
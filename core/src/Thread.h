@@ -38,10 +38,11 @@ public:
     static void blockSignals(SignalSet *set);
     static void unblockSignals(SignalSet *set);
 
+    /// system thread running this thread (the carrier in thread reuse mode, see ThreadFactory)
     pthread_t id() const { return tid_; }
 
 protected:
-    Thread(): lastSignal_(0) {}
+    Thread(): lastSignal_(0), carried_(false), finished_(0) {}
 
     virtual void run();
     virtual void handleSignal(int signal);
@@ -54,6 +55,8 @@ private:
     Ref<ByteArray> stack_;
     pthread_t tid_;
     int lastSignal_;
+    bool carried_;
+    volatile int finished_;
 };
 
 inline Thread *thread() { return Thread::self(); }
@@ -9,14 +9,91 @@
 #include <sys/mman.h>
 #include <flux/System>
 #include <flux/exceptions>
+#include <flux/FutexMutex>
+#include <flux/Guard>
+#include <flux/stdio>
 #include <flux/ThreadFactory>
+#include "futex.h"
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#ifndef MAP_STACK
+#define MAP_STACK 0
+#endif
 
 namespace flux {
 
+/** \internal
+  * Process-wide cache of thread stacks. Zero-initialized plain data, so it can be used
+  * from static constructors and destructors.
+  */
+namespace stackCache
+{
+    enum { MaxLimit = 64 };
+    struct Entry { char *data; int size; };
+    static FutexMutex mutex;
+    static Entry entries[MaxLimit];
+    static int count = 0;
+    static int limit = 16;
+
+    static char *get(int size)
+    {
+        Guard<FutexMutex> guard(&mutex);
+        for (int i = count - 1; i >= 0; --i) {
+            if (entries[i].size == size) {
+                char *data = entries[i].data;
+                entries[i] = entries[--count];
+                return data;
+            }
+        }
+        return 0;
+    }
+
+    static bool put(char *data, int size)
+    {
+        Guard<FutexMutex> guard(&mutex);
+        if (count >= limit) return false;
+        entries[count].data = data;
+        entries[count].size = size;
+        ++count;
+        return true;
+    }
+}
+
+/** \internal
+  * Parked threads waiting for the next Thread to run (reuse mode)
+  */
+class ThreadCarrier
+{
+public:
+    enum { Idle = 0, Busy = 1 };
+
+    ThreadCarrier(int stackSize): state_(Busy), stackSize_(stackSize), thread_(0), next_(0) {}
+
+    pthread_t tid_;
+    volatile int state_;
+    int stackSize_;
+    Thread *thread_;
+    ThreadCarrier *next_;
+};
+
+namespace carriers
+{
+    enum { MaxParked = 16 };
+    static const double ParkingTime = 10;
+    static FutexMutex mutex;
+    static ThreadCarrier *parked = 0;
+    static int parkedCount = 0;
+}
+
 ThreadFactory::ThreadFactory(Ref< Clonable<Thread> > prototype)
     : prototype_(prototype),
       stackSize_(1 << 20),
-      guardSize_(System::pageSize())
+      guardSize_(System::pageSize()),
+      reuseThreads_(false),
+      hugePages_(false)
 {
     int ret = pthread_attr_init(&attr_);
     if (ret != 0) FLUX_SYSTEM_DEBUG_ERROR(ret);
@@ -66,8 +143,33 @@ Ref<Thread> ThreadFactory::produce()
     return thread;
 }
 
+/** Maximum number of stacks kept for reuse
+  */
+int ThreadFactory::stackCacheLimit()
+{
+    return stackCache::limit;
+}
+
+void ThreadFactory::setStackCacheLimit(int count)
+{
+    if (count < 0) count = 0;
+    if (count > stackCache::MaxLimit) count = stackCache::MaxLimit;
+    Guard<FutexMutex> guard(&stackCache::mutex);
+    stackCache::limit = count;
+    while (stackCache::count > count) {
+        stackCache::Entry *entry = &stackCache::entries[--stackCache::count];
+        ::munmap(entry->data, entry->size);
+    }
+}
+
 void ThreadFactory::start(Thread *thread)
 {
+    if (reuseThreads_) {
+        thread->carried_ = true;
+        thread->finished_ = 0;
+        if (!resume(thread)) startCarrier(thread);
+        return;
+    }
     thread->stack_ = allocateStack();
     int ret = pthread_attr_setstack(&attr_, thread->stack_->bytes() + guardSize_, thread->stack_->count() - 2 * guardSize_);
     if (ret != 0) FLUX_SYSTEM_DEBUG_ERROR(ret);
@@ -85,18 +187,22 @@ public:
 
 Ref<ByteArray> ThreadFactory::allocateStack() const
 {
-    #ifndef MAP_ANONYMOUS
-    #define MAP_ANONYMOUS MAP_ANON
-    #endif
-    void *protection = ::mmap(0, stackSize_, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    char *protection = stackCache::get(stackSize_);
+    if (protection) return new CallStack(protection, stackSize_);
+
+    protection = (char *)::mmap(0, stackSize_, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
     if (protection == MAP_FAILED) FLUX_SYSTEM_DEBUG_ERROR(errno);
-    void *stack = ::mmap((char *)protection + guardSize_, stackSize_ - 2 * guardSize_, PROT_READ|PROT_WRITE, MAP_FIXED|MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    void *stack = ::mmap(protection + guardSize_, stackSize_ - 2 * guardSize_, PROT_READ|PROT_WRITE, MAP_FIXED|MAP_PRIVATE|MAP_ANONYMOUS|MAP_STACK, -1, 0);
     if (stack == MAP_FAILED) FLUX_SYSTEM_DEBUG_ERROR(errno);
-    return new CallStack((char *)protection, stackSize_);
+    #ifdef MADV_HUGEPAGE
+    if (hugePages_) ::madvise(stack, stackSize_ - 2 * guardSize_, MADV_HUGEPAGE);
+    #endif
+    return new CallStack(protection, stackSize_);
 }
 
 void ThreadFactory::freeStack(ByteArray *stack)
 {
+    if (stackCache::put((char *)stack->bytes(), stack->count())) return;
     if (::munmap(stack->bytes(), stack->count()) == -1)
         FLUX_SYSTEM_DEBUG_ERROR(errno);
 }
@@ -110,4 +216,114 @@ void *ThreadFactory::bootstrap(void *self)
     return (void *)thread;
 }
 
+/** Send \a signal to the carrier of \a thread, unless \a thread has finished already
+  * (and its carrier might run another thread already)
+  */
+int ThreadFactory::signalCarried(Thread *thread, int signal)
+{
+    Guard<FutexMutex> guard(&carriers::mutex);
+    if (thread->finished_) return 0;
+    return pthread_kill(thread->tid_, signal);
+}
+
+bool ThreadFactory::resume(Thread *thread)
+{
+    ThreadCarrier *carrier = 0;
+    {
+        Guard<FutexMutex> guard(&carriers::mutex);
+        for (ThreadCarrier **link = &carriers::parked; *link; link = &(*link)->next_) {
+            if ((*link)->stackSize_ == stackSize_) {
+                carrier = *link;
+                *link = carrier->next_;
+                --carriers::parkedCount;
+                break;
+            }
+        }
+        if (!carrier) return false;
+        carrier->next_ = 0;
+        carrier->thread_ = thread;
+        thread->tid_ = carrier->tid_;
+        __atomic_store_n(&carrier->state_, ThreadCarrier::Busy, __ATOMIC_RELEASE);
+        futex::wake(&carrier->state_); // while the carrier cannot terminate
+    }
+    return true;
+}
+
+void ThreadFactory::startCarrier(Thread *thread)
+{
+    ThreadCarrier *carrier = new ThreadCarrier(stackSize_);
+    carrier->thread_ = thread;
+    // carriers exit on their own, so their stacks are managed (and cached) by the C library
+    pthread_attr_t attr;
+    int ret = pthread_attr_init(&attr);
+    if (ret != 0) FLUX_SYSTEM_DEBUG_ERROR(ret);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_attr_setstacksize(&attr, stackSize_);
+    pthread_attr_setguardsize(&attr, guardSize_);
+    pthread_t tid;
+    {
+        Guard<FutexMutex> guard(&carriers::mutex); // make tid_ visible to the carrier
+        ret = pthread_create(&tid, &attr, &carry, static_cast<void *>(carrier));
+        if (ret == 0) carrier->tid_ = thread->tid_ = tid;
+    }
+    pthread_attr_destroy(&attr);
+    if (ret != 0) {
+        delete carrier;
+        FLUX_SYSTEM_DEBUG_ERROR(ret);
+    }
+}
+
+void *ThreadFactory::carry(void *self)
+{
+    ThreadCarrier *carrier = static_cast<ThreadCarrier *>(self);
+    while (true) {
+        Thread *thread = 0;
+        {
+            Guard<FutexMutex> guard(&carriers::mutex);
+            thread = carrier->thread_;
+            carrier->thread_ = 0;
+        }
+        Thread::self_ = thread;
+        thread->run();
+        try {
+            flushThreadStdOut(); // the carrier outlives the thread and so does its output buffer
+        }
+        catch (...)
+        {}
+        {
+            Guard<FutexMutex> guard(&carriers::mutex); // see signalCarried()
+            __atomic_store_n(&thread->finished_, 1, __ATOMIC_RELEASE);
+        }
+        futex::wake(&thread->finished_, intMax);
+        Thread::self_ = 0;
+
+        {
+            Guard<FutexMutex> guard(&carriers::mutex);
+            if (carriers::parkedCount >= carriers::MaxParked) break;
+            carrier->state_ = ThreadCarrier::Idle;
+            carrier->next_ = carriers::parked;
+            carriers::parked = carrier;
+            ++carriers::parkedCount;
+        }
+
+        double timeout = System::now() + carriers::ParkingTime;
+        while (__atomic_load_n(&carrier->state_, __ATOMIC_ACQUIRE) == ThreadCarrier::Idle) {
+            if (futex::wait(&carrier->state_, ThreadCarrier::Idle, timeout) != ETIMEDOUT) continue;
+            Guard<FutexMutex> guard(&carriers::mutex);
+            if (carrier->state_ != ThreadCarrier::Idle) break;
+            for (ThreadCarrier **link = &carriers::parked; *link; link = &(*link)->next_) {
+                if (*link == carrier) {
+                    *link = carrier->next_;
+                    --carriers::parkedCount;
+                    break;
+                }
+            }
+            delete carrier;
+            return 0;
+        }
+    }
+    delete carrier;
+    return 0;
+}
+
 } // namespace flux
@@ -17,6 +17,17 @@ namespace flux {
 class CallStack;
 
 /** \brief Child thread factory
+  *
+  * Thread stacks are recycled: the stacks of terminated threads are kept in a
+  * process-wide cache of bounded size (see setStackCacheLimit()) and handed out again
+  * to new threads of the same stack size.
+  *
+  * In thread reuse mode (see setReuseThreads()) a thread which finished running
+  * does not exit, but parks for a while and picks up the next Thread started by any
+  * factory in reuse mode. Starting a thread on a parked thread takes no system call
+  * besides a single futex wake-up. Thread::wait() works as usual, Thread::kill()
+  * does nothing once the thread finished and Thread::id() identifies the carrying
+  * system thread.
   * \see ProcessFactory
   */
 class ThreadFactory: public Object
@@ -35,6 +46,15 @@ public:
     int detachState() const;
     void setDetachState(int value);
 
+    bool reuseThreads() const { return reuseThreads_; }
+    void setReuseThreads(bool on) { reuseThreads_ = on; }
+
+    bool hugePages() const { return hugePages_; }
+    void setHugePages(bool on) { hugePages_ = on; }
+
+    static int stackCacheLimit();
+    static void setStackCacheLimit(int count);
+
     pthread_attr_t *attr();
 
     Ref<Thread> produce();
@@ -45,15 +65,23 @@ protected:
 
 private:
     friend class CallStack;
+    friend class Thread;
 
     Ref<ByteArray> allocateStack() const;
     static void freeStack(ByteArray *stack);
     static void *bootstrap(void *self);
 
+    bool resume(Thread *thread);
+    void startCarrier(Thread *thread);
+    static void *carry(void *self);
+    static int signalCarried(Thread *thread, int signal);
+
     Ref< Clonable<Thread> > prototype_;
     pthread_attr_t attr_;
     int stackSize_;
     int guardSize_;
+    bool reuseThreads_;
+    bool hugePages_;
 };
 
 } // namespace flux
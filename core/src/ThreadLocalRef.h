@@ -16,8 +16,12 @@ namespace flux {
 
 /** \internal
   * \brief Thread Local Owner Pointer
+  *
+  * Reads go to a native thread-local variable (see FLUX_THREAD_LOCAL). The pthread key is
+  * only used to release the object when the thread terminates. As the native variable is
+  * a static member there must be only one ThreadLocalRef per pair of \a T and \a Tag.
   */
-template<class T>
+template<class T, class Tag = T>
 class ThreadLocalRef
 {
 public:
@@ -45,9 +49,14 @@ public:
         return a;
     }
 
+    /** Object of the calling thread, accessible without looking up the ThreadLocalRef instance
+      */
+    inline static T *cached() { return cache_; }
+
 private:
     static void threadExitEvent(void *v) {
         T *a = reinterpret_cast<T*>(v);
+        cache_ = 0;
         if (a) a->decRefCount();
     }
 
@@ -56,17 +65,20 @@ private:
         if (a != b) {
             if (a) a->decRefCount();
             ::pthread_setspecific(key_, b);
-             if (b) b->incRefCount();
+            cache_ = b;
+            if (b) b->incRefCount();
         }
     }
 
-    inline T *get() const {
-        return reinterpret_cast<T*>(::pthread_getspecific(key_));
-    }
+    inline T *get() const { return cache_; }
 
     pthread_key_t key_;
+    static FLUX_THREAD_LOCAL T *cache_;
 };
 
+template<class T, class Tag>
+FLUX_THREAD_LOCAL T *ThreadLocalRef<T, Tag>::cache_ = 0;
+
 } // namespace flux
 
 #endif // FLUX_THREADLOCALREF_H
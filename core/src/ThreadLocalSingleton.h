@@ -22,6 +22,8 @@ class ThreadLocalSingleton
 public:
     static SubClass *instance()
     {
+        SubClass *h = ThreadLocalRef<SubClass>::cached();
+        if (h) return h;
         ThreadLocalRef<SubClass> &instance_ = localStatic< ThreadLocalRef<SubClass>, ThreadLocalSingleton<SubClass> >();
         if (!instance_)
             instance_ = new SubClass;
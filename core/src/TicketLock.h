@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_TICKETLOCK_H
+#define FLUX_TICKETLOCK_H
+
+#include <sched.h>
+#include <flux/types>
+#include <flux/SpinLock>
+
+namespace flux {
+
+/** \brief Fair spinning lock for very short critical sections
+  *
+  * Threads acquire the lock in the order of arrival: each one draws a ticket and
+  * waits for it to be served. The waiting time is estimated from the number of
+  * threads ahead, which keeps the cache line of the lock quiet (proportional backoff).
+  * Never sleeps in the kernel, so critical sections should be a handful of instructions.
+  * \see SpinLock, FutexMutex
+  */
+class TicketLock
+{
+public:
+    TicketLock(): next_(0), owner_(0) {}
+
+    inline bool tryAcquire() {
+        uint32_t owner = __atomic_load_n(&owner_, __ATOMIC_RELAXED);
+        return __sync_bool_compare_and_swap(&next_, owner, owner + 1);
+    }
+
+    inline void acquire() {
+        uint32_t ticket = __sync_fetch_and_add(&next_, 1);
+        for (int round = 0; true; ++round) {
+            uint32_t owner = __atomic_load_n(&owner_, __ATOMIC_ACQUIRE);
+            if (owner == ticket) break;
+            uint32_t ahead = ticket - owner;
+            if (ahead > 64 || round > 100) sched_yield(); // owner probably got preempted
+            else for (uint32_t i = 0; i < 32 * ahead; ++i) cpuRelax();
+        }
+    }
+
+    inline void release() {
+        __atomic_store_n(&owner_, owner_ + 1, __ATOMIC_RELEASE);
+    }
+
+private:
+    TicketLock(const TicketLock &);
+    TicketLock &operator=(const TicketLock &);
+
+    volatile uint32_t next_;
+    volatile uint32_t owner_;
+};
+
+} // namespace flux
+
+#endif // FLUX_TICKETLOCK_H
@@ -9,74 +9,74 @@
 #ifndef FLUX_TIMER_H
 #define FLUX_TIMER_H
 
-#include <flux/Thread>
 #include <flux/Channel>
-#include <flux/System>
+#include <flux/TimerWheel>
 
 namespace flux {
 
-/** \brief interval timer thread
+template<class T>
+class TimerAlarm: public Alarm
+{
+public:
+    TimerAlarm(Channel<T> *triggered, T tick):
+        triggered_(triggered),
+        tick_(tick)
+    {
+        if (!triggered_) triggered_ = Channel<T>::create();
+    }
+
+    Ref< Channel<T> > triggered_;
+    T tick_;
+
+private:
+    virtual void expire() { triggered_->push(tick_); }
+};
+
+/** \brief Interval timer
   *
-  * A Timer is a thread that writes tick objects into a channel in a fixed time interval.
+  * A Timer writes tick objects into a channel in a fixed time interval.
   * The time interval may not be hit exactly for each tick, but the overall time scale
   * is maintained. In other words an individual tick may be delivered unprecisely due
   * to the uncertainty of thread scheduling, but there is no error accumulated in the
-  * process.
+  * process. All timers share the service thread of the TimerWheel they are scheduled on,
+  * so timers are cheap to create and to cancel.
   *
-  * \see Channel, Thread, System::now()
+  * \see Channel, TimerWheel, System::now()
   */
 template<class T>
-class Timer: public Thread
+class Timer: public Object
 {
 public:
-    static Ref<Timer> start(double startTime, double interval, Channel<T> *triggered = 0, T tick = T()) {
-        return new Timer(startTime, interval, triggered, tick);
+    static Ref<Timer> start(double startTime, double interval, Channel<T> *triggered = 0, T tick = T(), TimerWheel *wheel = 0) {
+        return new Timer(startTime, interval, triggered, tick, wheel);
     }
 
     inline double startTime() const { return startTime_; }
-    inline double interval() const { return interval_; }
-    inline Channel<T> *triggered() const { return triggered_; }
-    inline T tick() const { return tick_; }
+    inline double interval() const { return alarm_->interval(); }
+    inline Channel<T> *triggered() const { return alarm_->triggered_; }
+    inline T tick() const { return alarm_->tick_; }
+
+    /// Stop delivering ticks
+    inline void cancel() { wheel_->cancel(alarm_); }
 
 protected:
-    Timer(double startTime, double interval, Channel<T> *triggered, T tick):
+    Timer(double startTime, double interval, Channel<T> *triggered, T tick, TimerWheel *wheel):
         startTime_(startTime),
-        interval_(interval),
-        triggered_(triggered),
-        shutdown_(Channel<bool>::create()),
-        tick_(tick)
+        wheel_(wheel ? wheel : TimerWheel::instance()),
+        alarm_(new TimerAlarm<T>(triggered, tick))
     {
-        if (!triggered_) triggered_ = Channel<T>::create();
-        Thread::start();
+        wheel_->schedule(alarm_, startTime, interval);
     }
 
     ~Timer()
     {
-        shutdown_->push(true);
-        Thread::wait();
-    }
-
-    virtual void writeTick(double timeout, bool shutdown)
-    {
-        if (!shutdown) triggered()->push(tick());
+        cancel();
     }
 
 private:
-    virtual void run()
-    {
-        double timeout = startTime_;
-        while (!shutdown_->popBefore(timeout)) {
-            writeTick(timeout, false);
-            timeout += interval_;
-        }
-        writeTick(timeout, true);
-    }
-
     double startTime_;
-    double interval_;
-    Ref< Channel<T> > triggered_;
-    Ref< Channel<bool> > shutdown_;
-    T tick_;
+    TimerWheel *wheel_;
+    Ref< TimerAlarm<T> > alarm_;
 };
 
 } // namespace flux
@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+#include <flux/Guard>
+#include <flux/System>
+#include <flux/Thread>
+#include <flux/TimerWheel>
+
+namespace flux {
+
+class TimerWheelThread: public Thread
+{
+public:
+    TimerWheelThread(TimerWheel *wheel): wheel_(wheel) {}
+
+private:
+    void run() { wheel_->run(); }
+
+    TimerWheel *wheel_;
+};
+
+/** Shared timer wheel with a resolution of one millisecond
+  */
+TimerWheel *TimerWheel::instance()
+{
+    return Singleton<TimerWheel>::instance();
+}
+
+TimerWheel::TimerWheel(double resolution):
+    resolution_(resolution),
+    origin_(System::now()),
+    mutex_(Mutex::create()),
+    now_(0),
+    sleepTick_(-1),
+    count_(0),
+    shutdown_(false),
+    thread_(new TimerWheelThread(this))
+{
+    memset(slots_, 0, sizeof(slots_));
+    memset(occupied_, 0, sizeof(occupied_));
+    thread_->start();
+}
+
+TimerWheel::~TimerWheel()
+{
+    {
+        Guard<Mutex> guard(mutex_);
+        shutdown_ = true;
+    }
+    wakeup_.notifyAll();
+    thread_->wait();
+    for (int level = 0; level < LevelCount; ++level) {
+        for (int slot = 0; slot < SlotCount; ++slot) {
+            for (Alarm *alarm = slots_[level][slot]; alarm;) {
+                Alarm *next = alarm->next_;
+                alarm->wheel_ = 0;
+                alarm->head_ = 0;
+                alarm->prev_ = 0;
+                alarm->next_ = 0;
+                alarm->decRefCount();
+                alarm = next;
+            }
+        }
+    }
+}
+
+/** Schedule \a alarm to expire at \a deadline (see System::now()) and then every
+  * \a interval seconds, if \a interval is positive. Rescheduling an already
+  * scheduled alarm moves its deadline.
+  */
+void TimerWheel::schedule(Alarm *alarm, double deadline, double interval)
+{
+    bool wake = false;
+    {
+        Guard<Mutex> guard(mutex_);
+        if (alarm->wheel_) {
+            FLUX_ASSERT(alarm->wheel_ == this);
+            unlink(alarm);
+        }
+        else {
+            alarm->incRefCount();
+            alarm->wheel_ = this;
+            ++count_;
+        }
+        alarm->deadline_ = deadline;
+        alarm->interval_ = interval;
+        alarm->expiry_ = expiryTick(deadline);
+        insert(alarm);
+        wake = sleepTick_ < 0 || alarm->expiry_ < sleepTick_;
+    }
+    if (wake) wakeup_.notify();
+}
+
+/** Remove \a alarm from the wheel. An alarm which is already due may still expire
+  * once after it got canceled.
+  */
+void TimerWheel::cancel(Alarm *alarm)
+{
+    {
+        Guard<Mutex> guard(mutex_);
+        if (alarm->wheel_ != this) return;
+        unlink(alarm);
+        alarm->wheel_ = 0;
+        --count_;
+    }
+    alarm->decRefCount();
+}
+
+/** Number of scheduled alarms
+  */
+int TimerWheel::count() const
+{
+    Guard<Mutex> guard(mutex_);
+    return count_;
+}
+
+inline int64_t TimerWheel::expiryTick(double deadline) const
+{
+    double t = ceil((deadline - origin_) / resolution_);
+    if (t < 0) return 0;
+    if (t > 1e18) return int64_t(1e18);
+    return int64_t(t);
+}
+
+void TimerWheel::insert(Alarm *alarm)
+{
+    int64_t e = alarm->expiry_;
+    int64_t d = e - now_;
+    if (d < 0) {
+        e = now_;
+        d = 0;
+    }
+    int level = 0;
+    while (level < LevelCount - 1 && d >= int64_t(1) << (LevelBits * (level + 1))) ++level;
+    if (d >= int64_t(1) << (LevelBits * LevelCount))
+        e = now_ + (int64_t(1) << (LevelBits * LevelCount)) - 1;
+    int slot = (e >> (LevelBits * level)) & SlotMask;
+
+    Alarm **head = &slots_[level][slot];
+    alarm->head_ = head;
+    alarm->prev_ = 0;
+    alarm->next_ = *head;
+    if (*head) (*head)->prev_ = alarm;
+    *head = alarm;
+    if (level == 0) occupied_[slot >> 6] |= uint64_t(1) << (slot & 63);
+}
+
+void TimerWheel::unlink(Alarm *alarm)
+{
+    if (alarm->prev_) alarm->prev_->next_ = alarm->next_;
+    else *alarm->head_ = alarm->next_;
+    if (alarm->next_) alarm->next_->prev_ = alarm->prev_;
+    if (!*alarm->head_) {
+        int slot = alarm->head_ - slots_[0];
+        if (0 <= slot && slot < SlotCount)
+            occupied_[slot >> 6] &= ~(uint64_t(1) << (slot & 63));
+    }
+    alarm->head_ = 0;
+    alarm->prev_ = 0;
+    alarm->next_ = 0;
+}
+
+void TimerWheel::cascade(int level)
+{
+    Alarm **head = &slots_[level][(now_ >> (LevelBits * level)) & SlotMask];
+    Alarm *alarm = *head;
+    *head = 0;
+    while (alarm) {
+        Alarm *next = alarm->next_;
+        insert(alarm);
+        alarm = next;
+    }
+}
+
+/** Next tick not earlier than now_ which needs processing: either an occupied slot
+  * on the finest level or the end of the current rotation (when coarser levels cascade).
+  */
+int64_t TimerWheel::nextTick() const
+{
+    int i = now_ & SlotMask;
+    if (i == 0) return now_;
+    int k = i >> 6;
+    uint64_t bits = occupied_[k] & (~uint64_t(0) << (i & 63));
+    while (!bits && ++k < SlotCount / 64) bits = occupied_[k];
+    if (!bits) return (now_ | SlotMask) + 1;
+    return (now_ & ~int64_t(SlotMask)) + (k << 6) + __builtin_ctzll(bits);
+}
+
+/** Process ticks up to and including \a tick until one with expiring alarms is reached
+  * and return those alarms linked by Alarm::fireNext_. The caller owns one reference to each.
+  * Stopping there ensures a periodic alarm which lags behind is not linked twice.
+  */
+Alarm *TimerWheel::advance(int64_t tick)
+{
+    Alarm *fired = 0;
+    Alarm **tail = &fired;
+    while (now_ <= tick) {
+        int64_t t = (count_ > 0) ? nextTick() : tick + 1;
+        if (t > tick) {
+            now_ = tick + 1;
+            break;
+        }
+        now_ = t;
+        int i = now_ & SlotMask;
+        if (i == 0) {
+            int level = 1;
+            while (level < LevelCount - 1 && ((now_ >> (LevelBits * level)) & SlotMask) == 0) ++level;
+            for (; level > 0; --level) cascade(level);
+        }
+        Alarm *due = slots_[0][i];
+        slots_[0][i] = 0;
+        occupied_[i >> 6] &= ~(uint64_t(1) << (i & 63));
+        ++now_;
+        while (due) {
+            Alarm *alarm = due;
+            due = alarm->next_;
+            alarm->head_ = 0;
+            alarm->prev_ = 0;
+            alarm->next_ = 0;
+            alarm->fireNext_ = 0;
+            *tail = alarm;
+            tail = &alarm->fireNext_;
+            if (alarm->interval_ > 0) {
+                alarm->incRefCount();
+                alarm->deadline_ += alarm->interval_;
+                alarm->expiry_ = expiryTick(alarm->deadline_);
+                insert(alarm);
+            }
+            else {
+                alarm->wheel_ = 0;
+                --count_;
+            }
+        }
+        if (fired) break;
+    }
+    return fired;
+}
+
+void TimerWheel::run()
+{
+    while (true) {
+        uint32_t epoch = wakeup_.prepareWait();
+        Alarm *fired = 0;
+        double timeout = -1;
+        {
+            Guard<Mutex> guard(mutex_);
+            if (shutdown_) {
+                wakeup_.cancelWait();
+                break;
+            }
+            fired = advance(int64_t(floor((System::now() - origin_) / resolution_)));
+            if (!fired) {
+                sleepTick_ = (count_ > 0) ? nextTick() : -1;
+                if (sleepTick_ >= 0) timeout = origin_ + sleepTick_ * resolution_;
+            }
+        }
+        if (fired) {
+            wakeup_.cancelWait();
+            while (fired) {
+                Alarm *alarm = fired;
+                fired = alarm->fireNext_;
+                alarm->expire();
+                alarm->decRefCount();
+            }
+            continue;
+        }
+        wakeup_.wait(epoch, timeout);
+    }
+}
+
+} // namespace flux
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_TIMERWHEEL_H
+#define FLUX_TIMERWHEEL_H
+
+#include <flux/Singleton>
+#include <flux/Mutex>
+#include <flux/EventCount>
+
+namespace flux {
+
+class TimerWheel;
+class TimerWheelThread;
+
+/** \brief Timed event scheduled on a TimerWheel
+  *
+  * Subclasses implement expire(), which is called on the wheel's thread once the
+  * deadline has passed. Expire() should return quickly, because it delays all other
+  * alarms of the same wheel.
+  * \see TimerWheel, Timer
+  */
+class Alarm: public Object
+{
+public:
+    inline bool isScheduled() const { return wheel_; }
+    inline double deadline() const { return deadline_; }
+    inline double interval() const { return interval_; }
+
+protected:
+    Alarm():
+        wheel_(0),
+        head_(0),
+        prev_(0),
+        next_(0),
+        fireNext_(0),
+        deadline_(0),
+        interval_(0),
+        expiry_(0)
+    {}
+
+    virtual void expire() = 0;
+
+private:
+    friend class TimerWheel;
+
+    TimerWheel *wheel_;
+    Alarm **head_;
+    Alarm *prev_;
+    Alarm *next_;
+    Alarm *fireNext_;
+    double deadline_;
+    double interval_;
+    int64_t expiry_;
+};
+
+/** \brief Hierarchical timing wheel
+  *
+  * A single service thread drives any number of alarms. Scheduling and canceling take
+  * constant time: alarms are kept in intrusive lists hashed by their expiry tick on four
+  * levels of 256 slots each. The finest level spans 256 ticks of the given resolution,
+  * each coarser level 256 times more. Alarms cascade down to the finer levels as their
+  * deadline approaches (G. Varghese, T. Lauck: "Hashed and Hierarchical Timing Wheels").
+  * The service thread only wakes up when a slot falls due.
+  * \see Alarm, Timer
+  */
+class TimerWheel: public Object
+{
+public:
+    static Ref<TimerWheel> create(double resolution = 0.001) {
+        return new TimerWheel(resolution);
+    }
+
+    static TimerWheel *instance();
+
+    ~TimerWheel();
+
+    inline double resolution() const { return resolution_; }
+
+    void schedule(Alarm *alarm, double deadline, double interval = 0);
+    void cancel(Alarm *alarm);
+
+    int count() const;
+
+private:
+    friend class Singleton<TimerWheel>;
+    friend class TimerWheelThread;
+
+    enum {
+        LevelBits = 8,
+        SlotCount = 1 << LevelBits,
+        SlotMask = SlotCount - 1,
+        LevelCount = 4
+    };
+
+    TimerWheel(double resolution = 0.001);
+
+    inline int64_t expiryTick(double deadline) const;
+    void insert(Alarm *alarm);
+    void unlink(Alarm *alarm);
+    void cascade(int level);
+    Alarm *advance(int64_t tick);
+    int64_t nextTick() const;
+
+    void run();
+
+    double resolution_;
+    double origin_;
+    Ref<Mutex> mutex_;
+    EventCount wakeup_;
+    int64_t now_;
+    int64_t sleepTick_;
+    int count_;
+    bool shutdown_;
+    Ref<TimerWheelThread> thread_;
+    Alarm *slots_[LevelCount][SlotCount];
+    uint64_t occupied_[SlotCount / 64];
+};
+
+} // namespace flux
+
+#endif // FLUX_TIMERWHEEL_H
@@ -11,6 +11,7 @@
 
 #include <flux/ByteArray>
 #include <flux/Utf8Walker>
+#include <flux/utf8>
 
 namespace flux {
 
@@ -37,6 +38,14 @@ public:
 
     inline int count() const {
         if (n_ == -1) {
+            const char *s = data_->chars();
+            const char *z = (const char *)memchr(s, 0, data_->count()); // the walker stops at the first zero
+            int size = z ? z - s : data_->count();
+            if (utf8::isValid(s, size)) {
+                n_ = utf8::count(s, size);
+                ascii_ = (n_ == size);
+                return n_;
+            }
             if (!walker_.valid()) {
                 walker_ = Utf8Walker(walker_.data());
                 i_ = 0;
@@ -58,6 +67,11 @@ public:
     }
 
     inline int index(const char *pos) const {
+        if (ascii_) {
+            walker_ = Utf8Walker(walker_.data(), pos);
+            i_ = pos - walker_.data();
+            return i_;
+        }
         if (!walker_.valid()) {
             walker_ = Utf8Walker(walker_.data());
             i_ = 0;
@@ -71,10 +85,16 @@ private:
     Unicode(ByteArray *data):
         data_(data),
         walker_(data->chars()),
-        i_(0), n_(-1)
+        i_(0), n_(-1),
+        ascii_(false)
     {}
 
     inline void walkTo(int i) const {
+        if (ascii_ && 0 <= i && i <= n_) {
+            walker_ = Utf8Walker(walker_.data(), walker_.data() + i);
+            i_ = i;
+            return;
+        }
         if (!walker_.valid()) {
             walker_ = Utf8Walker(walker_.data());
             i_ = 0;
@@ -86,6 +106,7 @@ private:
     Ref<ByteArray> data_;
     mutable Utf8Walker walker_;
     mutable int i_, n_;
+    mutable bool ascii_;
 };
 
 } // namespace flux
@@ -6,24 +6,17 @@
  *
  */
 
-#include <pthread.h>
-#include <math.h>
 #include <flux/exceptions>
 #include <flux/WaitCondition>
+#include "futex.h"
 
 namespace flux {
 
-WaitCondition::WaitCondition()
-{
-    int ret = pthread_cond_init(&cond_, 0);
-    if (ret != 0) FLUX_SYSTEM_DEBUG_ERROR(ret);
-}
-
-WaitCondition::~WaitCondition()
-{
-    int ret = pthread_cond_destroy(&cond_);
-    if (ret != 0) FLUX_SYSTEM_DEBUG_ERROR(ret);
-}
+WaitCondition::WaitCondition():
+    sequence_(0),
+    waiters_(0),
+    mutex_(0)
+{}
 
 /** Enter wait state and atomically unlock provided mutex.
   * The thread will be woken up again and reaquire the mutex atomically
@@ -32,39 +25,28 @@ WaitCondition::~WaitCondition()
   * Note that the first thread scheduled by the OS may invalidate
   * the condition again.
   */
-void WaitCondition::wait(Mutex *mutex)
+void WaitCondition::wait(FutexMutex *mutex)
 {
-    int ret = -1;
-    while (true) {
-        ret = pthread_cond_wait(&cond_, &mutex->Mutex::mutex_);
-        if (ret != EINTR) break;
-    }
-    if (ret != 0) FLUX_SYSTEM_DEBUG_ERROR(ret);
+    waitUntil(-1, mutex);
 }
 
 /** Same as wait(), but also wakeup if system time reaches 'timeout'.
   * (see also: now()). Returns true if the condition was signalled
   * before 'timeout', else returns false.
   */
-bool WaitCondition::waitUntil(double timeout, Mutex *mutex)
+bool WaitCondition::waitUntil(double timeout, FutexMutex *mutex)
 {
-    bool success = true;
-    struct timespec ts;
-    double sec = 0;
-    ts.tv_nsec = modf(timeout, &sec) * 1e9;
-    ts.tv_sec = sec;
-    int ret = -1;
-    while (true) {
-        ret = pthread_cond_timedwait(&cond_, &mutex->Mutex::mutex_, &ts);
-        if (ret != EINTR) break;
-    }
-    if (ret != 0) {
-        if (ret == ETIMEDOUT)
-            success = false;
-        else
-            FLUX_SYSTEM_DEBUG_ERROR(ret);
-    }
-    return success;
+    mutex_ = mutex;
+    __sync_add_and_fetch(&waiters_, 1);
+    int sequence = sequence_;
+    mutex->release();
+    int ret = futex::wait(&sequence_, sequence, timeout);
+    __sync_sub_and_fetch(&waiters_, 1);
+    if (ret != 0 && ret != ETIMEDOUT && ret != EAGAIN && ret != EINTR)
+        FLUX_SYSTEM_DEBUG_ERROR(ret);
+    // waiters may have been requeued onto the mutex, so leave it marked as contended
+    mutex->acquireSleeping();
+    return ret != ETIMEDOUT;
 }
 
 /** Wakeup at least one waiting thread.
@@ -72,16 +54,19 @@ bool WaitCondition::waitUntil(double timeout, Mutex *mutex)
   */
 void WaitCondition::signal()
 {
-    int ret = pthread_cond_signal(&cond_);
-    if (ret != 0) FLUX_SYSTEM_DEBUG_ERROR(ret);
+    __sync_add_and_fetch(&sequence_, 1);
+    if (waiters_ > 0) futex::wake(&sequence_, 1);
 }
 
 /** Wakeup all waiting threads.
   */
 void WaitCondition::broadcast()
 {
-    int ret = pthread_cond_broadcast(&cond_);
-    if (ret != 0) FLUX_SYSTEM_DEBUG_ERROR(ret);
+    int sequence = __sync_add_and_fetch(&sequence_, 1);
+    if (waiters_ == 0) return;
+    FutexMutex *mutex = mutex_;
+    if (!mutex || !futex::requeue(&sequence_, sequence, &mutex->state_))
+        futex::wake(&sequence_, intMax);
 }
 
 } // namespace flux
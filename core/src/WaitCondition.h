@@ -14,22 +14,28 @@
 namespace flux {
 
 /** \brief Wait condition
+  *
+  * Futex-based condition variable: signal() and broadcast() only enter the kernel
+  * if threads are waiting. Broadcast() wakes up a single thread and moves all other
+  * waiters over to the mutex, so they get to run one by one as the mutex is released.
+  * All threads waiting on the same condition need to use the same mutex.
   * \see Channel
   */
 class WaitCondition: public Object
 {
 public:
     inline static Ref<WaitCondition> create() { return new WaitCondition; }
-    ~WaitCondition();
-    void wait(Mutex *mutex);
-    bool waitUntil(double timeout, Mutex *mutex);
+    void wait(FutexMutex *mutex);
+    bool waitUntil(double timeout, FutexMutex *mutex);
     void signal();
     void broadcast();
 
 private:
     WaitCondition();
 
-    pthread_cond_t cond_;
+    volatile int sequence_;
+    volatile int waiters_;
+    FutexMutex * volatile mutex_;
 };
 
 } // namespace flux
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_FUTEX_H
+#define FLUX_FUTEX_H
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <limits.h>
+#include <math.h>
+#include <errno.h>
+
+namespace flux {
+namespace futex {
+
+/** Sleep while *addr equals \a value, until woken or the system time reaches \a timeout
+  * (see System::now()). A negative \a timeout means to wait forever.
+  * Returns 0 or the errno value (ETIMEDOUT, EAGAIN, EINTR, ...).
+  */
+inline int wait(volatile void *addr, int value, double timeout = -1)
+{
+    struct timespec ts;
+    struct timespec *tsp = 0;
+    if (timeout >= 0) {
+        double sec = 0;
+        ts.tv_nsec = modf(timeout, &sec) * 1e9;
+        ts.tv_sec = sec;
+        tsp = &ts;
+    }
+    int ret = syscall(SYS_futex, addr, FUTEX_WAIT_BITSET_PRIVATE | FUTEX_CLOCK_REALTIME, value, tsp, 0, FUTEX_BITSET_MATCH_ANY);
+    return (ret == -1) ? errno : 0;
+}
+
+inline void wake(volatile void *addr, int n = 1)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, n, 0, 0, 0);
+}
+
+/** Wake one thread sleeping on \a addr and move the others over to \a target,
+  * provided *addr still equals \a value. Returns false otherwise.
+  */
+inline bool requeue(volatile void *addr, int value, volatile void *target)
+{
+    return syscall(SYS_futex, addr, FUTEX_CMP_REQUEUE_PRIVATE, 1, (void *)(long)INT_MAX, target, value) != -1;
+}
+
+} // namespace futex
+} // namespace flux
+
+#endif // FLUX_FUTEX_H
@@ -0,0 +1,452 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <stdlib.h>
+#include <locale.h>
+#include <flux/strings>
+#include <flux/numbers>
+
+namespace flux {
+
+static const char digitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint32_t pow10u32[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/** Write the decimal representation of \a x to \a buf, two digits at a time
+  */
+int formatUInt64(char *buf, uint64_t x)
+{
+    char tmp[20];
+    int i = 20;
+    while (x >= 100) {
+        int r = int(x % 100);
+        x /= 100;
+        i -= 2;
+        memcpy(tmp + i, digitPairs + 2 * r, 2);
+    }
+    if (x >= 10) {
+        i -= 2;
+        memcpy(tmp + i, digitPairs + 2 * x, 2);
+    }
+    else {
+        tmp[--i] = '0' + x;
+    }
+    memcpy(buf, tmp + i, 20 - i);
+    return 20 - i;
+}
+
+int formatInt64(char *buf, int64_t x)
+{
+    if (x >= 0) return formatUInt64(buf, uint64_t(x));
+    buf[0] = '-';
+    return formatUInt64(buf + 1, uint64_t(0) - uint64_t(x)) + 1;
+}
+
+/* Grisu2 digit generation (Florian Loitsch, "Printing Floating-Point Numbers
+ * Quickly and Accurately with Integers", PLDI 2010)
+ */
+
+static const uint64_t cachedPowerF[] = {
+    0xFA8FD5A0081C0288ULL, 0xBAAEE17FA23EBF76ULL, 0x8B16FB203055AC76ULL,
+    0xCF42894A5DCE35EAULL, 0x9A6BB0AA55653B2DULL, 0xE61ACF033D1A45DFULL,
+    0xAB70FE17C79AC6CAULL, 0xFF77B1FCBEBCDC4FULL, 0xBE5691EF416BD60CULL,
+    0x8DD01FAD907FFC3CULL, 0xD3515C2831559A83ULL, 0x9D71AC8FADA6C9B5ULL,
+    0xEA9C227723EE8BCBULL, 0xAECC49914078536DULL, 0x823C12795DB6CE57ULL,
+    0xC21094364DFB5637ULL, 0x9096EA6F3848984FULL, 0xD77485CB25823AC7ULL,
+    0xA086CFCD97BF97F4ULL, 0xEF340A98172AACE5ULL, 0xB23867FB2A35B28EULL,
+    0x84C8D4DFD2C63F3BULL, 0xC5DD44271AD3CDBAULL, 0x936B9FCEBB25C996ULL,
+    0xDBAC6C247D62A584ULL, 0xA3AB66580D5FDAF6ULL, 0xF3E2F893DEC3F126ULL,
+    0xB5B5ADA8AAFF80B8ULL, 0x87625F056C7C4A8BULL, 0xC9BCFF6034C13053ULL,
+    0x964E858C91BA2655ULL, 0xDFF9772470297EBDULL, 0xA6DFBD9FB8E5B88FULL,
+    0xF8A95FCF88747D94ULL, 0xB94470938FA89BCFULL, 0x8A08F0F8BF0F156BULL,
+    0xCDB02555653131B6ULL, 0x993FE2C6D07B7FACULL, 0xE45C10C42A2B3B06ULL,
+    0xAA242499697392D3ULL, 0xFD87B5F28300CA0EULL, 0xBCE5086492111AEBULL,
+    0x8CBCCC096F5088CCULL, 0xD1B71758E219652CULL, 0x9C40000000000000ULL,
+    0xE8D4A51000000000ULL, 0xAD78EBC5AC620000ULL, 0x813F3978F8940984ULL,
+    0xC097CE7BC90715B3ULL, 0x8F7E32CE7BEA5C70ULL, 0xD5D238A4ABE98068ULL,
+    0x9F4F2726179A2245ULL, 0xED63A231D4C4FB27ULL, 0xB0DE65388CC8ADA8ULL,
+    0x83C7088E1AAB65DBULL, 0xC45D1DF942711D9AULL, 0x924D692CA61BE758ULL,
+    0xDA01EE641A708DEAULL, 0xA26DA3999AEF774AULL, 0xF209787BB47D6B85ULL,
+    0xB454E4A179DD1877ULL, 0x865B86925B9BC5C2ULL, 0xC83553C5C8965D3DULL,
+    0x952AB45CFA97A0B3ULL, 0xDE469FBD99A05FE3ULL, 0xA59BC234DB398C25ULL,
+    0xF6C69A72A3989F5CULL, 0xB7DCBF5354E9BECEULL, 0x88FCF317F22241E2ULL,
+    0xCC20CE9BD35C78A5ULL, 0x98165AF37B2153DFULL, 0xE2A0B5DC971F303AULL,
+    0xA8D9D1535CE3B396ULL, 0xFB9B7CD9A4A7443CULL, 0xBB764C4CA7A44410ULL,
+    0x8BAB8EEFB6409C1AULL, 0xD01FEF10A657842CULL, 0x9B10A4E5E9913129ULL,
+    0xE7109BFBA19C0C9DULL, 0xAC2820D9623BF429ULL, 0x80444B5E7AA7CF85ULL,
+    0xBF21E44003ACDD2DULL, 0x8E679C2F5E44FF8FULL, 0xD433179D9C8CB841ULL,
+    0x9E19DB92B4E31BA9ULL, 0xEB96BF6EBADF77D9ULL, 0xAF87023B9BF0EE6BULL
+};
+
+static const int16_t cachedPowerE[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066
+};
+
+class DiyFp
+{
+public:
+    DiyFp() {}
+    DiyFp(uint64_t f, int e): f(f), e(e) {}
+
+    DiyFp operator*(const DiyFp &b) const {
+        const uint64_t m32 = 0xFFFFFFFFU;
+        uint64_t a1 = f >> 32, a0 = f & m32, b1 = b.f >> 32, b0 = b.f & m32;
+        uint64_t t = ((a0 * b0) >> 32) + ((a1 * b0) & m32) + ((a0 * b1) & m32) + (1U << 31);
+        return DiyFp(a1 * b1 + ((a1 * b0) >> 32) + ((a0 * b1) >> 32) + (t >> 32), e + b.e + 64);
+    }
+
+    DiyFp normalized() const {
+        int s = __builtin_clzll(f);
+        return DiyFp(f << s, e - s);
+    }
+
+    uint64_t f;
+    int e;
+};
+
+inline static int countDigits(uint32_t x)
+{
+    int n = 1;
+    while (n < 10 && pow10u32[n] <= x) ++n;
+    return n;
+}
+
+inline static void grisuRound(char *digits, int n, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t wpw)
+{
+    while (
+        rest < wpw && delta - rest >= tenKappa &&
+        (rest + tenKappa < wpw || wpw - rest > rest + tenKappa - wpw)
+    ) {
+        --digits[n - 1];
+        rest += tenKappa;
+    }
+}
+
+static int generateDigits(const DiyFp &w, const DiyFp &mp, uint64_t delta, char *digits, int *k)
+{
+    const DiyFp one(uint64_t(1) << -mp.e, mp.e);
+    const uint64_t wpw = mp.f - w.f;
+    uint32_t p1 = uint32_t(mp.f >> -one.e);
+    uint64_t p2 = mp.f & (one.f - 1);
+    int kappa = countDigits(p1);
+    int n = 0;
+
+    while (kappa > 0) {
+        uint32_t d = p1 / pow10u32[kappa - 1];
+        p1 %= pow10u32[kappa - 1];
+        if (d || n) digits[n++] = '0' + d;
+        --kappa;
+        uint64_t rest = (uint64_t(p1) << -one.e) + p2;
+        if (rest <= delta) {
+            *k += kappa;
+            grisuRound(digits, n, delta, rest, uint64_t(pow10u32[kappa]) << -one.e, wpw);
+            return n;
+        }
+    }
+
+    while (true) {
+        p2 *= 10;
+        delta *= 10;
+        char d = char(p2 >> -one.e);
+        if (d || n) digits[n++] = '0' + d;
+        p2 &= one.f - 1;
+        --kappa;
+        if (p2 < delta) {
+            *k += kappa;
+            grisuRound(digits, n, delta, p2, one.f, wpw * (-kappa < 10 ? pow10u32[-kappa] : 0));
+            return n;
+        }
+    }
+}
+
+/** Generate the shortest digit string (in the vast majority of cases) which reads back as f * 2^e,
+  * where the value has the given rounding boundaries. Returns the number of digits, the value
+  * equals digits * 10^k.
+  */
+static int grisu2(uint64_t f, int e, bool lowerBoundaryCloser, char *digits, int *k)
+{
+    DiyFp plus = DiyFp((f << 1) + 1, e - 1).normalized();
+    DiyFp minus = lowerBoundaryCloser ? DiyFp((f << 2) - 1, e - 2) : DiyFp((f << 1) - 1, e - 1);
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    double dk = (-61 - plus.e) * 0.30102999566398114 + 347;
+    int ki = int(dk);
+    if (dk - ki > 0.0) ++ki;
+    int index = (ki >> 3) + 1;
+    *k = -(-348 + (index << 3));
+    DiyFp c(cachedPowerF[index], cachedPowerE[index]);
+
+    DiyFp w = DiyFp(f, e).normalized() * c;
+    DiyFp wp = plus * c;
+    DiyFp wm = minus * c;
+    ++wm.f;
+    --wp.f;
+    return generateDigits(w, wp, wp.f - wm.f, digits, k);
+}
+
+/** Lay out \a n digits with decimal exponent \a k in the style of fnum(): positional
+  * notation if the scientific exponent is within [-6, 6], scientific notation otherwise.
+  */
+static int layout(char *buf, bool negative, const char *digits, int n, int k)
+{
+    char *p = buf;
+    if (negative) *p++ = '-';
+    int e = n + k - 1;
+    if (-6 <= e && e <= 6) {
+        if (k >= 0) {
+            memcpy(p, digits, n);
+            p += n;
+            for (int i = 0; i < k; ++i) *p++ = '0';
+        }
+        else if (e >= 0) {
+            memcpy(p, digits, e + 1);
+            p += e + 1;
+            *p++ = '.';
+            memcpy(p, digits + e + 1, n - e - 1);
+            p += n - e - 1;
+        }
+        else {
+            *p++ = '0';
+            *p++ = '.';
+            for (int i = -1; i > e; --i) *p++ = '0';
+            memcpy(p, digits, n);
+            p += n;
+        }
+    }
+    else {
+        *p++ = digits[0];
+        if (n > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, n - 1);
+            p += n - 1;
+        }
+        *p++ = 'e';
+        if (e < 0) {
+            *p++ = '-';
+            e = -e;
+        }
+        p += formatUInt64(p, e);
+    }
+    return p - buf;
+}
+
+static int formatSpecial(char *buf, bool negative, bool isNan)
+{
+    const char *s = isNan ? "nan" : (negative ? "-inf" : "inf");
+    int n = strlen(s);
+    memcpy(buf, s, n);
+    return n;
+}
+
+/** Write the shortest representation of \a x which reads back to exactly \a x
+  */
+int formatFloat64(char *buf, float64_t x)
+{
+    uint64_t xi = union_cast<uint64_t>(x);
+    uint64_t f = xi & ((uint64_t(1) << 52) - 1);
+    int be = int((xi >> 52) & 0x7FF);
+    bool negative = xi >> 63;
+
+    if (be == 0x7FF) return formatSpecial(buf, negative, f != 0);
+    if (be == 0 && f == 0) {
+        buf[0] = '0';
+        return 1;
+    }
+
+    bool lowerBoundaryCloser = (f == 0 && be > 1);
+    int e = -1074;
+    if (be != 0) {
+        f |= uint64_t(1) << 52;
+        e = be - 1075;
+    }
+
+    char digits[NumberBufferSize];
+    int k = 0;
+    int n = grisu2(f, e, lowerBoundaryCloser, digits, &k);
+    return layout(buf, negative, digits, n, k);
+}
+
+/** Write the shortest representation of \a x which reads back to exactly \a x (in single precision)
+  */
+int formatFloat32(char *buf, float32_t x)
+{
+    uint32_t xi = union_cast<uint32_t>(x);
+    uint64_t f = xi & ((uint32_t(1) << 23) - 1);
+    int be = int((xi >> 23) & 0xFF);
+    bool negative = xi >> 31;
+
+    if (be == 0xFF) return formatSpecial(buf, negative, f != 0);
+    if (be == 0 && f == 0) {
+        buf[0] = '0';
+        return 1;
+    }
+
+    bool lowerBoundaryCloser = (f == 0 && be > 1);
+    int e = -149;
+    if (be != 0) {
+        f |= uint64_t(1) << 23;
+        e = be - 150;
+    }
+
+    char digits[NumberBufferSize];
+    int k = 0;
+    int n = grisu2(f, e, lowerBoundaryCloser, digits, &k);
+    return layout(buf, negative, digits, n, k);
+}
+
+inline static bool isEightDigits(uint64_t x)
+{
+    return
+        ((x & 0xF0F0F0F0F0F0F0F0ULL) |
+        (((x + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+inline static uint32_t eightDigitsValue(uint64_t x)
+{
+    x = ((x & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+    x = ((x & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+    return uint32_t(((x & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32);
+}
+
+/** Accumulate up to \a maxDigits decimal digits of \a s into \a x, eight digits at a time
+  * where possible. Returns the number of digits consumed.
+  */
+int parseDigits(const char *s, int n, int maxDigits, uint64_t *x)
+{
+    if (n > maxDigits) n = maxDigits;
+    uint64_t y = *x;
+    int i = 0;
+    #if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        memcpy(&w, s + i, 8);
+        if (!isEightDigits(w)) break;
+        y = y * 100000000 + eightDigitsValue(w);
+    }
+    #endif
+    for (; i < n && '0' <= s[i] && s[i] <= '9'; ++i)
+        y = y * 10 + (s[i] - '0');
+    *x = y;
+    return i;
+}
+
+static const float64_t exactPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/** Parse a decimal floating point literal ([+-]digits[.digits][(e|E)[+-]digits]).
+  * Values with a mantissa up to 2^53 and |exponent| <= 22 are computed exactly from
+  * the integer mantissa, all other values are handed over to strtod(3) (C locale). Returns the number of characters consumed or 0 if \a s does not
+  * start with a number.
+  */
+int parseFloat64(const char *s, int n, float64_t *x)
+{
+    int i = 0;
+    bool negative = false;
+    if (i < n && (s[i] == '+' || s[i] == '-')) {
+        negative = (s[i] == '-');
+        ++i;
+    }
+
+    uint64_t m = 0; // mantissa
+    int nm = 0; // number of significant digits in mantissa
+    int e = 0; // decimal exponent
+    bool exact = true;
+    bool hasDigits = false;
+
+    for (; i < n && s[i] == '0'; ++i) hasDigits = true;
+    {
+        int j = parseDigits(s + i, n - i, 19, &m);
+        nm = j;
+        i += j;
+        hasDigits = hasDigits || (j > 0);
+        for (; i < n && '0' <= s[i] && s[i] <= '9'; ++i) {
+            ++e;
+            exact = exact && (s[i] == '0');
+        }
+    }
+    if (i < n && s[i] == '.') {
+        int i0 = ++i;
+        if (m == 0) {
+            for (; i < n && s[i] == '0'; ++i) --e;
+        }
+        int j = parseDigits(s + i, n - i, 19 - nm, &m);
+        nm += j;
+        e -= j;
+        i += j;
+        for (; i < n && '0' <= s[i] && s[i] <= '9'; ++i)
+            exact = exact && (s[i] == '0');
+        if (i0 < i) hasDigits = true;
+        else if (!hasDigits) return 0;
+    }
+    if (!hasDigits) return 0;
+
+    if (i + 1 < n && (s[i] == 'e' || s[i] == 'E')) {
+        int j = i + 1;
+        bool expNegative = false;
+        if (s[j] == '+' || s[j] == '-') {
+            expNegative = (s[j] == '-');
+            ++j;
+        }
+        if (j < n && '0' <= s[j] && s[j] <= '9') {
+            int ep = 0;
+            for (; j < n && '0' <= s[j] && s[j] <= '9'; ++j)
+                if (ep < 100000) ep = ep * 10 + (s[j] - '0');
+            e += expNegative ? -ep : ep;
+            i = j;
+        }
+    }
+
+    float64_t y = 0;
+    if (m == 0) {
+        y = 0;
+    }
+    else if (exact && m <= (uint64_t(1) << 53) && -22 <= e && e <= 22) {
+        y = float64_t(m);
+        if (e < 0) y /= exactPow10[-e];
+        else y *= exactPow10[e];
+    }
+    else {
+        static locale_t cLocale = newlocale(LC_ALL_MASK, "C", 0);
+        char local[64];
+        char *text = (i < int(sizeof(local))) ? local : static_cast<char *>(malloc(i + 1));
+        memcpy(text, s, i);
+        text[i] = 0;
+        y = strtod_l(text, 0, cLocale);
+        if (text != local) free(text);
+        *x = y;
+        return i;
+    }
+
+    *x = negative ? -y : y;
+    return i;
+}
+
+} // namespace flux
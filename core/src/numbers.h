@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_NUMBERS_H
+#define FLUX_NUMBERS_H
+
+/** \file numbers
+  * \brief Fast conversion of numbers to text and back
+  *
+  * The format functions write into a caller-supplied buffer of at least
+  * NumberBufferSize bytes and return the number of characters written
+  * (no zero termination). The parse functions return the number of
+  * characters consumed.
+  */
+
+#include <flux/types>
+
+namespace flux {
+
+enum { NumberBufferSize = 32 };
+
+int formatUInt64(char *buf, uint64_t x);
+int formatInt64(char *buf, int64_t x);
+int formatFloat64(char *buf, float64_t x);
+int formatFloat32(char *buf, float32_t x);
+
+int parseDigits(const char *s, int n, int maxDigits, uint64_t *x);
+int parseFloat64(const char *s, int n, float64_t *x);
+
+} // namespace flux
+
+#endif // FLUX_NUMBERS_H
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUX_PARALLEL_H
+#define FLUX_PARALLEL_H
+
+/** \file parallel
+  * \brief Data-parallel loops on top of the Executor
+  */
+
+#include <flux/Array>
+#include <flux/TaskGroup>
+
+namespace flux {
+
+template<class F>
+class ParallelForTask: public Task
+{
+public:
+    ParallelForTask(TaskGroup *group, const F *f, int i0, int i1, int grainSize):
+        group_(group), f_(f), i0_(i0), i1_(i1), grainSize_(grainSize)
+    {}
+
+    void run()
+    {
+        while (i1_ - i0_ > grainSize_) {
+            int im = i0_ + (i1_ - i0_) / 2;
+            group_->run(new ParallelForTask(group_, f_, im, i1_, grainSize_));
+            i1_ = im;
+        }
+        (*f_)(i0_, i1_);
+    }
+
+private:
+    TaskGroup *group_;
+    const F *f_;
+    int i0_, i1_, grainSize_;
+};
+
+/** Call f(j0, j1) for disjoint sub-ranges [j0, j1) covering [i0, i1) in parallel.
+  * The range is split recursively until sub-ranges are no larger than \a grainSize,
+  * idle workers steal the larger halves.
+  */
+template<class F>
+void parallelFor(int i0, int i1, const F &f, int grainSize = 1, Executor *executor = 0)
+{
+    if (i1 <= i0) return;
+    if (grainSize < 1) grainSize = 1;
+    Ref<TaskGroup> group = TaskGroup::create(executor);
+    group->run(new ParallelForTask<F>(group, &f, i0, i1, grainSize));
+    group->wait();
+}
+
+template<class T, class F>
+class ParallelReduceTask: public Task
+{
+public:
+    ParallelReduceTask(const F *f, int i0, int i1, T *result):
+        f_(f), i0_(i0), i1_(i1), result_(result)
+    {}
+
+    void run() { *result_ = (*f_)(i0_, i1_); }
+
+private:
+    const F *f_;
+    int i0_, i1_;
+    T *result_;
+};
+
+/** Compute f(j0, j1) for consecutive chunks [j0, j1) of [i0, i1) in parallel and
+  * combine the partial results from left to right using reduce(a, b).
+  */
+template<class T, class F, class R>
+T parallelReduce(int i0, int i1, const T &identity, const F &f, const R &reduce, int grainSize = 1, Executor *executor = 0)
+{
+    if (i1 <= i0) return identity;
+    if (!executor) executor = Executor::instance();
+    if (grainSize < 1) grainSize = 1;
+    int n = (i1 - i0 + grainSize - 1) / grainSize;
+    if (n > 4 * executor->concurrency()) n = 4 * executor->concurrency();
+    Ref< Array<T> > results = Array<T>::create(n);
+    {
+        Ref<TaskGroup> group = TaskGroup::create(executor);
+        for (int k = 0; k < n; ++k) {
+            int j0 = i0 + int(int64_t(i1 - i0) * k / n);
+            int j1 = i0 + int(int64_t(i1 - i0) * (k + 1) / n);
+            group->run(new ParallelReduceTask<T, F>(&f, j0, j1, results->data() + k));
+        }
+        group->wait();
+    }
+    T x = identity;
+    for (int k = 0; k < n; ++k)
+        x = reduce(x, results->at(k));
+    return x;
+}
+
+} // namespace flux
+
+#endif // FLUX_PARALLEL_H
@@ -6,12 +6,279 @@
  *
  */
 
+#include <stdlib.h> // atexit
+#include <string.h> // memcpy, memchr
 #include <flux/Singleton>
+#include <flux/ThreadLocalRef>
+#include <flux/LocalStatic>
+#include <flux/Mutex>
+#include <flux/Guard>
+#include <flux/Set>
 #include <flux/File>
 #include <flux/stdio>
 
 namespace flux {
 
+class StdOutStream;
+
+/** Output buffer of a single thread
+  */
+class StdOutBuffer: public Object
+{
+public:
+    StdOutBuffer(StdOutStream *stream, int capacity);
+    ~StdOutBuffer();
+
+    void write(const ByteArray *data);
+    void write(const StringList *parts);
+    void flush();
+
+private:
+    void writeOut();
+
+    StdOutStream *stream_;
+    Ref<Mutex> mutex_;
+    Ref<ByteArray> buffer_;
+    int fill_;
+};
+
+/** Standard output, buffered per thread
+  */
+class StdOutStream: public SystemStream
+{
+public:
+    StdOutStream():
+        SystemStream(File::StandardOutput),
+        lineBuffered_(isatty()),
+        capacity_(0x4000),
+        buffersMutex_(Mutex::create()),
+        buffers_(Buffers::create()),
+        outputMutex_(Mutex::create())
+    {
+        instance_ = this;
+        ::atexit(flushAtExit);
+    }
+
+    inline bool lineBuffered() const { return lineBuffered_; }
+
+    virtual void write(const ByteArray *data)
+    {
+        buffer()->write(data);
+    }
+
+    virtual void write(const StringList *parts)
+    {
+        buffer()->write(parts);
+    }
+
+    /** Flushes the buffers, so data handed over to the direct sink is kept in order
+      */
+    virtual SystemStream *directSink()
+    {
+        flush();
+        return this;
+    }
+
+    /** Write out the buffer of the calling thread
+      */
+    void flushCurrent()
+    {
+        StdOutBuffer *buffer = ThreadLocalRef<StdOutBuffer>::cached();
+        if (buffer) buffer->flush();
+    }
+
+    void flush()
+    {
+        Guard<Mutex> guard(buffersMutex_);
+        for (int i = 0; i < buffers_->count(); ++i)
+            buffers_->at(i)->flush();
+    }
+
+    void unregisterBuffer(StdOutBuffer *buffer)
+    {
+        Guard<Mutex> guard(buffersMutex_);
+        buffers_->remove(buffer);
+    }
+
+    void writeThrough(const ByteArray *data)
+    {
+        Guard<Mutex> guard(outputMutex_);
+        SystemStream::write(data);
+    }
+
+    void writeThrough(const StringList *parts)
+    {
+        Guard<Mutex> guard(outputMutex_);
+        SystemStream::write(parts);
+    }
+
+    static StdOutStream *instance_;
+
+private:
+    StdOutBuffer *buffer()
+    {
+        StdOutBuffer *cached = ThreadLocalRef<StdOutBuffer>::cached();
+        if (cached) return cached;
+        ThreadLocalRef<StdOutBuffer> &buffer = localStatic< ThreadLocalRef<StdOutBuffer>, StdOutStream >();
+        if (!buffer) {
+            buffer = new StdOutBuffer(this, capacity_);
+            Guard<Mutex> guard(buffersMutex_);
+            buffers_->insert(buffer);
+        }
+        return buffer;
+    }
+
+    static void flushAtExit()
+    {
+        try {
+            instance_->flush();
+        }
+        catch (...)
+        {}
+    }
+
+    bool lineBuffered_;
+    int capacity_;
+
+    typedef Set<StdOutBuffer *> Buffers;
+    Ref<Mutex> buffersMutex_;
+    Ref<Buffers> buffers_;
+    Ref<Mutex> outputMutex_;
+};
+
+StdOutStream *StdOutStream::instance_ = 0;
+
+StdOutBuffer::StdOutBuffer(StdOutStream *stream, int capacity):
+    stream_(stream),
+    mutex_(Mutex::create()),
+    buffer_(ByteArray::allocate(capacity)),
+    fill_(0)
+{}
+
+StdOutBuffer::~StdOutBuffer()
+{
+    try {
+        flush();
+    }
+    catch (...)
+    {}
+    stream_->unregisterBuffer(this);
+}
+
+/** Append \a data to the buffer or pass it on at once, if it does not fit
+  */
+void StdOutBuffer::write(const ByteArray *data)
+{
+    Guard<Mutex> guard(mutex_);
+
+    if (fill_ + data->count() > buffer_->count()) {
+        writeOut();
+        if (data->count() >= buffer_->count()) {
+            stream_->writeThrough(data);
+            return;
+        }
+    }
+
+    memcpy(buffer_->bytes() + fill_, data->bytes(), data->count());
+    fill_ += data->count();
+
+    if (stream_->lineBuffered() && memchr(data->bytes(), '\n', data->count())) writeOut();
+}
+
+/** Append all \a parts to the buffer or pass them on at once, together with the
+  * data already buffered
+  */
+void StdOutBuffer::write(const StringList *parts)
+{
+    Guard<Mutex> guard(mutex_);
+
+    int total = 0;
+    for (int i = 0; i < parts->count(); ++i)
+        total += parts->at(i)->count();
+
+    if (fill_ + total > buffer_->count()) {
+        if (total >= buffer_->count()) {
+            if (fill_ == 0) {
+                stream_->writeThrough(parts);
+                return;
+            }
+            Ref<StringList> gather = StringList::create();
+            gather->append(buffer_->select(0, fill_));
+            gather->appendList(parts);
+            fill_ = 0;
+            stream_->writeThrough(gather);
+            return;
+        }
+        writeOut();
+    }
+
+    bool newLine = false;
+    for (int i = 0; i < parts->count(); ++i) {
+        ByteArray *part = parts->at(i);
+        memcpy(buffer_->bytes() + fill_, part->bytes(), part->count());
+        fill_ += part->count();
+        newLine = newLine || memchr(part->bytes(), '\n', part->count());
+    }
+
+    if (newLine && stream_->lineBuffered()) writeOut();
+}
+
+void StdOutBuffer::flush()
+{
+    Guard<Mutex> guard(mutex_);
+    writeOut();
+}
+
+void StdOutBuffer::writeOut()
+{
+    if (fill_ == 0) return;
+    Ref<ByteArray> data = buffer_->select(0, fill_);
+    fill_ = 0;
+    stream_->writeThrough(data);
+}
+
+/** Standard input, flushing the standard output before reading from a terminal
+  */
+class StdInStream: public SystemStream
+{
+public:
+    StdInStream(): SystemStream(File::StandardInput) {}
+
+    virtual int read(ByteArray *data)
+    {
+        StdOutStream *out = StdOutStream::instance_;
+        if (out && out->lineBuffered()) out->flush();
+        return SystemStream::read(data);
+    }
+};
+
+/** Standard error, flushing the standard output of the calling thread before each write
+  */
+class StdErrStream: public SystemStream
+{
+public:
+    StdErrStream(): SystemStream(File::StandardError) {}
+
+    virtual void write(const ByteArray *data)
+    {
+        flushOut();
+        SystemStream::write(data);
+    }
+
+    virtual void write(const StringList *parts)
+    {
+        flushOut();
+        SystemStream::write(parts);
+    }
+
+private:
+    inline static void flushOut()
+    {
+        StdOutStream *out = StdOutStream::instance_;
+        if (out) out->flushCurrent();
+    }
+};
+
 template<int fd>
 class StdIo: public Object, public Singleton< StdIo<fd> >
 {
@@ -22,8 +289,37 @@ public:
     Ref<SystemStream> stream_;
 };
 
+template<>
+StdIo<File::StandardInput>::StdIo():
+    stream_(new StdInStream)
+{}
+
+template<>
+StdIo<File::StandardOutput>::StdIo():
+    stream_(new StdOutStream)
+{}
+
+template<>
+StdIo<File::StandardError>::StdIo():
+    stream_(new StdErrStream)
+{}
+
 SystemStream *stdIn() { return StdIo<File::StandardInput>::instance()->stream_; }
 SystemStream *stdOut() { return StdIo<File::StandardOutput>::instance()->stream_; }
 SystemStream *stdErr() { return StdIo<File::StandardError>::instance()->stream_; }
 
+/** Write out the standard output buffers of all threads
+  */
+void flushStdOut()
+{
+    if (StdOutStream::instance_) StdOutStream::instance_->flush();
+}
+
+/** Write out the standard output buffer of the calling thread
+  */
+void flushThreadStdOut()
+{
+    if (StdOutStream::instance_) StdOutStream::instance_->flushCurrent();
+}
+
 } // namespace flux
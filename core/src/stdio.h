@@ -11,6 +11,15 @@
 
 /** \file stdio
   * \brief Standard input/output streams
+  *
+  * Writes to stdOut() are collected in a buffer per thread. Each write, and so each
+  * Format, is kept in one piece. A terminal gets to see the output line by line,
+  * other files and pipes whenever a buffer runs full. Buffers are flushed when their
+  * thread terminates (or its run() returns on a carrier of a reusing ThreadFactory),
+  * before the process exits or forks, before reading from stdIn() on a terminal,
+  * before a kernel transfer to stdOut() and by flushStdOut() or flushThreadStdOut().
+  * Writes to stdErr() are not buffered, they flush the standard output buffer of the
+  * writing thread first (so a message follows the output it refers to).
   */
 
 #include <flux/SystemStream>
@@ -22,6 +31,9 @@ SystemStream *stdIn();
 SystemStream *stdOut();
 SystemStream *stdErr();
 
+void flushStdOut();
+void flushThreadStdOut();
+
 inline Format fout(String pattern = "") { return Format(pattern, stdOut()); }
 inline Format ferr(String pattern = "") { return Format(pattern, stdErr()); }
 
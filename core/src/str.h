@@ -15,6 +15,7 @@
 
 #include <flux/String>
 #include <flux/Variant>
+#include <flux/numbers>
 
 namespace flux {
 
@@ -39,6 +40,10 @@ struct Sign<unsigned long long> { inline static int get(unsigned long long) { re
 template<class T>
 String inum(T x, int base = 10, int n = -1)
 {
+    if (base == 10 && n < 0) {
+        char buf[NumberBufferSize];
+        return String(buf, Sign<T>::get(x) ? formatInt64(buf, int64_t(x)) : formatUInt64(buf, uint64_t(x)));
+    }
     int sign = Sign<T>::get(x);
     if (sign) x = -x;
     int m = (x == 0);
@@ -106,8 +111,8 @@ inline String str(short x) { return dec(x); }
 inline String str(int x) { return dec(x); }
 inline String str(long x) { return dec(x); }
 inline String str(long long x) { return dec(x); }
-inline String str(float x) { return dec(x); }
-inline String str(double x) { return dec(x); }
+inline String str(float x) { char buf[NumberBufferSize]; return String(buf, formatFloat32(buf, x)); }
+inline String str(double x) { char buf[NumberBufferSize]; return String(buf, formatFloat64(buf, x)); }
 
 String left(const String &s, int w, char blank = ' ');
 String right(const String &s, int w, char blank = ' ');
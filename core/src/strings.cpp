@@ -6,6 +6,9 @@
  *
  */
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include <flux/strings>
 
 namespace flux {
@@ -22,6 +25,24 @@ char *strdup(const char *s)
     return s2;
 }
 
+int memscan(const char *s, int n, char a, char b)
+{
+    int i = 0;
+    #ifdef __SSE2__
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(x, va), _mm_cmpeq_epi8(x, vb)));
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+    #endif
+    for (; i < n; ++i) {
+        if (s[i] == a || s[i] == b) break;
+    }
+    return i;
+}
+
 char *strcat(const char *s0, const char *s1, const char *s2, const char *s3, const char *s4, const char *s5, const char *s6, const char *s7)
 {
     int len = 0;
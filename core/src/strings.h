@@ -58,6 +58,11 @@ inline int strcasecmp(const char *a, const char *b)
 char *strdup(const char *s);
 char *strcat(const char *s0, const char *s1 = 0, const char *s2 = 0, const char *s3 = 0, const char *s4 = 0, const char *s5 = 0, const char *s6 = 0, const char *s7 = 0);
 
+/** Return the index of the first occurrence of \a a or \a b in the \a n bytes at \a s
+  * or \a n if neither occurs
+  */
+int memscan(const char *s, int n, char a, char b);
+
 char *intToStr(int value);
 int strToInt(const char *s, int i0 = 0, int i1 = intMax, int base = 10);
 
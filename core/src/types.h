@@ -17,6 +17,11 @@
 #include <stdint.h> // (u)int8_t .. (u)int64_t
 #include <flux/assert>
 
+/** Storage class of hot thread-local variables: compiler-native TLS in the
+  * initial-exec model, which costs a single %fs-relative load per access
+  */
+#define FLUX_THREAD_LOCAL __thread __attribute__((tls_model("initial-exec")))
+
 typedef float float32_t;
 typedef double float64_t;
 
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <flux/utf16>
+
+namespace flux {
+namespace utf16 {
+
+#ifdef __SSE2__
+/** Check if all eight 16 bit words of \a x are in the 7 bit ASCII range
+  */
+inline static bool isAscii(__m128i x)
+{
+    const __m128i high = _mm_set1_epi16(short(0xFF80));
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(x, high), _mm_setzero_si128())) == 0xFFFF;
+}
+#endif
+
+/** Decode a single code point, returns the number of words consumed or 0 on an
+  * unpaired surrogate.
+  */
+inline static int decodeUnit(const uint16_t *s, int n, uchar_t *ch)
+{
+    uchar_t w = s[0];
+    if (w < 0xD800 || 0xDFFF < w) {
+        *ch = w;
+        return 1;
+    }
+    if (0xDBFF < w || n < 2 || s[1] < 0xDC00 || 0xDFFF < s[1]) return 0;
+    *ch = 0x10000 + (((w - 0xD800) << 10) | (s[1] - 0xDC00));
+    return 2;
+}
+
+/** Check if \a size 16 bit words of \a data form a well-formed UTF-16 sequence
+  * (local endian). If the check fails the word offset of the first unpaired
+  * surrogate is returned in \a errorOffset.
+  */
+bool isValid(const uint16_t *data, int size, int *errorOffset)
+{
+    for (int i = 0; i < size;) {
+        uchar_t ch;
+        int l = decodeUnit(data + i, size - i, &ch);
+        if (l == 0) {
+            if (errorOffset) *errorOffset = i;
+            return false;
+        }
+        i += l;
+    }
+    return true;
+}
+
+/** Return the number of bytes toUtf8() will produce or -1 if the input is malformed
+  */
+int utf8Size(const uint16_t *data, int size)
+{
+    int n = 0;
+    int i = 0;
+    while (i < size) {
+        #ifdef __SSE2__
+        for (; i + 8 <= size; i += 8, n += 8) {
+            if (!isAscii(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)))) break;
+        }
+        if (i == size) break;
+        #endif
+        uchar_t ch;
+        int l = decodeUnit(data + i, size - i, &ch);
+        if (l == 0) return -1;
+        i += l;
+        n += 1 + (0x7F < ch) + (0x7FF < ch) + (0xFFFF < ch);
+    }
+    return n;
+}
+
+/** Transcode \a size 16 bit words of UTF-16 \a data (local endian) to UTF-8 and return the
+  * number of bytes written to \a sink or -1 if the input is malformed. The sink needs to
+  * provide room for utf8Size(data, size) bytes.
+  */
+int toUtf8(const uint16_t *data, int size, char *sink)
+{
+    uint8_t *d = reinterpret_cast<uint8_t *>(sink);
+    int i = 0;
+    while (i < size) {
+        #ifdef __SSE2__
+        for (; i + 16 <= size; i += 16, d += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 8));
+            if (!isAscii(_mm_or_si128(a, b))) break;
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(d), _mm_packus_epi16(a, b));
+        }
+        if (i == size) break;
+        #endif
+        uchar_t ch;
+        int l = decodeUnit(data + i, size - i, &ch);
+        if (l == 0) return -1;
+        i += l;
+        if (ch < 0x80) {
+            *d++ = ch;
+        }
+        else if (ch < 0x800) {
+            *d++ = (ch >> 6) | 0xC0;
+            *d++ = (ch & 0x3F) | 0x80;
+        }
+        else if (ch < 0x10000) {
+            *d++ = (ch >> 12) | 0xE0;
+            *d++ = ((ch >> 6) & 0x3F) | 0x80;
+            *d++ = (ch & 0x3F) | 0x80;
+        }
+        else {
+            *d++ = (ch >> 18) | 0xF0;
+            *d++ = ((ch >> 12) & 0x3F) | 0x80;
+            *d++ = ((ch >> 6) & 0x3F) | 0x80;
+            *d++ = (ch & 0x3F) | 0x80;
+        }
+    }
+    return d - reinterpret_cast<uint8_t *>(sink);
+}
+
+}} // namespace flux::utf16
@@ -62,6 +62,10 @@ inline int encodedSize(uchar_t ch)
     return 2 * (1 + (0xFFFF < ch));
 }
 
+bool isValid(const uint16_t *data, int size, int *errorOffset = 0);
+int utf8Size(const uint16_t *data, int size);
+int toUtf8(const uint16_t *data, int size, char *sink);
+
 } // namespace utf16
 
 } // namespace flux
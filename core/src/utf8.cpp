@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <flux/strings>
+#include <flux/utf8>
+
+namespace flux {
+namespace utf8 {
+
+/** Return the number of leading 7 bit ASCII bytes
+  */
+inline static int asciiPrefix(const uint8_t *s, int n)
+{
+    int i = 0;
+    #ifdef __SSE2__
+    for (; i + 16 <= n; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i)));
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+    #else
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x;
+        memcpy(&x, s + i, 8);
+        if (x & 0x8080808080808080ULL) break;
+    }
+    #endif
+    while (i < n && s[i] < 0x80) ++i;
+    return i;
+}
+
+/** Decode a single multibyte sequence strictly following RFC 3629 (no overlong
+  * encodings, no surrogates, nothing beyond 0x10FFFF). Returns the length of
+  * the sequence or 0 if the sequence is malformed.
+  */
+inline static int decodeSequence(const uint8_t *s, int n, uchar_t *ch)
+{
+    uint8_t b0 = s[0];
+    if (b0 < 0x80) {
+        *ch = b0;
+        return 1;
+    }
+    if (b0 < 0xC2) return 0; // continuation byte or overlong two-byte code
+    if (b0 < 0xE0) {
+        if (n < 2 || (s[1] & 0xC0) != 0x80) return 0;
+        *ch = (uchar_t(b0 & 0x1F) << 6) | (s[1] & 0x3F);
+        return 2;
+    }
+    if (b0 < 0xF0) {
+        if (n < 3 || (s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80) return 0;
+        uchar_t c = (uchar_t(b0 & 0x0F) << 12) | (uchar_t(s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+        if (c < 0x800 || (0xD800 <= c && c <= 0xDFFF)) return 0;
+        *ch = c;
+        return 3;
+    }
+    if (b0 < 0xF5) {
+        if (n < 4 || (s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80 || (s[3] & 0xC0) != 0x80) return 0;
+        uchar_t c = (uchar_t(b0 & 0x07) << 18) | (uchar_t(s[1] & 0x3F) << 12) | (uchar_t(s[2] & 0x3F) << 6) | (s[3] & 0x3F);
+        if (c < 0x10000 || 0x10FFFF < c) return 0;
+        *ch = c;
+        return 4;
+    }
+    return 0;
+}
+
+/** Check if \a size bytes of \a data form a well-formed UTF-8 sequence.
+  * Runs of 7 bit ASCII are skipped blockwise. If the check fails the byte offset
+  * of the first malformed sequence is returned in \a errorOffset.
+  */
+bool isValid(const char *data, int size, int *errorOffset)
+{
+    const uint8_t *s = reinterpret_cast<const uint8_t *>(data);
+    int i = 0;
+    while (i < size) {
+        i += asciiPrefix(s + i, size - i);
+        while (i < size && 0x7F < s[i]) {
+            uchar_t ch;
+            int l = decodeSequence(s + i, size - i, &ch);
+            if (l == 0) {
+                if (errorOffset) *errorOffset = i;
+                return false;
+            }
+            i += l;
+        }
+    }
+    return true;
+}
+
+/** Count the number of Unicode characters in \a size bytes of well-formed UTF-8 \a data
+  */
+int count(const char *data, int size)
+{
+    const uint8_t *s = reinterpret_cast<const uint8_t *>(data);
+    int n = 0; // number of continuation bytes
+    int i = 0;
+    #ifdef __SSE2__
+    // continuation bytes (10xxxxxx) are exactly the bytes smaller than (signed char)0xC0
+    const __m128i limit = _mm_set1_epi8(char(0xC0));
+    const __m128i zero = _mm_setzero_si128();
+    while (i + 16 <= size) {
+        __m128i acc = zero;
+        for (int k = 0; k < 255 && i + 16 <= size; ++k, i += 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+            acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(limit, x));
+        }
+        acc = _mm_sad_epu8(acc, zero);
+        n += _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+    }
+    #endif
+    for (; i < size; ++i)
+        n += ((s[i] & 0xC0) == 0x80);
+    return size - n;
+}
+
+/** Return the number of 16 bit words toUtf16() will produce
+  */
+int utf16Size(const char *data, int size)
+{
+    const uint8_t *s = reinterpret_cast<const uint8_t *>(data);
+    int n = 0;
+    int i = 0;
+    while (i < size) {
+        int k = asciiPrefix(s + i, size - i);
+        i += k;
+        n += k;
+        if (i == size) break;
+        uchar_t ch;
+        int l = decodeSequence(s + i, size - i, &ch);
+        if (l == 0) l = 1;
+        i += l;
+        n += 1 + (l == 4);
+    }
+    return n;
+}
+
+/** Transcode \a size bytes of UTF-8 \a data to UTF-16 (local endian) and return the
+  * number of 16 bit words written to \a sink. Malformed input bytes are replaced by
+  * the replacement character (0xFFFD). The sink needs to provide room for
+  * utf16Size(data, size) words.
+  */
+int toUtf16(const char *data, int size, uint16_t *sink)
+{
+    const uint8_t *s = reinterpret_cast<const uint8_t *>(data);
+    uint16_t *d = sink;
+    int i = 0;
+    while (i < size) {
+        if (s[i] < 0x80) {
+            #ifdef __SSE2__
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= size; i += 16, d += 16) {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+                if (_mm_movemask_epi8(x) != 0) break;
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d), _mm_unpacklo_epi8(x, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d + 8), _mm_unpackhi_epi8(x, zero));
+            }
+            #endif
+            for (; i < size && s[i] < 0x80; ++i)
+                *d++ = s[i];
+            if (i == size) break;
+        }
+        uchar_t ch;
+        int l = decodeSequence(s + i, size - i, &ch);
+        if (l == 0) {
+            ch = 0xFFFD;
+            l = 1;
+        }
+        i += l;
+        if (ch < 0x10000) {
+            *d++ = ch;
+        }
+        else {
+            ch -= 0x10000;
+            *d++ = (ch >> 10) + 0xD800;
+            *d++ = (ch & 0x3FF) + 0xDC00;
+        }
+    }
+    return d - sink;
+}
+
+}} // namespace flux::utf8
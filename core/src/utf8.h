@@ -66,6 +66,11 @@ public:
     }
 };
 
+bool isValid(const char *data, int size, int *errorOffset = 0);
+int count(const char *data, int size);
+int utf16Size(const char *data, int size);
+int toUtf16(const char *data, int size, uint16_t *sink);
+
 } // namespace utf8
 
 } // namespace flux
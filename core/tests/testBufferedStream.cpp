@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/testing/TestSuite>
+#include <flux/stdio>
+#include <flux/System>
+#include <flux/LineSource>
+#include <flux/BufferedStream>
+
+using namespace flux;
+using namespace flux::testing;
+
+/** Deliver a string in blocks of at most blockSize bytes and record all writes
+  */
+class PieceStream: public Stream
+{
+public:
+    static Ref<PieceStream> open(String text, int blockSize) { return new PieceStream(text, blockSize); }
+
+    virtual int read(ByteArray *data) {
+        int n = text_->count() - i_;
+        if (n > blockSize_) n = blockSize_;
+        if (n > data->count()) n = data->count();
+        memcpy(data->bytes(), text_->bytes() + i_, n);
+        i_ += n;
+        return n;
+    }
+
+    virtual void write(const ByteArray *data) {
+        written_->append(data->copy());
+    }
+
+    virtual void write(const StringList *parts) {
+        written_->append(parts->join());
+    }
+
+    StringList *written() const { return written_; }
+
+private:
+    PieceStream(String text, int blockSize):
+        text_(text),
+        blockSize_(blockSize),
+        i_(0),
+        written_(StringList::create())
+    {}
+
+    String text_;
+    int blockSize_;
+    int i_;
+    Ref<StringList> written_;
+};
+
+class ReadRecords: public TestCase
+{
+    void run()
+    {
+        Ref<StringList> lines = StringList::create();
+        for (int i = 0; i < 200; ++i)
+            lines->append(String(i * 7 % 100, 'a' + i % 26));
+        lines->append(String(1000, 'x'));
+        String text = Format() << lines->join("\r\n") << "\nlast";
+
+        for (int blockSize = 1; blockSize < 200; blockSize += 37) {
+            Ref<BufferedStream> stream = BufferedStream::open(PieceStream::open(text, blockSize), 64);
+            for (int i = 0; i < lines->count(); ++i) {
+                ByteArray *line = stream->readLine();
+                FLUX_VERIFY(line);
+                FLUX_VERIFY(line->copy() == lines->at(i));
+            }
+            ByteArray *last = stream->readUntil('\n');
+            FLUX_VERIFY(last && last->copy() == "last");
+            FLUX_VERIFY(!stream->readLine());
+        }
+
+        Ref<BufferedStream> stream = BufferedStream::open(PieceStream::open("a,,b,", 2));
+        FLUX_VERIFY(stream->readUntil(',')->copy() == "a");
+        FLUX_VERIFY(stream->readUntil(',')->copy() == "");
+        Ref<ByteArray> buf = ByteArray::create(1);
+        FLUX_VERIFY(stream->read(buf) == 1 && buf->copy() == "b");
+        FLUX_VERIFY(stream->readUntil(',')->copy() == "");
+        FLUX_VERIFY(!stream->readUntil(','));
+    }
+};
+
+class LineSourceRead: public TestCase
+{
+    void run()
+    {
+        String text = "one\r\ntwo\rthree\n\nfour";
+        for (int blockSize = 1; blockSize < 8; ++blockSize) {
+            Ref<LineSource> source = LineSource::open(PieceStream::open(text, blockSize), ByteArray::create(4));
+            Ref<StringList> lines = StringList::create();
+            for (String line; source->read(&line);) lines->append(line);
+            FLUX_VERIFY(lines->join("|") == "one|two|three||four");
+        }
+        Ref<LineSource> source = LineSource::open(String("a\nb"));
+        FLUX_VERIFY(source->readLine() == "a");
+        FLUX_VERIFY(source->readLine() == "b");
+        String line;
+        FLUX_VERIFY(!source->read(&line));
+    }
+};
+
+class WriteCoalescing: public TestCase
+{
+    void run()
+    {
+        Ref<PieceStream> sink = PieceStream::open("", 1);
+        {
+            Ref<BufferedStream> stream = BufferedStream::open(sink, 16);
+            for (int i = 0; i < 10; ++i) stream->write("abc");
+            FLUX_VERIFY(sink->written()->count() == 1);
+            stream->flush();
+            FLUX_VERIFY(sink->written()->count() == 2);
+            stream->write("x");
+            stream->write(String(32, 'y'));
+            Format(stream) << "z" << 1;
+        }
+        FLUX_VERIFY(sink->written()->count() == 4);
+        String expected = Format() << "abcabcabcabcabcabcabcabcabcabc" << "x" << String(32, 'y') << "z1";
+        FLUX_VERIFY(sink->written()->join() == expected);
+    }
+};
+
+class LineCost: public TestCase
+{
+    void run()
+    {
+        const int n = 100000;
+        Ref<StringList> lines = StringList::create();
+        for (int i = 0; i < n; ++i) lines->append(Format("line %% of %%") << i << n);
+        String text = lines->join("\n");
+
+        double t0 = System::now();
+        Ref<LineSource> source = LineSource::open(PieceStream::open(text, 0x10000));
+        int n1 = 0;
+        for (String line; source->read(&line);) ++n1;
+        double t1 = System::now();
+        Ref<BufferedStream> stream = BufferedStream::open(PieceStream::open(text, 0x10000));
+        int n2 = 0;
+        while (stream->readLine()) ++n2;
+        double t2 = System::now();
+
+        fout("%% ns/line LineSource, %% ns/line BufferedStream::readLine()\n")
+            << int((t1 - t0) * 1e9 / n) << int((t2 - t1) * 1e9 / n);
+        FLUX_VERIFY(n1 == n);
+        FLUX_VERIFY(n2 == n);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    FLUX_TESTSUITE_ADD(ReadRecords);
+    FLUX_TESTSUITE_ADD(LineSourceRead);
+    FLUX_TESTSUITE_ADD(WriteCoalescing);
+    FLUX_TESTSUITE_ADD(LineCost);
+
+    return testSuite()->run(argc, argv);
+}
@@ -10,6 +10,8 @@
 #include <flux/stdio>
 #include <flux/Thread>
 #include <flux/Channel>
+#include <flux/BoundedChannel>
+#include <flux/SpscChannel>
 #include <flux/List>
 #include <flux/Random>
 #include <flux/System>
@@ -104,9 +106,210 @@ class ConsumerProducer: public TestCase
     }
 };
 
+template<class ChannelType>
+class Sender: public Thread
+{
+public:
+    static Ref<Sender> start(ChannelType *channel, int first, int count, int batchSize) {
+        Ref<Sender> sender = new Sender(channel, first, count, batchSize);
+        sender->Thread::start();
+        return sender;
+    }
+
+private:
+    Sender(ChannelType *channel, int first, int count, int batchSize):
+        channel_(channel), first_(first), count_(count), batchSize_(batchSize)
+    {}
+
+    void run()
+    {
+        int batch[64];
+        for (int i = first_, n = first_ + count_; i < n;) {
+            if (batchSize_ == 1) {
+                channel_->push(i++);
+                continue;
+            }
+            int m = 0;
+            while (m < batchSize_ && i < n) batch[m++] = i++;
+            channel_->pushBatch(batch, m);
+        }
+    }
+
+    Ref<ChannelType> channel_;
+    int first_, count_, batchSize_;
+};
+
+template<class ChannelType>
+class Receiver: public Thread
+{
+public:
+    static Ref<Receiver> start(ChannelType *channel, int count, int batchSize) {
+        Ref<Receiver> receiver = new Receiver(channel, count, batchSize);
+        receiver->Thread::start();
+        return receiver;
+    }
+
+    int64_t sum() const { return sum_; }
+    bool ordered() const { return ordered_; }
+
+private:
+    Receiver(ChannelType *channel, int count, int batchSize):
+        channel_(channel), count_(count), batchSize_(batchSize), sum_(0), ordered_(true)
+    {}
+
+    void run()
+    {
+        int batch[64];
+        int last = -1;
+        while (count_ > 0) {
+            int m = channel_->popBatch(batch, batchSize_ < count_ ? batchSize_ : count_);
+            for (int i = 0; i < m; ++i) {
+                sum_ += batch[i];
+                if (batch[i] <= last) ordered_ = false;
+                last = batch[i];
+            }
+            count_ -= m;
+        }
+    }
+
+    Ref<ChannelType> channel_;
+    int count_, batchSize_;
+    int64_t sum_;
+    bool ordered_;
+};
+
+class BoundedChannels: public TestCase
+{
+    void run()
+    {
+        {
+            typedef BoundedChannel<int> IntChannel;
+            Ref<IntChannel> channel = IntChannel::create(64);
+            const int n = 100000, m = 4;
+            typedef List< Ref< Sender<IntChannel> > > SenderList;
+            typedef List< Ref< Receiver<IntChannel> > > ReceiverList;
+            Ref<SenderList> senders = SenderList::create();
+            Ref<ReceiverList> receivers = ReceiverList::create();
+            for (int i = 0; i < m; ++i) {
+                receivers->append(Receiver<IntChannel>::start(channel, n, 1 + 7 * i));
+                senders->append(Sender<IntChannel>::start(channel, i * n, n, 1 + 5 * i));
+            }
+            int64_t sum = 0;
+            for (int i = 0; i < m; ++i) {
+                senders->at(i)->wait();
+                receivers->at(i)->wait();
+                sum += receivers->at(i)->sum();
+            }
+            FLUX_VERIFY(sum == int64_t(m * n) * (m * n - 1) / 2);
+            FLUX_VERIFY(channel->count() == 0);
+        }
+        {
+            typedef SpscChannel<int> IntChannel;
+            Ref<IntChannel> channel = IntChannel::create(16);
+            const int n = 200000;
+            Ref< Receiver<IntChannel> > receiver = Receiver<IntChannel>::start(channel, n, 13);
+            Ref< Sender<IntChannel> > sender = Sender<IntChannel>::start(channel, 0, n, 9);
+            sender->wait();
+            receiver->wait();
+            FLUX_VERIFY(receiver->ordered());
+            FLUX_VERIFY(receiver->sum() == int64_t(n) * (n - 1) / 2);
+        }
+        {
+            Ref< BoundedChannel<int> > channel = BoundedChannel<int>::create(2);
+            double t0 = System::now();
+            int x = 0;
+            FLUX_VERIFY(!channel->popBefore(t0 + 0.05, &x));
+            FLUX_VERIFY(System::now() - t0 >= 0.04);
+            FLUX_VERIFY(channel->tryPush(1) && channel->tryPush(2) && !channel->tryPush(3));
+            FLUX_VERIFY(channel->popBefore(t0 + 1, &x) && x == 1);
+        }
+    }
+};
+
+template<class ChannelType>
+double measureHandOver(ChannelType *channel, int n)
+{
+    double t0 = System::now();
+    Ref< Receiver<ChannelType> > receiver = Receiver<ChannelType>::start(channel, n, 1);
+    Ref< Sender<ChannelType> > sender = Sender<ChannelType>::start(channel, 0, n, 1);
+    sender->wait();
+    receiver->wait();
+    return (System::now() - t0) * 1e9 / n;
+}
+
+class QueueChannel: public Channel<int>
+{
+public:
+    static Ref<QueueChannel> create() { return new QueueChannel; }
+    void pushBatch(const int *items, int n) { for (int i = 0; i < n; ++i) push(items[i]); }
+    int popBatch(int *items, int) { *items = pop(); return 1; }
+};
+
+class HandOverCost: public TestCase
+{
+    void run()
+    {
+        const int n = 200000;
+        fout("Channel: %% ns/item\n") << int(measureHandOver<QueueChannel>(QueueChannel::create(), n));
+        fout("BoundedChannel: %% ns/item\n") << int(measureHandOver< BoundedChannel<int> >(BoundedChannel<int>::create(), n));
+        fout("SpscChannel: %% ns/item\n") << int(measureHandOver< SpscChannel<int> >(SpscChannel<int>::create(), n));
+    }
+};
+
+template<class ChannelType>
+class LocalProducer: public Thread
+{
+public:
+    static Ref<LocalProducer> start(ChannelType *channel, int n) {
+        Ref<LocalProducer> producer = new LocalProducer(channel, n);
+        producer->Thread::start();
+        return producer;
+    }
+
+private:
+    LocalProducer(ChannelType *channel, int n): channel_(channel), n_(n) {}
+
+    void run()
+    {
+        for (int i = 0; i < n_; ++i) {
+            String s = str(i);
+            s->setThreadLocal(true);
+            channel_->transfer(&s);
+        }
+    }
+
+    Ref<ChannelType> channel_;
+    int n_;
+};
+
+template<class ChannelType>
+bool receiveLocal(ChannelType *channel, int n)
+{
+    Ref< LocalProducer<ChannelType> > producer = LocalProducer<ChannelType>::start(channel, n);
+    bool ok = true;
+    for (int i = 0; i < n; ++i) {
+        String s = channel->pop();
+        ok = ok && !s->isThreadLocal() && s->refCount() == 1 && s->toNumber<int>() == i;
+    }
+    producer->wait();
+    return ok;
+}
+
+class ObjectTransfer: public TestCase
+{
+    void run()
+    {
+        FLUX_VERIFY(receiveLocal< Channel<String> >(Channel<String>::create(), 10000));
+        FLUX_VERIFY(receiveLocal< BoundedChannel<String> >(BoundedChannel<String>::create(16), 10000));
+    }
+};
+
 int main(int argc, char **argv)
 {
     FLUX_TESTSUITE_ADD(ConsumerProducer);
+    FLUX_TESTSUITE_ADD(BoundedChannels);
+    FLUX_TESTSUITE_ADD(HandOverCost);
+    FLUX_TESTSUITE_ADD(ObjectTransfer);
 
     return testSuite()->run(argc, argv);
 }
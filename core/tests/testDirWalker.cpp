@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <sys/stat.h> // chmod
+#include <unistd.h> // geteuid, seteuid
+#include <flux/testing/TestSuite>
+#include <flux/stdio>
+#include <flux/System>
+#include <flux/Process>
+#include <flux/File>
+#include <flux/Map>
+#include <flux/Dir>
+#include <flux/DirWalker>
+
+using namespace flux;
+using namespace flux::testing;
+
+class TreeTestCase: public TestCase
+{
+protected:
+    void createTree(String path, int depth)
+    {
+        Dir::create(path);
+        for (int i = 0; i < 16; ++i)
+            File::create(Format("%%/file%%") << path << i);
+        if (depth > 0) {
+            for (int i = 0; i < 4; ++i)
+                createTree(Format("%%/dir%%") << path << i, depth - 1);
+        }
+    }
+
+    void removeTree(String path)
+    {
+        Ref<DirWalker> walker = DirWalker::open(path);
+        walker->setDeleteOrder(true);
+        String entry;
+        bool isDir = false;
+        while (walker->read(&entry, &isDir)) {
+            if (isDir) Dir::unlink(entry);
+            else File::unlink(entry);
+        }
+        Dir::unlink(path);
+    }
+
+    Ref<StringList> walk(String path, bool parallel, bool ordered, bool deleteOrder, double *time)
+    {
+        Ref<StringList> list = StringList::create();
+        double t0 = System::now();
+        Ref<DirWalker> walker = DirWalker::open(path);
+        walker->setParallel(parallel);
+        walker->setOrdered(ordered);
+        walker->setDeleteOrder(deleteOrder);
+        String entry;
+        while (walker->read(&entry)) list->append(entry);
+        *time = System::now() - t0;
+        return list;
+    }
+
+    void run()
+    {
+        String path = Format("/tmp/%%_%%") << Process::execPath()->fileName() << Process::currentId();
+        createTree(path, 3);
+        try {
+            test(path);
+        }
+        catch (...) {
+            removeTree(path);
+            throw;
+        }
+        removeTree(path);
+    }
+
+    virtual void test(String path) = 0;
+};
+
+class OrderedWalk: public TreeTestCase
+{
+    void test(String path)
+    {
+        double ts = 0, tp = 0;
+        Ref<StringList> sequential = walk(path, false, true, false, &ts);
+        Ref<StringList> parallel = walk(path, true, true, false, &tp);
+        fout("%% entries: %% us sequential, %% us parallel\n")
+            << sequential->count() << int(ts * 1e6) << int(tp * 1e6);
+        FLUX_VERIFY(sequential->count() == 16 * 85 + 84);
+        FLUX_VERIFY(parallel->count() == sequential->count());
+        for (int i = 0; i < sequential->count(); ++i)
+            FLUX_VERIFY(parallel->at(i) == sequential->at(i));
+    }
+};
+
+class UnorderedWalk: public TreeTestCase
+{
+    void test(String path)
+    {
+        double ts = 0, tp = 0;
+        Ref<StringList> sequential = walk(path, false, true, false, &ts)->sort();
+        Ref<StringList> parallel = walk(path, true, false, false, &tp);
+        fout("%% entries: %% us sequential, %% us parallel, unordered\n")
+            << sequential->count() << int(ts * 1e6) << int(tp * 1e6);
+        parallel = parallel->sort();
+        FLUX_VERIFY(parallel->count() == sequential->count());
+        for (int i = 0; i < sequential->count(); ++i)
+            FLUX_VERIFY(parallel->at(i) == sequential->at(i));
+    }
+};
+
+class DeleteOrderWalk: public TreeTestCase
+{
+    void test(String path)
+    {
+        double ts = 0, tp = 0;
+        Ref<StringList> sequential = walk(path, false, true, true, &ts);
+        Ref<StringList> parallel = walk(path, true, true, true, &tp);
+        FLUX_VERIFY(parallel->count() == sequential->count());
+        for (int i = 0; i < sequential->count(); ++i)
+            FLUX_VERIFY(parallel->at(i) == sequential->at(i));
+        Ref< Map<String, int> > position = Map<String, int>::create();
+        for (int i = 0; i < parallel->count(); ++i)
+            position->insert(parallel->at(i), i);
+        for (int i = 0; i < parallel->count(); ++i) {
+            String parent = parallel->at(i)->reducePath();
+            if (parent == path) continue;
+            FLUX_VERIFY(position->value(parent) > i);
+        }
+    }
+};
+
+class UnreadableSubdir: public TreeTestCase
+{
+    void test(String path)
+    {
+        String locked = path + "/dir1/locked";
+        Dir::create(locked);
+        File::create(locked + "/hidden");
+        FLUX_VERIFY(::chmod(locked, 0) == 0);
+        uid_t euid = ::geteuid();
+        try {
+            if (euid == 0) FLUX_VERIFY(::seteuid(65534) == 0); // let permissions apply
+            verify(path, locked);
+        }
+        catch (...) {
+            if (euid == 0) ::seteuid(euid);
+            ::chmod(locked, 0755);
+            throw;
+        }
+        if (euid == 0) FLUX_VERIFY(::seteuid(euid) == 0);
+        FLUX_VERIFY(::chmod(locked, 0755) == 0); // allow removeTree() to clean up
+    }
+
+    void verify(String path, String locked)
+    {
+        double ts = 0, tp = 0, tu = 0;
+        Ref<StringList> sequential = walk(path, false, true, false, &ts);
+        Ref<StringList> parallel = walk(path, true, true, false, &tp);
+        Ref<StringList> unordered = walk(path, true, false, false, &tu)->sort();
+        FLUX_VERIFY(sequential->contains(locked));
+        FLUX_VERIFY(!sequential->contains(locked + "/hidden"));
+        FLUX_VERIFY(parallel->count() == sequential->count());
+        for (int i = 0; i < sequential->count(); ++i)
+            FLUX_VERIFY(parallel->at(i) == sequential->at(i));
+        sequential = sequential->sort();
+        FLUX_VERIFY(unordered->count() == sequential->count());
+        for (int i = 0; i < sequential->count(); ++i)
+            FLUX_VERIFY(unordered->at(i) == sequential->at(i));
+    }
+};
+
+int main(int argc, char **argv)
+{
+    FLUX_TESTSUITE_ADD(OrderedWalk);
+    FLUX_TESTSUITE_ADD(UnorderedWalk);
+    FLUX_TESTSUITE_ADD(DeleteOrderWalk);
+    FLUX_TESTSUITE_ADD(UnreadableSubdir);
+
+    return testSuite()->run(argc, argv);
+}
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/testing/TestSuite>
+#include <flux/stdio>
+#include <flux/System>
+#include <flux/exceptions>
+#include <flux/parallel>
+
+using namespace flux;
+using namespace flux::testing;
+
+class Squares {
+public:
+    Squares(int64_t *a): a_(a) {}
+    void operator()(int i0, int i1) const {
+        for (int i = i0; i < i1; ++i) a_[i] = int64_t(i) * i;
+    }
+private:
+    int64_t *a_;
+};
+
+class RangeSum {
+public:
+    RangeSum(const int64_t *a): a_(a) {}
+    int64_t operator()(int i0, int i1) const {
+        int64_t s = 0;
+        for (int i = i0; i < i1; ++i) s += a_[i];
+        return s;
+    }
+private:
+    const int64_t *a_;
+};
+
+int64_t add(int64_t a, int64_t b) { return a + b; }
+
+class ParallelLoops: public TestCase
+{
+    void run() {
+        const int n = 1000000;
+        int64_t *a = new int64_t[n];
+        parallelFor(0, n, Squares(a), 1000);
+        int64_t expected = 0;
+        for (int i = 0; i < n; ++i) expected += int64_t(i) * i;
+        FLUX_VERIFY(parallelReduce(0, n, int64_t(0), RangeSum(a), add, 1000) == expected);
+        FLUX_VERIFY(parallelReduce(0, 0, int64_t(7), RangeSum(a), add) == 7);
+        delete[] a;
+    }
+};
+
+class Rows {
+public:
+    Rows(int *m, int width): m_(m), width_(width) {}
+    void operator()(int i0, int i1) const {
+        for (int i = i0; i < i1; ++i)
+            parallelFor(0, width_, Cells(m_ + i * width_, i), 16);
+    }
+private:
+    class Cells {
+    public:
+        Cells(int *row, int i): row_(row), i_(i) {}
+        void operator()(int j0, int j1) const {
+            for (int j = j0; j < j1; ++j) row_[j] = i_ + j;
+        }
+    private:
+        int *row_;
+        int i_;
+    };
+    int *m_;
+    int width_;
+};
+
+class NestedLoops: public TestCase
+{
+    void run() {
+        const int h = 200, w = 300;
+        int *m = new int[h * w];
+        Ref<Executor> executor = Executor::create(4);
+        parallelFor(0, h, Rows(m, w), 1, executor);
+        bool ok = true;
+        for (int i = 0; i < h; ++i)
+            for (int j = 0; j < w; ++j)
+                ok = ok && (m[i * w + j] == i + j);
+        FLUX_VERIFY(ok);
+        delete[] m;
+    }
+};
+
+class CountTask: public Task
+{
+public:
+    CountTask(volatile int *counter, bool fail = false): counter_(counter), fail_(fail) {}
+    void run() {
+        if (fail_) FLUX_DEBUG_ERROR("Task failed");
+        __sync_add_and_fetch(counter_, 1);
+    }
+private:
+    volatile int *counter_;
+    bool fail_;
+};
+
+class Cancellation: public TestCase
+{
+    void run() {
+        volatile int counter = 0;
+        {
+            Ref<TaskGroup> group = TaskGroup::create();
+            group->cancel();
+            for (int i = 0; i < 100; ++i) group->run(new CountTask(&counter));
+            group->wait();
+            FLUX_VERIFY(group->isCanceled());
+        }
+        FLUX_VERIFY(counter == 0);
+
+        Ref<Executor> executor = Executor::create(1);
+        Ref<TaskGroup> group = TaskGroup::create(executor);
+        group->run(new CountTask(&counter, true));
+        String error;
+        try { group->wait(); }
+        catch (TaskError &ex) { error = ex.message(); }
+        fout("error: %%\n") << error;
+        FLUX_VERIFY(error->contains("Task failed"));
+        FLUX_VERIFY(group->isCanceled() && group->hasFailed());
+        for (int i = 0; i < 10; ++i) group->run(new CountTask(&counter));
+        bool failed = false;
+        try { group->wait(); }
+        catch (TaskError &) { failed = true; }
+        FLUX_VERIFY(failed);
+        FLUX_VERIFY(counter == 0);
+
+        Ref<TaskGroup> group2 = TaskGroup::create(executor);
+        for (int i = 0; i < 1000; ++i) group2->run(new CountTask(&counter));
+        group2->wait();
+        FLUX_VERIFY(counter == 1000);
+    }
+};
+
+class SkipTask: public Task
+{
+public:
+    SkipTask(volatile int *ran, volatile int *skipped, bool fail = false):
+        ran_(ran), skipped_(skipped), fail_(fail)
+    {}
+    void run() {
+        if (fail_) throw UsageError("Bad input");
+        __sync_add_and_fetch(ran_, 1);
+    }
+    void skip() { __sync_add_and_fetch(skipped_, 1); }
+private:
+    volatile int *ran_;
+    volatile int *skipped_;
+    bool fail_;
+};
+
+class FailedLoop {
+public:
+    void operator()(int i0, int i1) const {
+        if (i0 <= 500 && 500 < i1) FLUX_DEBUG_ERROR("Index 500 failed");
+    }
+};
+
+class FailedSum {
+public:
+    int64_t operator()(int i0, int i1) const {
+        FailedLoop()(i0, i1);
+        return i1 - i0;
+    }
+};
+
+class TaskFailure: public TestCase
+{
+    void run() {
+        volatile int ran = 0, skipped = 0;
+        Ref<Executor> executor = Executor::create(1);
+        Ref<TaskGroup> group = TaskGroup::create(executor);
+        group->run(new SkipTask(&ran, &skipped, true));
+        for (int i = 0; i < 100; ++i) group->run(new SkipTask(&ran, &skipped));
+        String error;
+        try { group->wait(); }
+        catch (TaskError &ex) { error = ex.message(); }
+        fout("ran: %%, skipped: %%, error: %%\n") << ran << skipped << error;
+        FLUX_VERIFY(error == "Bad input");
+        FLUX_VERIFY(ran + skipped == 100);
+
+        bool failed = false;
+        try { parallelFor(0, 1000, FailedLoop(), 10); }
+        catch (TaskError &ex) { failed = ex.message()->contains("Index 500 failed"); }
+        FLUX_VERIFY(failed);
+
+        failed = false;
+        try { parallelReduce(0, 1000, int64_t(0), FailedSum(), add, 10); }
+        catch (TaskError &ex) { failed = ex.message()->contains("Index 500 failed"); }
+        FLUX_VERIFY(failed);
+    }
+};
+
+class Spawn: public Task
+{
+public:
+    Spawn(TaskGroup *group, volatile int *counter, int depth):
+        group_(group), counter_(counter), depth_(depth)
+    {}
+    void run() {
+        __sync_add_and_fetch(counter_, 1);
+        if (depth_ > 0) {
+            group_->run(new Spawn(group_, counter_, depth_ - 1));
+            group_->run(new Spawn(group_, counter_, depth_ - 1));
+        }
+    }
+private:
+    TaskGroup *group_;
+    volatile int *counter_;
+    int depth_;
+};
+
+class SpawnCost: public TestCase
+{
+    void run() {
+        const int depth = 17;
+        volatile int counter = 0;
+        Ref<TaskGroup> group = TaskGroup::create();
+        double t0 = System::now();
+        group->run(new Spawn(group, &counter, depth));
+        group->wait();
+        double t1 = System::now();
+        FLUX_VERIFY(counter == (1 << (depth + 1)) - 1);
+        fout("%% tasks on %% workers: %% ns/task\n")
+            << counter << group->executor()->concurrency() << int((t1 - t0) * 1e9 / counter);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    FLUX_TESTSUITE_ADD(ParallelLoops);
+    FLUX_TESTSUITE_ADD(NestedLoops);
+    FLUX_TESTSUITE_ADD(Cancellation);
+    FLUX_TESTSUITE_ADD(TaskFailure);
+    FLUX_TESTSUITE_ADD(SpawnCost);
+
+    return testSuite()->run(argc, argv);
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/testing/TestSuite>
+#include <flux/stdio>
+#include <flux/Crc32>
+#include <flux/Hash64>
+
+using namespace flux;
+using namespace flux::testing;
+
+class CheckValues: public TestCase
+{
+    void run()
+    {
+        fout("crc32(\"123456789\") = 0x%%\n") << hex(~crc32("123456789"), 8);
+        fout("crc32c(\"123456789\") = 0x%%\n") << hex(~crc32c("123456789"), 8);
+        FLUX_VERIFY(~crc32("123456789") == 0xCBF43926);
+        FLUX_VERIFY(~crc32c("123456789") == 0xE3069283);
+        FLUX_VERIFY(crc32("") == ~uint32_t(0));
+    }
+};
+
+class Hash64Values: public TestCase
+{
+    void run()
+    {
+        FLUX_VERIFY(hash64("") == 0xEF46DB3751D8E999ULL);
+        FLUX_VERIFY(hash64("a") == 0xD24EC4F1A98C6E5BULL);
+        FLUX_VERIFY(hash64("abc") == 0x44BC2CF5AD770999ULL);
+        FLUX_VERIFY(hash64("123456789") == 0x8CB841DB40E6AE83ULL);
+        FLUX_VERIFY(hash64("abc", 3, 1) == 0xBEA9CA8199328908ULL);
+
+        String s(768);
+        for (int i = 0; i < s->count(); ++i) s->byteAt(i) = i & 0xFF;
+        fout("hash64(0..255 x 3) = 0x%%\n") << hex(hash64(s), 16);
+        FLUX_VERIFY(hash64(s) == 0x8E03C838C596036FULL);
+        FLUX_VERIFY(hash64(s->bytes(), s->count(), 1) == 0xA80257374B99ADE3ULL);
+    }
+};
+
+class Chunking: public TestCase
+{
+    void run()
+    {
+        String s(1000);
+        for (int i = 0; i < s->count(); ++i) s->byteAt(i) = (i * 7 + 3) & 0xFF;
+        uint32_t crc = crc32(s);
+        uint32_t crcc = crc32c(s);
+        uint64_t h = hash64(s);
+        for (int chunkSize = 1; chunkSize < 70; ++chunkSize) {
+            Crc32 crcStream;
+            Crc32c crccStream;
+            Hash64 hashStream;
+            for (int i = 1; i < s->count(); i += chunkSize) {
+                int n = s->count() - i < chunkSize ? s->count() - i : chunkSize;
+                if (i == 1) {
+                    crcStream.feed(s->bytes(), 1);
+                    crccStream.feed(s->bytes(), 1);
+                    hashStream.feed(s->bytes(), 1);
+                }
+                crcStream.feed(s->bytes() + i, n);
+                crccStream.feed(s->bytes() + i, n);
+                hashStream.feed(s->bytes() + i, n);
+            }
+            FLUX_VERIFY(crcStream.sum() == crc);
+            FLUX_VERIFY(crccStream.sum() == crcc);
+            FLUX_VERIFY(hashStream.sum() == h);
+        }
+    }
+};
+
+int main(int argc, char **argv)
+{
+    FLUX_TESTSUITE_ADD(CheckValues);
+    FLUX_TESTSUITE_ADD(Hash64Values);
+    FLUX_TESTSUITE_ADD(Chunking);
+
+    return testSuite()->run(argc, argv);
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <unistd.h> // pipe
+#include <errno.h>
+#include <flux/testing/TestSuite>
+#include <flux/stdio>
+#include <flux/System>
+#include <flux/File>
+#include <flux/IoRing>
+
+using namespace flux;
+using namespace flux::testing;
+
+class ReadWrite: public TestCase
+{
+    void run()
+    {
+        Ref<IoRing> ring = IoRing::tryCreate();
+        if (!ring) {
+            fout("io_uring not available\n");
+            return;
+        }
+        Ref<File> file = File::temp();
+        FileUnlinkGuard guard(file->path());
+
+        Ref<IoBufferList> parts = IoBufferList::create();
+        for (int i = 0; i < 8; ++i) parts->append(str(i));
+        ring->registerBuffers(parts);
+        for (int i = 0; i < parts->count(); ++i)
+            ring->write(file, parts->at(i), i);
+        Ref<IoCompletion> completion = ring->wait(-1, parts->count());
+        FLUX_VERIFY(completion->count() == parts->count());
+        for (int i = 0; i < completion->count(); ++i)
+            FLUX_VERIFY(completion->at(i)->result() == 1);
+        ring->registerBuffers(0);
+
+        Ref<ByteArray> buffer = ByteArray::create(16);
+        Ref<IoRequest> request = ring->read(file, buffer, 0);
+        ring->wait();
+        fout("read %% bytes: \"%%\"\n") << request->result() << buffer->copy(0, request->result());
+        FLUX_VERIFY(request->done());
+        FLUX_VERIFY(buffer->copy(0, request->result()) == "01234567");
+    }
+};
+
+class OpenStatus: public TestCase
+{
+    void run()
+    {
+        Ref<IoRing> ring = IoRing::tryCreate();
+        if (!ring) return;
+        String path = testSuite()->execPath();
+        Ref<IoRequest> opened = ring->open(path);
+        Ref<IoRequest> status = ring->status(path);
+        Ref<IoRequest> missing = ring->status(path + ".missing");
+        ring->wait(-1, 3);
+        opened->check();
+        FLUX_VERIFY(opened->stream());
+        FLUX_VERIFY(status->status()->exists());
+        FLUX_VERIFY(status->status()->size() == File::status(path)->size());
+        FLUX_VERIFY(status->status()->inodeNumber() == File::status(path)->inodeNumber());
+        FLUX_VERIFY(!missing->status()->exists());
+        FLUX_VERIFY(missing->error() == ENOENT);
+    }
+};
+
+class SendFile: public TestCase
+{
+    void run()
+    {
+        Ref<IoRing> ring = IoRing::tryCreate();
+        if (!ring) return;
+        String path = testSuite()->execPath();
+        String text = File::load(path);
+        Ref<File> source = File::open(path);
+        Ref<File> sink = File::temp();
+        FileUnlinkGuard guard(sink->path());
+        off_t offset = 0;
+        while (offset < text->count()) {
+            Ref<IoRequest> request = ring->sendFile(sink, source, offset, text->count() - offset);
+            ring->wait();
+            request->check();
+            FLUX_VERIFY(request->result() > 0);
+            offset += request->result();
+        }
+        FLUX_VERIFY(File::load(sink->path()) == text);
+    }
+};
+
+class LinkedTimeout: public TestCase
+{
+    void run()
+    {
+        Ref<IoRing> ring = IoRing::tryCreate();
+        if (!ring) return;
+        int fd[2];
+        FLUX_VERIFY(::pipe(fd) == 0);
+        Ref<SystemStream> input = SystemStream::create(fd[0]);
+        Ref<SystemStream> output = SystemStream::create(fd[1]);
+        double t0 = System::now();
+        Ref<IoRequest> request = ring->read(input, ByteArray::create(16));
+        Ref<IoRequest> timeout = ring->linkTimeout(0.05);
+        ring->wait(-1, 2);
+        double dt = System::now() - t0;
+        fout("read: %%, timeout: %%, %% ms\n") << request->result() << timeout->result() << int(dt * 1000);
+        FLUX_VERIFY(request->error() == ECANCELED || request->error() == EINTR);
+        FLUX_VERIFY(dt >= 0.04);
+        Ref<IoCompletion> completion = ring->wait(0.01);
+        FLUX_VERIFY(completion->count() == 0);
+    }
+};
+
+class PendingOnDestruction: public TestCase
+{
+    void run()
+    {
+        Ref<IoRing> ring = IoRing::tryCreate();
+        if (!ring) return;
+        int fd[2];
+        FLUX_VERIFY(::pipe(fd) == 0);
+        Ref<SystemStream> input = SystemStream::create(fd[0]);
+        Ref<SystemStream> output = SystemStream::create(fd[1]);
+        Ref<IoRequest> request = ring->read(input, ByteArray::create(16));
+        ring->submit();
+        double t0 = System::now();
+        ring = 0;
+        double dt = System::now() - t0;
+        fout("read: %%, %% ms\n") << request->result() << int(dt * 1000);
+        FLUX_VERIFY(request->done());
+        FLUX_VERIFY(request->error() == ECANCELED || request->error() == EINTR);
+        FLUX_VERIFY(dt < 1);
+    }
+};
+
+class SmallRing: public TestCase
+{
+    void run()
+    {
+        const int n = 64;
+        Ref<IoRing> ring = IoRing::tryCreate(4);
+        if (!ring) return;
+        Ref<File> file = File::temp();
+        FileUnlinkGuard guard(file->path());
+        Ref<IoBufferList> parts = IoBufferList::create();
+        for (int i = 0; i < n; ++i) {
+            parts->append(str(i % 10));
+            ring->write(file, parts->at(i), i);
+        }
+        int completed = 0;
+        while (ring->pending() > 0) {
+            Ref<IoCompletion> completion = ring->wait();
+            for (int i = 0; i < completion->count(); ++i)
+                FLUX_VERIFY(completion->at(i)->result() == 1);
+            completed += completion->count();
+        }
+        fout("%% requests through %% entries\n") << completed << ring->entries();
+        FLUX_VERIFY(completed == n);
+        String text = File::load(file->path());
+        FLUX_VERIFY(text->count() == n);
+        for (int i = 0; i < n; ++i)
+            FLUX_VERIFY(text->at(i) == '0' + i % 10);
+    }
+};
+
+class SharedRing: public TestCase
+{
+    void run()
+    {
+        const int n = 1000;
+        Ref<IoRing> ring = IoRing::tryCreate();
+        Ref<File> file[2];
+        Ref<Stream> stream[2];
+        for (int k = 0; k < 2; ++k) {
+            file[k] = File::temp(File::WriteOnly);
+            stream[k] = RingStream::create(file[k], ring, 0x100);
+        }
+        String line = "0123456789abcdef\n";
+        for (int i = 0; i < n; ++i)
+            stream[i % 2]->write(line);
+        for (int k = 0; k < 2; ++k) {
+            stream[k] = 0;
+            String text = File::load(file[k]->path());
+            File::unlink(file[k]->path());
+            FLUX_VERIFY(text->count() == n / 2 * line->count());
+        }
+    }
+};
+
+class BatchedWrites: public TestCase
+{
+    void run()
+    {
+        const int n = 10000;
+        Ref<File> file = File::temp(File::WriteOnly);
+        FileUnlinkGuard guard(file->path());
+        Ref<IoRing> ring = IoRing::tryCreate(4);
+        Ref<Stream> stream = RingStream::create(file, ring);
+        String line = "0123456789abcdef\n";
+
+        double t0 = System::now();
+        for (int i = 0; i < n; ++i) stream->write(line);
+        stream = 0;
+        double t1 = System::now();
+        for (int i = 0; i < n; ++i) file->write(line);
+        double t2 = System::now();
+
+        fout("%% writes: %% ns/write batched, %% ns/write direct\n")
+            << n << int((t1 - t0) * 1e9 / n) << int((t2 - t1) * 1e9 / n);
+        String text = File::load(file->path());
+        FLUX_VERIFY(text->count() == 2 * n * line->count());
+        for (int i = 0; i < text->count(); i += line->count())
+            FLUX_VERIFY(text->copy(i, i + line->count()) == line);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    FLUX_TESTSUITE_ADD(ReadWrite);
+    FLUX_TESTSUITE_ADD(OpenStatus);
+    FLUX_TESTSUITE_ADD(SendFile);
+    FLUX_TESTSUITE_ADD(LinkedTimeout);
+    FLUX_TESTSUITE_ADD(PendingOnDestruction);
+    FLUX_TESTSUITE_ADD(SmallRing);
+    FLUX_TESTSUITE_ADD(SharedRing);
+    FLUX_TESTSUITE_ADD(BatchedWrites);
+
+    return testSuite()->run(argc, argv);
+}
@@ -9,6 +9,7 @@
 #include <flux/testing/TestSuite>
 #include <flux/stdio>
 #include <flux/Random>
+#include <flux/System>
 #include <flux/List>
 
 using namespace flux;
@@ -98,6 +99,50 @@ class Preallocation: public TestCase
     }
 };
 
+double measureCopying(int n, int rounds, bool local)
+{
+    Ref<StringList> list = StringList::create();
+    for (int i = 0; i < n; ++i) {
+        String s = str(i);
+        s->setThreadLocal(local);
+        list->append(s);
+    }
+    double t0 = System::now();
+    int total = 0;
+    for (int j = 0; j < rounds; ++j) {
+        for (int i = 0; i < n; ++i) {
+            String s = list->at(i);
+            total += s->count();
+        }
+        Ref<StringList> copy = StringList::clone(list);
+        total += copy->count();
+    }
+    double t1 = System::now();
+    FLUX_VERIFY(total > 0);
+    return (t1 - t0) * 1e9 / (2 * n * rounds);
+}
+
+class LocalRefCounting: public TestCase
+{
+    void run() {
+        const int n = 1000, rounds = 200;
+        double ts = measureCopying(n, rounds, false);
+        double tl = measureCopying(n, rounds, true);
+        FLUX_VERIFY(!String("shared")->isThreadLocal());
+        fout("String copy: %% ns (shared), %% ns (thread-local)\n") << int(ts) << int(tl);
+
+        Ref<StringList> list = StringList::create();
+        list->append("a");
+        String a = list->at(0);
+        FLUX_VERIFY(a->refCount() == 2);
+        String b;
+        b.move(a);
+        FLUX_VERIFY(!a.get() && b->refCount() == 2);
+        list->popFront();
+        FLUX_VERIFY(b->refCount() == 1);
+    }
+};
+
 int main(int argc, char **argv)
 {
     FLUX_TESTSUITE_ADD(InsertionIteration);
@@ -105,6 +150,7 @@ int main(int argc, char **argv)
     FLUX_TESTSUITE_ADD(Sorting);
     FLUX_TESTSUITE_ADD(Cloning);
     FLUX_TESTSUITE_ADD(Preallocation);
+    FLUX_TESTSUITE_ADD(LocalRefCounting);
 
     return testSuite()->run(argc, argv);
 }
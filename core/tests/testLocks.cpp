@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include <flux/testing/TestSuite>
+#include <flux/stdio>
+#include <flux/Thread>
+#include <flux/System>
+#include <flux/Guard>
+#include <flux/FutexMutex>
+#include <flux/TicketLock>
+#include <flux/ReadWriteLock>
+#include <flux/WaitCondition>
+
+using namespace flux;
+using namespace flux::testing;
+
+template<class Lock>
+class Incrementer: public Thread
+{
+public:
+    Incrementer(Lock *lock, int *counter, int n): lock_(lock), counter_(counter), n_(n) {}
+
+private:
+    void run() {
+        for (int i = 0; i < n_; ++i) {
+            Guard<Lock> guard(lock_);
+            ++*counter_;
+        }
+    }
+
+    Lock *lock_;
+    int *counter_;
+    int n_;
+};
+
+template<class Lock>
+int countConcurrently(Lock *lock, int threadCount, int n)
+{
+    int counter = 0;
+    Ref<Thread> *threads = new Ref<Thread>[threadCount];
+    for (int i = 0; i < threadCount; ++i) {
+        threads[i] = new Incrementer<Lock>(lock, &counter, n);
+        threads[i]->start(1 << 16);
+    }
+    for (int i = 0; i < threadCount; ++i) threads[i]->wait();
+    delete[] threads;
+    return counter;
+}
+
+class MutualExclusion: public TestCase
+{
+    void run() {
+        LockStats stats("MutualExclusion");
+        FutexMutex mutex(&stats);
+        FLUX_VERIFY(countConcurrently(&mutex, 4, 100000) == 400000);
+        FLUX_VERIFY(stats.acquisitions() == 400000);
+        fout("FutexMutex: %% contentions, %% s waiting\n") << stats.contentions() << stats.waitTime();
+
+        bool found = false;
+        for (LockStats *s = LockStats::first(); s; s = s->next())
+            found = found || (s == &stats && strcmp(s->name(), "MutualExclusion") == 0);
+        FLUX_VERIFY(found);
+
+        TicketLock ticketLock;
+        FLUX_VERIFY(countConcurrently(&ticketLock, 4, 100000) == 400000);
+
+        FLUX_VERIFY(mutex.tryAcquire());
+        FLUX_VERIFY(!mutex.tryAcquire());
+        mutex.release();
+        FLUX_VERIFY(ticketLock.tryAcquire());
+        FLUX_VERIFY(!ticketLock.tryAcquire());
+        ticketLock.release();
+    }
+};
+
+class Shared {
+public:
+    Shared(): a_(0), b_(0) {}
+    ReadWriteLock lock_;
+    volatile int a_, b_;
+};
+
+class SharedReader: public Thread
+{
+public:
+    SharedReader(Shared *shared, volatile bool *done): torn_(0), reads_(0), shared_(shared), done_(done) {}
+    int torn_, reads_;
+private:
+    void run() {
+        while (!*done_) {
+            ReadGuard guard(&shared_->lock_);
+            if (shared_->a_ != shared_->b_) ++torn_;
+            ++reads_;
+        }
+    }
+    Shared *shared_;
+    volatile bool *done_;
+};
+
+class SharedWriter: public Thread
+{
+public:
+    SharedWriter(Shared *shared, int n): shared_(shared), n_(n) {}
+private:
+    void run() {
+        for (int i = 0; i < n_; ++i) {
+            WriteGuard guard(&shared_->lock_);
+            ++shared_->a_;
+            sched_yield();
+            ++shared_->b_;
+        }
+    }
+    Shared *shared_;
+    int n_;
+};
+
+class ReadersAndWriters: public TestCase
+{
+    void run() {
+        Shared shared;
+        volatile bool done = false;
+        Ref<SharedReader> readers[3];
+        for (int i = 0; i < 3; ++i) {
+            readers[i] = new SharedReader(&shared, &done);
+            readers[i]->start(1 << 16);
+        }
+        Ref<SharedWriter> writers[2];
+        for (int i = 0; i < 2; ++i) {
+            writers[i] = new SharedWriter(&shared, 2000);
+            writers[i]->start(1 << 16);
+        }
+        for (int i = 0; i < 2; ++i) writers[i]->wait();
+        done = true;
+        int torn = 0, reads = 0;
+        for (int i = 0; i < 3; ++i) {
+            readers[i]->wait();
+            torn += readers[i]->torn_;
+            reads += readers[i]->reads_;
+        }
+        fout("%% reads, %% writes\n") << reads << int(shared.a_);
+        FLUX_VERIFY(torn == 0);
+        FLUX_VERIFY(shared.a_ == 4000 && shared.b_ == 4000);
+    }
+};
+
+class QueuedWriter: public Thread
+{
+public:
+    QueuedWriter(ReadWriteLock *lock, volatile int *done): lock_(lock), done_(done) {}
+private:
+    void run() {
+        WriteGuard guard(lock_);
+        *done_ = 1;
+    }
+    ReadWriteLock *lock_;
+    volatile int *done_;
+};
+
+class QueuedReader: public Thread
+{
+public:
+    QueuedReader(ReadWriteLock *lock, volatile int *writerDone):
+        cpuTime_(0), writerFirst_(false), lock_(lock), writerDone_(writerDone)
+    {}
+    double cpuTime_;
+    bool writerFirst_;
+private:
+    void run() {
+        struct timespec t0, t1;
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+        lock_->acquireRead();
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t1);
+        writerFirst_ = *writerDone_;
+        lock_->releaseRead();
+        cpuTime_ = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    }
+    ReadWriteLock *lock_;
+    volatile int *writerDone_;
+};
+
+class QueuedReaders: public TestCase
+{
+    void run() {
+        ReadWriteLock lock;
+        volatile int writerDone = 0;
+        lock.acquireRead();
+        Ref<QueuedWriter> writer = new QueuedWriter(&lock, &writerDone);
+        writer->start(1 << 16);
+        Thread::sleep(0.02);
+        const int n = 4;
+        Ref<QueuedReader> readers[n];
+        for (int i = 0; i < n; ++i) {
+            readers[i] = new QueuedReader(&lock, &writerDone);
+            readers[i]->start(1 << 16);
+        }
+        Thread::sleep(0.1);
+        lock.releaseRead();
+        writer->wait();
+        double cpuTime = 0;
+        bool writerFirst = true;
+        for (int i = 0; i < n; ++i) {
+            readers[i]->wait();
+            cpuTime += readers[i]->cpuTime_;
+            writerFirst = writerFirst && readers[i]->writerFirst_;
+        }
+        fout("%% readers queued behind a writer for 100 ms: %% us of CPU time\n") << n << int(cpuTime * 1e6);
+        FLUX_VERIFY(writerFirst);
+        FLUX_VERIFY(cpuTime < 0.02);
+    }
+};
+
+class Sleeper: public Thread
+{
+public:
+    Sleeper(Mutex *mutex, WaitCondition *condition, volatile int *go, volatile int *awake):
+        mutex_(mutex), condition_(condition), go_(go), awake_(awake)
+    {}
+private:
+    void run() {
+        Guard<Mutex> guard(mutex_);
+        while (!*go_) condition_->wait(mutex_);
+        ++*awake_;
+    }
+    Mutex *mutex_;
+    WaitCondition *condition_;
+    volatile int *go_;
+    volatile int *awake_;
+};
+
+class Conditions: public TestCase
+{
+    void run() {
+        Ref<Mutex> mutex = Mutex::create();
+        Ref<WaitCondition> condition = WaitCondition::create();
+        volatile int go = 0, awake = 0;
+        const int n = 8;
+        Ref<Sleeper> sleepers[n];
+        for (int i = 0; i < n; ++i) {
+            sleepers[i] = new Sleeper(mutex, condition, &go, &awake);
+            sleepers[i]->start(1 << 16);
+        }
+        Thread::sleep(0.05);
+        {
+            Guard<Mutex> guard(mutex);
+            go = 1;
+            condition->broadcast();
+        }
+        for (int i = 0; i < n; ++i) sleepers[i]->wait();
+        FLUX_VERIFY(awake == n);
+
+        double t0 = System::now();
+        mutex->acquire();
+        FLUX_VERIFY(!condition->waitUntil(t0 + 0.02, mutex));
+        mutex->release();
+        FLUX_VERIFY(System::now() - t0 >= 0.02 - 0.001);
+    }
+};
+
+class UncontendedCost: public TestCase
+{
+    void run() {
+        const int n = 10000000;
+        FutexMutex mutex;
+        pthread_mutex_t pmutex;
+        pthread_mutex_init(&pmutex, 0);
+        double t0 = System::now();
+        for (int i = 0; i < n; ++i) { mutex.acquire(); mutex.release(); }
+        double t1 = System::now();
+        for (int i = 0; i < n; ++i) { pthread_mutex_lock(&pmutex); pthread_mutex_unlock(&pmutex); }
+        double t2 = System::now();
+        pthread_mutex_destroy(&pmutex);
+        fout("FutexMutex: %% ns, pthread_mutex_t: %% ns\n")
+            << int((t1 - t0) * 1e9 / n) << int((t2 - t1) * 1e9 / n);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    FLUX_TESTSUITE_ADD(MutualExclusion);
+    FLUX_TESTSUITE_ADD(ReadersAndWriters);
+    FLUX_TESTSUITE_ADD(QueuedReaders);
+    FLUX_TESTSUITE_ADD(Conditions);
+    FLUX_TESTSUITE_ADD(UncontendedCost);
+
+    return testSuite()->run(argc, argv);
+}
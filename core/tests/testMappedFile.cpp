@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/testing/TestSuite>
+#include <flux/stdio>
+#include <flux/System>
+#include <flux/File>
+#include <flux/MappedFile>
+
+using namespace flux;
+using namespace flux::testing;
+
+class MappedFileTestCase: public TestCase
+{
+protected:
+    void run()
+    {
+        Ref<File> file = File::temp();
+        FileUnlinkGuard guard(file->path());
+        String text = String(5 * windowSize_ / 2);
+        for (int i = 0; i < text->count(); ++i)
+            text->at(i) = 'a' + i % 23;
+        file->write(text);
+        test(file, text);
+    }
+
+    virtual void test(File *file, String text) = 0;
+
+    static const int windowSize_ = 0x40000;
+};
+
+class MapRange: public MappedFileTestCase
+{
+    void test(File *file, String text)
+    {
+        Ref<MappedFile> mapped = MappedFile::open(file, MappedFile::Random);
+        FLUX_VERIFY(mapped->size() == text->count());
+        Ref<ByteArray> range = mapped->map(1234, 100000);
+        FLUX_VERIFY(range->count() == 100000);
+        FLUX_VERIFY(String(range->copy()) == text->copy(1234, 1234 + 100000));
+        range = mapped->map(text->count() - 10, 100);
+        FLUX_VERIFY(String(range->copy()) == text->copy(text->count() - 10, text->count()));
+        FLUX_VERIFY(mapped->map(text->count(), 1)->count() == 0);
+    }
+};
+
+class ReadWindows: public MappedFileTestCase
+{
+    void test(File *file, String text)
+    {
+        int options[] = { 0, MappedFile::Populate, MappedFile::DropBehind, MappedFile::HugePages };
+        for (int k = 0; k < int(sizeof(options) / sizeof(options[0])); ++k) {
+            Ref<MappedFile> mapped = MappedFile::open(file, MappedFile::Sequential, options[k], windowSize_);
+            Ref<StringList> windows = StringList::create();
+            for (String window; mapped->read(&window);) {
+                if (!(options[k] & MappedFile::HugePages))
+                    FLUX_VERIFY(window->count() <= windowSize_);
+                windows->append(window->copy());
+            }
+            fout("options %%: %% windows\n") << options[k] << windows->count();
+            FLUX_VERIFY(windows->join() == text);
+            FLUX_VERIFY(mapped->offset() == mapped->size());
+        }
+    }
+};
+
+int main(int argc, char **argv)
+{
+    FLUX_TESTSUITE_ADD(MapRange);
+    FLUX_TESTSUITE_ADD(ReadWindows);
+
+    return testSuite()->run(argc, argv);
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <flux/testing/TestSuite>
+#include <flux/stdio>
+#include <flux/System>
+#include <flux/Random>
+#include <flux/numbers>
+
+using namespace flux;
+using namespace flux::testing;
+
+String format64(float64_t x) { char buf[NumberBufferSize]; return String(buf, formatFloat64(buf, x)); }
+
+class IntegerFormatting: public TestCase
+{
+    void run() {
+        FLUX_VERIFY(str(0) == "0");
+        FLUX_VERIFY(str(7) == "7");
+        FLUX_VERIFY(str(-42) == "-42");
+        FLUX_VERIFY(str(int64_t(-9223372036854775807LL - 1)) == "-9223372036854775808");
+        FLUX_VERIFY(str(uint64_t(18446744073709551615ULL)) == "18446744073709551615");
+        FLUX_VERIFY(dec(5, 3) == "005");
+        FLUX_VERIFY(hex(255) == "ff");
+    }
+};
+
+class FloatFormatting: public TestCase
+{
+    void run() {
+        FLUX_VERIFY(str(0.1) == "0.1");
+        FLUX_VERIFY(str(1.5) == "1.5");
+        FLUX_VERIFY(str(-100.) == "-100");
+        FLUX_VERIFY(str(1234567.) == "1234567");
+        FLUX_VERIFY(str(12345678.) == "1.2345678e7");
+        FLUX_VERIFY(str(0.000001) == "0.000001");
+        FLUX_VERIFY(str(1e-7) == "1e-7");
+        FLUX_VERIFY(str(5e-324) == "5e-324");
+        FLUX_VERIFY(str(1.7976931348623157e308) == "1.7976931348623157e308");
+        FLUX_VERIFY(str(0.1f) == "0.1");
+        FLUX_VERIFY(str(16777216.f) == "1.6777216e7");
+        FLUX_VERIFY(str(flux::inf) == "inf");
+        FLUX_VERIFY(str(flux::nan) == "nan");
+
+        Ref<Random> random = Random::open(0);
+        for (int i = 0; i < 100000; ++i) {
+            uint64_t bits = (uint64_t(random->get()) << 33) ^ (uint64_t(random->get()) << 11) ^ random->get();
+            float64_t x = union_cast<float64_t>(bits);
+            if (x != x || x - x != 0) continue;
+            String s = format64(x);
+            float64_t y = strtod(s->chars(), 0);
+            if (union_cast<uint64_t>(x) != union_cast<uint64_t>(y) && x != 0) {
+                fout("%% => %%\n") << bits << s;
+                FLUX_VERIFY(false);
+                break;
+            }
+        }
+    }
+};
+
+class FloatParsing: public TestCase
+{
+    void run() {
+        const char *samples[] = {
+            "0", "-0", "1", "0.5", ".25", "1.", "3.14159", "-2.5e-3", "1e22", "1e23",
+            "123456789012345678901234567890", "0.000000000000000000000000000001",
+            "2.2250738585072011e-308", "4.9e-324", "1.7976931348623157e308", "1e400",
+            "9007199254740993", "0.1e1", "00012.50"
+        };
+        for (int i = 0; i < int(sizeof(samples) / sizeof(samples[0])); ++i) {
+            float64_t x = -1;
+            int n = parseFloat64(samples[i], strlen(samples[i]), &x);
+            FLUX_VERIFY(n == int(strlen(samples[i])));
+            FLUX_VERIFY(union_cast<uint64_t>(x) == union_cast<uint64_t>(strtod(samples[i], 0)));
+        }
+
+        float64_t x = 0;
+        FLUX_VERIFY(parseFloat64("12e", 3, &x) == 2 && x == 12);
+        FLUX_VERIFY(parseFloat64("e5", 2, &x) == 0);
+        FLUX_VERIFY(parseFloat64(".", 1, &x) == 0);
+
+        Ref<Random> random = Random::open(1);
+        for (int i = 0; i < 100000; ++i) {
+            float64_t y = random->get() * pow(10., random->get(-30, 30)) / (random->get() + 1);
+            String s = format64(y);
+            float64_t z = 0;
+            parseFloat64(s->chars(), s->count(), &z);
+            FLUX_VERIFY(y == z);
+        }
+
+        FLUX_VERIFY(String("12345678901234")->toNumber<int64_t>() == 12345678901234LL);
+        FLUX_VERIFY(String("-2147483648")->toNumber<int>() == -2147483647 - 1);
+        bool ok = true;
+        String("99999999999")->toNumber<int>(&ok);
+        FLUX_VERIFY(!ok);
+        FLUX_VERIFY(String("0x1F")->toNumber<int>() == 31);
+        FLUX_VERIFY(String("-1.25e2")->toNumber<float64_t>() == -125);
+    }
+};
+
+class Throughput: public TestCase
+{
+    void run() {
+        const int n = 1000000;
+        Ref<Random> random = Random::open(2);
+        float64_t *values = new float64_t[n];
+        for (int i = 0; i < n; ++i)
+            values[i] = random->get() / float64_t(random->get() + 1);
+
+        char buf[NumberBufferSize];
+        int total = 0;
+        double t0 = System::now();
+        for (int i = 0; i < n; ++i)
+            total += formatFloat64(buf, values[i]);
+        double t1 = System::now();
+        for (int i = 0; i < n / 10; ++i)
+            total += fnum(values[i], 17, 10, 6)->count();
+        double t2 = System::now();
+        for (int i = 0; i < n; ++i)
+            total += formatInt64(buf, int64_t(values[i] * 1e6));
+        double t3 = System::now();
+
+        fout("formatFloat64(): %% ns/value (fnum(): %% ns/value)\n")
+            << int((t1 - t0) * 1e9 / n) << int((t2 - t1) * 1e9 / (n / 10));
+        fout("formatInt64(): %% ns/value\n") << int((t3 - t2) * 1e9 / n);
+        delete[] values;
+        FLUX_VERIFY(total > 0);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    FLUX_TESTSUITE_ADD(IntegerFormatting);
+    FLUX_TESTSUITE_ADD(FloatFormatting);
+    FLUX_TESTSUITE_ADD(FloatParsing);
+    FLUX_TESTSUITE_ADD(Throughput);
+
+    return testSuite()->run(argc, argv);
+}
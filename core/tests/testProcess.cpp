@@ -10,6 +10,9 @@
 #include <flux/stdio>
 #include <flux/ProcessFactory>
 #include <flux/User>
+#include <flux/System>
+#include <flux/Dir>
+#include <flux/exceptions>
 
 using namespace flux;
 using namespace flux::testing;
@@ -87,6 +90,80 @@ class HelloEcho: public TestCase
     }
 };
 
+class SpawnOptions: public TestCase
+{
+    void run()
+    {
+        Ref<ProcessFactory> factory = ProcessFactory::create(Process::GroupLeader);
+        factory->setExecPath("/bin/sh");
+        factory->setArguments(StringList::create() << "sh" << "-c" << "pwd; echo $Hello >&2");
+        factory->setWorkingDirectory("/");
+        factory->setEnvMap(EnvMap::create() << EnvMap::Item("Hello", "World!"));
+        factory->setIoPolicy(Process::ForwardOutput | Process::ErrorToOutput);
+        Ref<Process> process = factory->produce();
+        String output = process->out()->readAll();
+        fout("output = \"%%\"\n") << output;
+        FLUX_VERIFY(output == "/\nWorld!\n");
+        FLUX_VERIFY(process->wait() == 0);
+    }
+};
+
+int openCount()
+{
+    return Dir::count("/proc/self/fd");
+}
+
+class SpawnFailure: public TestCase
+{
+    void run()
+    {
+        Ref<ProcessFactory> factory = ProcessFactory::create();
+        factory->setExecPath("/nonexistent/program");
+        factory->setIoPolicy(Process::ForwardInput | Process::ForwardOutput | Process::ForwardError);
+        int n0 = openCount();
+        int errorCode = 0;
+        String resource;
+        try {
+            factory->produce();
+        }
+        catch (SystemResourceError &ex) {
+            fout("%%\n") << ex.message();
+            errorCode = ex.errorCode();
+            resource = ex.resource();
+        }
+        FLUX_VERIFY(errorCode == ENOENT);
+        FLUX_VERIFY(resource == "/nonexistent/program");
+        FLUX_VERIFY(openCount() == n0);
+    }
+};
+
+double launchCost(ProcessFactory *factory, int n)
+{
+    double t0 = System::now();
+    for (int i = 0; i < n; ++i)
+        factory->produce()->wait();
+    return (System::now() - t0) / n;
+}
+
+class SpawnCost: public TestCase
+{
+    void run()
+    {
+        const int size = 256 << 20; // touched memory to be copied on fork()
+        String ballast(size, 'x');
+
+        Ref<ProcessFactory> factory = ProcessFactory::create();
+        factory->setExecPath("/bin/true");
+        double ts = launchCost(factory, 50);
+        factory->setFileCreationMask(022); // forces the fork() path
+        double tf = launchCost(factory, 50);
+
+        fout("launching /bin/true with %% MB resident: %% us (fork(): %% us)\n")
+            << size / (1 << 20) << int(ts * 1e6) << int(tf * 1e6);
+        FLUX_VERIFY(ballast->count() == size);
+    }
+};
+
 class CurrentProcess: public TestCase
 {
     void run()
@@ -105,6 +182,9 @@ int main(int argc, char **argv)
 
     FLUX_TESTSUITE_ADD(WorkerClone);
     FLUX_TESTSUITE_ADD(HelloEcho);
+    FLUX_TESTSUITE_ADD(SpawnOptions);
+    FLUX_TESTSUITE_ADD(SpawnFailure);
+    FLUX_TESTSUITE_ADD(SpawnCost);
     FLUX_TESTSUITE_ADD(CurrentProcess);
 
     return testSuite()->run(argc, argv);
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/testing/TestSuite>
+#include <flux/stdio>
+#include <flux/System>
+#include <flux/Thread>
+#include <flux/File>
+
+using namespace flux;
+using namespace flux::testing;
+
+/** Redirect the standard output (and optionally the standard error) to a temporary file while in scope
+  */
+class OutputCapture
+{
+public:
+    OutputCapture(bool error = false):
+        saved_(SystemStream::duplicate(stdOut())),
+        file_(File::temp())
+    {
+        flushStdOut();
+        file_->duplicateTo(stdOut());
+        if (error) {
+            savedError_ = SystemStream::duplicate(stdErr());
+            file_->duplicateTo(stdErr());
+        }
+    }
+
+    ~OutputCapture()
+    {
+        restore();
+        File::unlink(file_->path());
+    }
+
+    String restore()
+    {
+        flushStdOut();
+        saved_->duplicateTo(stdOut());
+        if (savedError_) savedError_->duplicateTo(stdErr());
+        return File::load(file_->path());
+    }
+
+private:
+    Ref<SystemStream> saved_;
+    Ref<SystemStream> savedError_;
+    Ref<File> file_;
+};
+
+class Printer: public Thread
+{
+public:
+    Printer(int id, int n): id_(id), n_(n) {}
+
+private:
+    virtual void run()
+    {
+        for (int i = 0; i < n_; ++i)
+            fout("thread %% line %% x%%\n") << id_ << i << String(i % 50, 'x');
+    }
+
+    int id_;
+    int n_;
+};
+
+class AtomicFormats: public TestCase
+{
+    void run()
+    {
+        const int m = 4, n = 10000;
+        String text;
+        {
+            OutputCapture capture;
+            Ref<Printer> printer[m];
+            for (int k = 0; k < m; ++k) {
+                printer[k] = new Printer(k, n);
+                printer[k]->start();
+            }
+            for (int k = 0; k < m; ++k)
+                printer[k]->wait();
+            text = capture.restore();
+        }
+        Ref<StringList> lines = text->split('\n');
+        FLUX_VERIFY(lines->count() == m * n);
+        int next[m];
+        for (int k = 0; k < m; ++k) next[k] = 0;
+        for (int i = 0; i < m * n; ++i) {
+            Ref<StringList> fields = lines->at(i)->split(' ');
+            FLUX_VERIFY(fields->count() == 5);
+            int k = fields->at(1)->toNumber<int>();
+            int j = fields->at(3)->toNumber<int>();
+            FLUX_VERIFY(0 <= k && k < m);
+            FLUX_VERIFY(j == next[k]);
+            FLUX_VERIFY(fields->at(4)->count() == j % 50 + 1);
+            next[k] = j + 1;
+        }
+    }
+};
+
+class ErrorOrder: public TestCase
+{
+    void run()
+    {
+        String text;
+        {
+            OutputCapture capture(true);
+            for (int i = 0; i < 3; ++i) {
+                fout("command %%\n") << i;
+                ferr("error %%\n") << i;
+            }
+            fout("done\n");
+            text = capture.restore();
+        }
+        FLUX_VERIFY(text == "command 0\nerror 0\ncommand 1\nerror 1\ncommand 2\nerror 2\ndone\n");
+    }
+};
+
+class BufferCost: public TestCase
+{
+    void run()
+    {
+        const int n = 100000;
+        String data = "0123456789abcdef"; // no newline, which would flush on a terminal
+        double t0, t1, t2;
+        {
+            OutputCapture capture;
+            Ref<SystemStream> raw = SystemStream::duplicate(stdOut());
+            t0 = System::now();
+            for (int i = 0; i < n; ++i) stdOut()->write(data);
+            flushStdOut();
+            t1 = System::now();
+            for (int i = 0; i < n; ++i) raw->write(data);
+            t2 = System::now();
+            FLUX_VERIFY(capture.restore()->count() == 2 * n * data->count());
+        }
+        fout("%% writes: %% ns/write buffered, %% ns/write unbuffered\n")
+            << n << int((t1 - t0) * 1e9 / n) << int((t2 - t1) * 1e9 / n);
+        FLUX_VERIFY(t1 - t0 < t2 - t1);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    FLUX_TESTSUITE_ADD(AtomicFormats);
+    FLUX_TESTSUITE_ADD(ErrorOrder);
+    FLUX_TESTSUITE_ADD(BufferCost);
+
+    return testSuite()->run(argc, argv);
+}
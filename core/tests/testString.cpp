@@ -69,11 +69,62 @@ class FindSplitReplace: public TestCase
     }
 };
 
+class Utf8Utf16: public TestCase
+{
+    void run() {
+        String s = "Übertragung: Привет, \xF0\x9D\x84\x9E and more than sixteen ASCII characters";
+        FLUX_VERIFY(s->isValidUtf8());
+        Ref<Unicode> chars = Unicode::open(s);
+        FLUX_VERIFY(s->countCodePoints() == chars->count());
+        int n = 0;
+        for (Utf8Walker w(s->chars()); w.valid(); ++w) ++n;
+        FLUX_VERIFY(n == chars->count());
+
+        const char *broken[] = {
+            "\x80", "\xC0\xAF", "\xE0\x80\xAF", "\xED\xA0\x80",
+            "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "0123456789abcdef\xC3"
+        };
+        for (int i = 0; i < int(sizeof(broken) / sizeof(broken[0])); ++i)
+            FLUX_VERIFY(!String(broken[i])->isValidUtf8());
+
+        for (int endian = 0; endian < 2; ++endian) {
+            String utf16 = s->toUtf16(endian);
+            FLUX_VERIFY(utf16->count() == 2 * 62 + 2);
+            utf16->truncate(utf16->count() - 2);
+            FLUX_VERIFY(ByteArray::fromUtf16(utf16, endian) == s);
+        }
+
+        String ascii = "All of this is plain 7 bit ASCII text.";
+        FLUX_VERIFY(Unicode::open(ascii)->count() == ascii->count());
+        FLUX_VERIFY(Unicode::open(ascii)->at(4) == 'o');
+        String ascii16 = ascii->toUtf16();
+        FLUX_VERIFY(ByteArray::fromUtf16(ascii16->truncate(ascii16->count() - 2)) == ascii);
+
+        String bom = ByteArray::copy("\xFF\xFEH\0i\0", 6);
+        FLUX_VERIFY(ByteArray::fromUtf16(bom, BigEndian) == "Hi");
+    }
+};
+
+class EmbeddedZero: public TestCase
+{
+    void run() {
+        String s = ByteArray::copy("ab\0cd", 5);
+        Ref<Unicode> chars = Unicode::open(s);
+        FLUX_VERIFY(chars->count() == 2);
+        FLUX_VERIFY(chars->has(1) && chars->at(1) == 'b');
+        FLUX_VERIFY(!chars->has(2));
+        FLUX_VERIFY(!chars->has(3));
+        FLUX_VERIFY(Unicode::open(s)->has(1) && !Unicode::open(s)->has(3));
+    }
+};
+
 int main(int argc, char **argv)
 {
     FLUX_TESTSUITE_ADD(CountCopySplitJoin);
     FLUX_TESTSUITE_ADD(UnicodeEscapes);
     FLUX_TESTSUITE_ADD(FindSplitReplace);
+    FLUX_TESTSUITE_ADD(Utf8Utf16);
+    FLUX_TESTSUITE_ADD(EmbeddedZero);
 
     return testSuite()->run(argc, argv);
 }
@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <sys/resource.h> // getrlimit
+#include <sys/select.h> // FD_SETSIZE
+#include <sys/socket.h> // socketpair
+#include <time.h> // clock_gettime
+#include <unistd.h> // pipe, dup2
+#include <fcntl.h> // fcntl
+#include <flux/testing/TestSuite>
+#include <flux/stdio>
+#include <flux/System>
+#include <flux/exceptions>
+#include <flux/SystemStream>
+#include <flux/File>
+#include <flux/Thread>
+
+using namespace flux;
+using namespace flux::testing;
+
+class Pipe {
+public:
+    Pipe() {
+        int fd[2];
+        FLUX_VERIFY(::pipe(fd) == 0);
+        in_ = SystemStream::create(fd[0]);
+        out_ = SystemStream::create(fd[1]);
+    }
+    Ref<SystemStream> in_;
+    Ref<SystemStream> out_;
+};
+
+class ReadDeadline: public TestCase
+{
+    void run()
+    {
+        Pipe pipe;
+        pipe.in_->setReadDeadline(System::now() + 0.05);
+        pipe.out_->write("hello");
+        Ref<ByteArray> buf = ByteArray::create(16);
+        FLUX_VERIFY(pipe.in_->read(buf) == 5);
+        double t0 = System::now();
+        bool timedOut = false;
+        try {
+            pipe.in_->read(buf);
+        }
+        catch (Timeout &) {
+            timedOut = true;
+        }
+        double dt = System::now() - t0;
+        fout("timed out after %% ms\n") << int(dt * 1000);
+        FLUX_VERIFY(timedOut);
+        FLUX_VERIFY(dt >= 0.03);
+        pipe.in_->setReadDeadline(inf);
+        pipe.out_->write("world");
+        FLUX_VERIFY(pipe.in_->read(buf) == 5);
+    }
+};
+
+class SocketDeadline: public TestCase
+{
+    void run()
+    {
+        int fd[2];
+        FLUX_VERIFY(::socketpair(AF_UNIX, SOCK_STREAM, 0, fd) == 0);
+        Ref<SystemStream> socket0 = SystemStream::create(fd[0]);
+        Ref<SystemStream> socket1 = SystemStream::create(fd[1]);
+        socket0->setReadDeadline(System::now() + 0.05);
+        FLUX_VERIFY(!(::fcntl(fd[0], F_GETFL) & O_NONBLOCK));
+        socket1->write("hello");
+        Ref<ByteArray> buf = ByteArray::create(16);
+        FLUX_VERIFY(socket0->read(buf) == 5);
+        bool timedOut = false;
+        try {
+            socket0->read(buf);
+        }
+        catch (Timeout &) {
+            timedOut = true;
+        }
+        FLUX_VERIFY(timedOut);
+        FLUX_VERIFY(!(::fcntl(fd[0], F_GETFL) & O_NONBLOCK));
+
+        // a duplicate shares the file description, it still needs to block
+        Ref<SystemStream> other = SystemStream::duplicate(socket0);
+        socket1->write("world");
+        FLUX_VERIFY(other->read(buf) == 5);
+    }
+};
+
+class HighDescriptor: public TestCase
+{
+    void run()
+    {
+        struct rlimit limit;
+        FLUX_VERIFY(::getrlimit(RLIMIT_NOFILE, &limit) == 0);
+        int fd = FD_SETSIZE + 10;
+        if (limit.rlim_cur <= rlim_t(fd)) {
+            fout("descriptor limit %% too low\n") << int(limit.rlim_cur);
+            return;
+        }
+        Pipe pipe;
+        FLUX_VERIFY(::dup2(pipe.in_->fd(), fd) == fd);
+        Ref<SystemStream> in = SystemStream::create(fd);
+        FLUX_VERIFY(!in->readyRead(0));
+        pipe.out_->write("x");
+        FLUX_VERIFY(in->readyRead(1));
+        in->setReadDeadline(System::now() + 1);
+        Ref<ByteArray> buf = ByteArray::create(1);
+        FLUX_VERIFY(in->read(buf) == 1);
+    }
+};
+
+class ReadCost: public TestCase
+{
+    void run()
+    {
+        const int n = 10000;
+        Pipe pipe;
+        Ref<ByteArray> buf = ByteArray::create(1);
+        String data = String(n, 'x');
+
+        pipe.out_->write(data);
+        double t0 = System::now();
+        for (int i = 0; i < n; ++i) {
+            FLUX_VERIFY(pipe.in_->readyRead(1));
+            pipe.in_->read(buf);
+        }
+        double t1 = System::now();
+
+        pipe.out_->write(data);
+        pipe.in_->setReadDeadline(System::now() + 10);
+        double t2 = System::now();
+        for (int i = 0; i < n; ++i)
+            pipe.in_->read(buf);
+        double t3 = System::now();
+
+        fout("%% ns/read with readyRead(), %% ns/read with deadline\n")
+            << int((t1 - t0) * 1e9 / n) << int((t3 - t2) * 1e9 / n);
+    }
+};
+
+/** Pass data through to a system stream and count it
+  */
+class CountingSink: public Stream
+{
+public:
+    CountingSink(Stream *stream): stream_(stream), count_(0) {}
+
+    virtual void write(const ByteArray *data) { stream_->write(data); count_ += data->count(); }
+    virtual SystemStream *directSink() { return stream_->directSink(); }
+    virtual void directWritten(off_t count) { count_ += count; }
+
+    Ref<Stream> stream_;
+    off_t count_;
+};
+
+/** Pass data through to another stream in user space
+  */
+class CopySink: public Stream
+{
+public:
+    CopySink(Stream *stream): stream_(stream) {}
+
+    virtual void write(const ByteArray *data) { stream_->write(data); }
+
+    Ref<Stream> stream_;
+};
+
+class KernelTransfer: public TestCase
+{
+    void run()
+    {
+        String text = File::load(testSuite()->execPath());
+        Ref<File> source = File::open(testSuite()->execPath());
+
+        Ref<File> copy = File::temp();
+        FileUnlinkGuard guard(copy->path());
+        double t0 = System::now();
+        FLUX_VERIFY(source->transferAll(copy) == text->count());
+        double t1 = System::now();
+        FLUX_VERIFY(File::load(copy->path()) == text);
+
+        source->seek(0);
+        Ref<File> copy2 = File::temp();
+        FileUnlinkGuard guard2(copy2->path());
+        Ref<CopySink> userSpace = new CopySink(copy2);
+        double t2 = System::now();
+        FLUX_VERIFY(source->transferAll(userSpace) == text->count());
+        double t3 = System::now();
+        FLUX_VERIFY(File::load(copy2->path()) == text);
+
+        fout("%% bytes: %% us in kernel, %% us in user space\n")
+            << text->count() << int((t1 - t0) * 1e6) << int((t3 - t2) * 1e6);
+
+        source->seek(0);
+        Ref<File> copy3 = File::temp();
+        FileUnlinkGuard guard3(copy3->path());
+        Ref<CountingSink> sink = new CountingSink(copy3);
+        FLUX_VERIFY(source->transfer(1000, sink) == 1000);
+        FLUX_VERIFY(sink->count_ == 1000);
+        FLUX_VERIFY(source->transferAll(sink) == text->count() - 1000);
+        FLUX_VERIFY(sink->count_ == text->count());
+        FLUX_VERIFY(File::load(copy3->path()) == text);
+    }
+};
+
+class PipeTransfer: public TestCase
+{
+    void run()
+    {
+        String text = File::load(testSuite()->execPath());
+        Ref<File> source = File::open(testSuite()->execPath());
+
+        int fd[2];
+        FLUX_VERIFY(::socketpair(AF_UNIX, SOCK_STREAM, 0, fd) == 0);
+        Ref<SystemStream> socket0 = SystemStream::create(fd[0]);
+        Ref<SystemStream> socket1 = SystemStream::create(fd[1]);
+
+        const int n = 4000;
+        FLUX_VERIFY(source->transfer(n, socket0) == n); // sendfile
+        Pipe pipe;
+        FLUX_VERIFY(socket1->transfer(n, pipe.out_) == n); // splice
+        pipe.out_ = 0;
+        Ref<File> sink = File::temp();
+        FileUnlinkGuard guard(sink->path());
+        FLUX_VERIFY(pipe.in_->transferAll(sink) == n); // splice
+        FLUX_VERIFY(File::load(sink->path()) == text->copy(0, n));
+    }
+};
+
+class DelayedWriter: public Thread
+{
+public:
+    DelayedWriter(SystemStream *stream, String data, double delay):
+        stream_(stream), data_(data), delay_(delay)
+    {}
+
+private:
+    void run()
+    {
+        Thread::sleep(delay_);
+        stream_->write(data_);
+    }
+
+    Ref<SystemStream> stream_;
+    String data_;
+    double delay_;
+};
+
+class NonBlockingTransfer: public TestCase
+{
+    void run()
+    {
+        int fd[2];
+        FLUX_VERIFY(::socketpair(AF_UNIX, SOCK_STREAM, 0, fd) == 0);
+        Ref<SystemStream> socket0 = SystemStream::create(fd[0]);
+        Ref<SystemStream> socket1 = SystemStream::create(fd[1]);
+        FLUX_VERIFY(::fcntl(fd[1], F_SETFL, ::fcntl(fd[1], F_GETFL) | O_NONBLOCK) == 0);
+
+        const int n = 4000;
+        Ref<DelayedWriter> writer = new DelayedWriter(socket0, String(n, 'x'), 0.1);
+        writer->start();
+        Pipe pipe;
+        struct timespec t0, t1;
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+        FLUX_VERIFY(socket1->transfer(n, pipe.out_) == n); // splice
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t1);
+        writer->wait();
+        double cpu = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+        fout("waited for data using %% us of CPU time\n") << int(cpu * 1e6);
+        FLUX_VERIFY(cpu < 0.05);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    FLUX_TESTSUITE_ADD(ReadDeadline);
+    FLUX_TESTSUITE_ADD(SocketDeadline);
+    FLUX_TESTSUITE_ADD(HighDescriptor);
+    FLUX_TESTSUITE_ADD(ReadCost);
+    FLUX_TESTSUITE_ADD(KernelTransfer);
+    FLUX_TESTSUITE_ADD(PipeTransfer);
+    FLUX_TESTSUITE_ADD(NonBlockingTransfer);
+
+    return testSuite()->run(argc, argv);
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/testing/TestSuite>
+#include <flux/stdio>
+#include <flux/System>
+#include <flux/File>
+#include <flux/ThreadFactory>
+#include <flux/GlobalCoreMutex>
+#include <flux/Memory>
+
+using namespace flux;
+using namespace flux::testing;
+
+class Worker: public Thread
+{
+public:
+    Worker(volatile int *counter): sawSelf_(false), counter_(counter) {}
+    bool sawSelf_;
+private:
+    void run() {
+        sawSelf_ = (Thread::self() == this);
+        __sync_add_and_fetch(counter_, 1);
+    }
+    volatile int *counter_;
+};
+
+double startAndWait(ThreadFactory *factory, int n, int batch, volatile int *counter, bool *selfOk)
+{
+    Ref<Worker> *workers = new Ref<Worker>[batch];
+    double t0 = System::now();
+    for (int i = 0; i < n; i += batch) {
+        for (int j = 0; j < batch; ++j) {
+            workers[j] = new Worker(counter);
+            factory->start(workers[j]);
+        }
+        for (int j = 0; j < batch; ++j) {
+            workers[j]->wait();
+            *selfOk = *selfOk && workers[j]->sawSelf_;
+        }
+    }
+    double t1 = System::now();
+    delete[] workers;
+    return (t1 - t0) / n;
+}
+
+class StackCache: public TestCase
+{
+    void run() {
+        const int n = 2000;
+        volatile int counter = 0;
+        bool selfOk = true;
+        Ref<ThreadFactory> factory = ThreadFactory::create();
+        factory->setStackSize(1 << 18);
+
+        int limit = ThreadFactory::stackCacheLimit();
+        ThreadFactory::setStackCacheLimit(0);
+        double t0 = startAndWait(factory, n, 4, &counter, &selfOk);
+        ThreadFactory::setStackCacheLimit(limit);
+        double t1 = startAndWait(factory, n, 4, &counter, &selfOk);
+
+        fout("thread start/wait: %% us (uncached stacks: %% us)\n") << int(t1 * 1e6) << int(t0 * 1e6);
+        FLUX_VERIFY(counter == 2 * n);
+        FLUX_VERIFY(selfOk);
+    }
+};
+
+class ThreadReuse: public TestCase
+{
+    void run() {
+        const int n = 2000;
+        volatile int counter = 0;
+        bool selfOk = true;
+        Ref<ThreadFactory> factory = ThreadFactory::create();
+        factory->setStackSize(1 << 18);
+        factory->setReuseThreads(true);
+        double t = startAndWait(factory, n, 4, &counter, &selfOk);
+        fout("reused thread start/wait: %% us\n") << int(t * 1e6);
+        FLUX_VERIFY(counter == n);
+        FLUX_VERIFY(selfOk);
+
+        // more concurrent threads than parking slots
+        counter = 0;
+        startAndWait(factory, 64, 32, &counter, &selfOk);
+        FLUX_VERIFY(counter == 64);
+        FLUX_VERIFY(selfOk);
+    }
+};
+
+class Napper: public Thread
+{
+private:
+    void run() { Thread::sleep(0.05); }
+};
+
+class FinishedCarriedKill: public TestCase
+{
+    void run() {
+        Ref<ThreadFactory> factory = ThreadFactory::create();
+        factory->setStackSize(1 << 17); // a stack size of its own, so the carrier is known
+        factory->setReuseThreads(true);
+        Ref<Napper> first = new Napper;
+        factory->start(first);
+        first->wait();
+        Thread::sleep(0.01); // let the carrier park
+        Ref<Napper> second = new Napper;
+        factory->start(second);
+        FLUX_VERIFY(second->id() == first->id()); // same carrier
+        first->kill(SIGTERM); // would terminate the process if delivered to the carrier
+        FLUX_VERIFY(!first->stillAlive());
+        second->wait();
+    }
+};
+
+class Greeter: public Thread
+{
+private:
+    void run() { fout("Hello from a carrier"); }
+};
+
+class CarriedOutput: public TestCase
+{
+    void run() {
+        Ref<ThreadFactory> factory = ThreadFactory::create();
+        factory->setReuseThreads(true);
+        Ref<SystemStream> saved = SystemStream::duplicate(stdOut());
+        Ref<File> file = File::temp();
+        flushStdOut();
+        file->duplicateTo(stdOut());
+        Ref<Greeter> greeter = new Greeter;
+        factory->start(greeter);
+        greeter->wait();
+        String text = File::load(file->path());
+        saved->duplicateTo(stdOut());
+        File::unlink(file->path());
+        fout("text = \"%%\"\n") << text;
+        FLUX_VERIFY(text == "Hello from a carrier");
+    }
+};
+
+class Counter: public Object, public ThreadLocalSingleton<Counter>
+{
+public:
+    int value_;
+private:
+    friend class ThreadLocalSingleton<Counter>;
+    Counter(): value_(0) {}
+};
+
+class CountingWorker: public Thread
+{
+public:
+    CountingWorker(): value_(0) {}
+    int value_;
+private:
+    void run() {
+        for (int i = 0; i < 1000; ++i) ++Counter::instance()->value_;
+        value_ = Counter::instance()->value_;
+    }
+};
+
+class ThreadLocalAccess: public TestCase
+{
+    void run() {
+        const int n = 1000000;
+
+        // lookup path of previous releases: global spin lock plus pthread key
+        pthread_key_t key;
+        pthread_key_create(&key, 0);
+        pthread_setspecific(key, Memory::instance());
+        double t0 = System::now();
+        for (int i = 0; i < n; ++i) {
+            Guard<SpinLock> guard(globalCoreMutex());
+            if (!pthread_getspecific(key)) break;
+        }
+        double t1 = System::now();
+        for (int i = 0; i < n; ++i) {
+            if (!Memory::instance()) break;
+        }
+        double t2 = System::now();
+        for (int i = 0; i < n; ++i)
+            delete new int(i);
+        double t3 = System::now();
+        pthread_key_delete(key);
+
+        fout("thread-local lookup: %% ns (pthread key: %% ns)\n") << int((t2 - t1) * 1e9 / n) << int((t1 - t0) * 1e9 / n);
+        fout("allocate/free: %% ns\n") << int((t3 - t2) * 1e9 / n);
+
+        Ref<CountingWorker> a = new CountingWorker, b = new CountingWorker;
+        a->start();
+        b->start();
+        a->wait();
+        b->wait();
+        ++Counter::instance()->value_;
+        FLUX_VERIFY(a->value_ == 1000 && b->value_ == 1000);
+        FLUX_VERIFY(Counter::instance()->value_ == 1);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    FLUX_TESTSUITE_ADD(StackCache);
+    FLUX_TESTSUITE_ADD(ThreadReuse);
+    FLUX_TESTSUITE_ADD(FinishedCarriedKill);
+    FLUX_TESTSUITE_ADD(CarriedOutput);
+    FLUX_TESTSUITE_ADD(ThreadLocalAccess);
+
+    return testSuite()->run(argc, argv);
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/testing/TestSuite>
+#include <flux/stdio>
+#include <flux/System>
+#include <flux/Random>
+#include <flux/Timer>
+
+using namespace flux;
+using namespace flux::testing;
+
+class TimerTicks: public TestCase
+{
+    void run() {
+        Ref< Channel<int> > triggered = Channel<int>::create();
+        double t0 = System::now();
+        Ref< Timer<int> > timer = Timer<int>::start(t0 + 0.01, 0.01, triggered, 7);
+        int sum = 0;
+        for (int i = 0; i < 5; ++i) sum += triggered->pop();
+        double t1 = System::now();
+        fout("5 ticks in %% s\n") << t1 - t0;
+        FLUX_VERIFY(sum == 35);
+        FLUX_VERIFY(t1 - t0 >= 0.05 - 0.001);
+        timer = 0;
+        FLUX_VERIFY(TimerWheel::instance()->count() == 0);
+    }
+};
+
+class Probe: public Alarm
+{
+public:
+    Probe(Channel<Probe *> *done): fired_(0), firedAt_(0), done_(done) {}
+
+    volatile int fired_;
+    double firedAt_;
+
+private:
+    void expire() {
+        firedAt_ = System::now();
+        ++fired_;
+        done_->push(this);
+    }
+    Channel<Probe *> *done_;
+};
+
+class WheelLevels: public TestCase
+{
+    void run() {
+        Ref< Channel<Probe *> > done = Channel<Probe *>::create();
+        Ref<TimerWheel> wheel = TimerWheel::create(1e-5);
+        Ref<Random> random = Random::open(0);
+        const int n = 500;
+        Ref<Probe> probes[n];
+        double t0 = System::now();
+        for (int i = 0; i < n; ++i) {
+            probes[i] = new Probe(done);
+            wheel->schedule(probes[i], t0 + random->get(0, 1000000) * 1e-6);
+        }
+
+        // cancel every tenth probe and move every tenth other one
+        for (int i = 0; i < n; i += 10) wheel->cancel(probes[i]);
+        for (int i = 5; i < n; i += 10) wheel->schedule(probes[i], t0 + 0.5);
+        FLUX_VERIFY(wheel->count() == n - n / 10);
+
+        double maxLate = 0;
+        for (int i = 0; i < n - n / 10; ++i) {
+            Probe *probe = done->pop();
+            double late = probe->firedAt_ - probe->deadline();
+            FLUX_VERIFY(late >= 0);
+            if (late > maxLate) maxLate = late;
+        }
+        fout("max. latency: %% s\n") << maxLate;
+        FLUX_VERIFY(wheel->count() == 0);
+        for (int i = 0; i < n; ++i)
+            FLUX_VERIFY(probes[i]->fired_ == (i % 10 != 0));
+    }
+};
+
+class FarFuture: public TestCase
+{
+    void run() {
+        Ref< Channel<Probe *> > done = Channel<Probe *>::create();
+        Ref<TimerWheel> wheel = TimerWheel::create(1e-6);
+        Ref<Probe> probe = new Probe(done);
+        Ref<Probe> periodic = new Probe(done);
+        double t0 = System::now();
+        wheel->schedule(probe, t0 + 1e6);
+        wheel->schedule(periodic, t0 + 0.01, 0.001);
+        for (int i = 0; i < 10; ++i) FLUX_VERIFY(done->pop() == periodic);
+        wheel->cancel(periodic);
+        FLUX_VERIFY(probe->fired_ == 0);
+        FLUX_VERIFY(wheel->count() == 1);
+        wheel->schedule(probe, System::now() + 0.01);
+        FLUX_VERIFY(done->popBefore(System::now() + 10) == true);
+    }
+};
+
+class Dummy: public Alarm { void expire() {} };
+
+class ScheduleCost: public TestCase
+{
+    void run() {
+        const int n = 100000;
+        Ref<TimerWheel> wheel = TimerWheel::create();
+        Ref<Dummy> *alarms = new Ref<Dummy>[n];
+        for (int i = 0; i < n; ++i) alarms[i] = new Dummy;
+        double t0 = System::now();
+        for (int i = 0; i < n; ++i) wheel->schedule(alarms[i], t0 + 60 + (i % 1000));
+        double t1 = System::now();
+        for (int i = 0; i < n; ++i) wheel->cancel(alarms[i]);
+        double t2 = System::now();
+        fout("schedule(): %% ns, cancel(): %% ns\n") << int((t1 - t0) * 1e9 / n) << int((t2 - t1) * 1e9 / n);
+        FLUX_VERIFY(wheel->count() == 0);
+        delete[] alarms;
+    }
+};
+
+int main(int argc, char **argv)
+{
+    FLUX_TESTSUITE_ADD(TimerTicks);
+    FLUX_TESTSUITE_ADD(WheelLevels);
+    FLUX_TESTSUITE_ADD(FarFuture);
+    FLUX_TESTSUITE_ADD(ScheduleCost);
+
+    return testSuite()->run(argc, argv);
+}
@@ -7,10 +7,10 @@ int main(int argc, char **argv)
 {
     if (argc > 1) {
         for (int i = 1; i < argc; ++i)
-            stdOut()->write(File::open(argv[i])->map());
+            File::open(argv[i])->transferAll(stdOut());
     }
     else {
-        stdOut()->write(stdIn()->readAll());
+        stdIn()->transferAll(stdOut());
     }
     return 0;
 }
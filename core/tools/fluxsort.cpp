@@ -1,5 +1,6 @@
 #include <flux/stdio>
 #include <flux/LineSource>
+#include <flux/BufferedStream>
 #include <flux/Heap>
 
 using namespace flux;
@@ -13,8 +14,10 @@ int main()
 
     list = list->sort();
 
+    Ref<BufferedStream> out = BufferedStream::open(stdOut());
     for (int i = 0; i < list->count(); ++i)
-        fout() << list->at(i) << nl;
+        Format(out) << list->at(i) << nl;
+    out->flush();
 
     return 0;
 }
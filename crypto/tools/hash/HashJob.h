@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUXHASH_HASHJOB_H
+#define FLUXHASH_HASHJOB_H
+
+#include <flux/String>
+#include <flux/BoundedChannel>
+
+namespace fluxhash {
+
+using namespace flux;
+
+class HashWorker;
+
+class HashJob: public Object
+{
+public:
+    inline static Ref<HashJob> create(int index, String path, String requiredSum = String()) {
+        return new HashJob(index, path, requiredSum);
+    }
+
+    inline int index() const { return index_; }
+    inline String path() const { return path_; }
+    inline String requiredSum() const { return requiredSum_; }
+
+    inline String sum() const { return sum_; }
+    inline String error() const { return error_; }
+
+private:
+    friend class HashWorker;
+
+    HashJob(int index, String path, String requiredSum)
+        : index_(index),
+          path_(path),
+          requiredSum_(requiredSum)
+    {}
+
+    int index_;
+    String path_;
+    String requiredSum_;
+
+    String sum_;
+    String error_;
+};
+
+typedef BoundedChannel< Ref<HashJob> > HashJobChannel;
+
+} // namespace fluxhash
+
+#endif // FLUXHASH_HASHJOB_H
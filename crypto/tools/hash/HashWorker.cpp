@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <fcntl.h> // posix_fadvise
+#include <flux/stdio>
+#include <flux/File>
+#include <flux/MappedFile>
+#include <flux/crypto/Sha1>
+#include <flux/crypto/Md5>
+#include <flux/crypto/HashMeter>
+#include "HashWorker.h"
+
+namespace fluxhash {
+
+HashWorker::HashWorker(int algorithm, HashJobChannel *requestChannel, HashJobChannel *replyChannel):
+    algorithm_(algorithm),
+    requestChannel_(requestChannel),
+    replyChannel_(replyChannel)
+{
+    Thread::start();
+}
+
+HashWorker::~HashWorker()
+{
+    requestChannel_->push(0);
+    wait();
+}
+
+Ref<HashSum> HashWorker::createHashSum(int algorithm)
+{
+    if (algorithm == Sha1Sum) return Sha1::create();
+    return Md5::create();
+}
+
+String HashWorker::hashFile(int algorithm, String path, ByteArray *buf)
+{
+    const off_t mapThreshold = 0x10000;
+
+    Ref<HashSum> hashSum = createHashSum(algorithm);
+
+    if (path == "") {
+        stdIn()->transferAll(HashMeter::open(hashSum), buf);
+        return hashSum->finish()->hex();
+    }
+
+    Ref<File> file = File::open(path);
+    Ref<FileStatus> status = file->status();
+    if (status->type() == File::Regular && mapThreshold <= status->size()) {
+        Ref<MappedFile> mapped = MappedFile::open(file);
+        for (String window; mapped->read(&window);)
+            hashSum->feed(window);
+    }
+    else {
+        #ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(file->fd(), 0, 0, POSIX_FADV_SEQUENTIAL);
+        #endif
+        file->transferAll(HashMeter::open(hashSum), buf);
+    }
+
+    return hashSum->finish()->hex();
+}
+
+void HashWorker::process(int algorithm, HashJob *job, ByteArray *buf)
+{
+    try {
+        job->sum_ = hashFile(algorithm, job->path_, buf);
+    }
+    catch (Exception &ex) {
+        job->error_ = ex.message();
+    }
+}
+
+void HashWorker::run()
+{
+    Ref<ByteArray> buf = ByteArray::allocate(0x10000);
+
+    while (true) {
+        Ref<HashJob> job = requestChannel_->pop();
+        if (!job) break;
+        process(algorithm_, job, buf);
+        replyChannel_->push(job);
+    }
+}
+
+} // namespace fluxhash
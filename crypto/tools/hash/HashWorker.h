@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUXHASH_HASHWORKER_H
+#define FLUXHASH_HASHWORKER_H
+
+#include <flux/Thread>
+#include <flux/crypto/HashSum>
+#include "HashJob.h"
+
+namespace fluxhash {
+
+using namespace flux::crypto;
+
+class HashWorker: public Thread
+{
+public:
+    enum Algorithm { Md5Sum, Sha1Sum };
+
+    inline static Ref<HashWorker> start(int algorithm, HashJobChannel *requestChannel, HashJobChannel *replyChannel) {
+        return new HashWorker(algorithm, requestChannel, replyChannel);
+    }
+
+    static Ref<HashSum> createHashSum(int algorithm);
+    static String hashFile(int algorithm, String path, ByteArray *buf);
+    static void process(int algorithm, HashJob *job, ByteArray *buf);
+
+private:
+    HashWorker(int algorithm, HashJobChannel *requestChannel, HashJobChannel *replyChannel);
+    ~HashWorker();
+    virtual void run();
+
+    int algorithm_;
+    Ref<HashJobChannel> requestChannel_;
+    Ref<HashJobChannel> replyChannel_;
+};
+
+} // namespace fluxhash
+
+#endif // FLUXHASH_HASHWORKER_H
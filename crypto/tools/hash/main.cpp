@@ -8,42 +8,110 @@
 
 #include <flux/stdio>
 #include <flux/File>
+#include <flux/Dir>
+#include <flux/DirWalker>
+#include <flux/LineSource>
+#include <flux/System>
 #include <flux/exceptions>
 #include <flux/Arguments>
-#include <flux/crypto/Sha1>
-#include <flux/crypto/Md5>
-#include <flux/crypto/HashMeter>
+#include "HashWorker.h"
 
 using namespace flux;
-using namespace flux::crypto;
+using namespace fluxhash;
+
+typedef List< Ref<HashJob> > HashJobList;
+
+void appendJobs(HashJobList *jobs, String path, bool recursive);
+void readSums(HashJobList *jobs, String sumsPath);
+bool report(String toolName, HashJob *job, bool checkMode);
 
 int main(int argc, char **argv)
 {
     String toolName = String(argv[0])->fileName();
     try {
         Ref<Arguments> arguments = Arguments::parse(argc, argv);
-        arguments->validate(VariantMap::create());
-
-        StringList *items = arguments->items();
-        if (items->count() == 0) items->append("");
-
-        for (int i = 0; i < items->count(); ++i) {
-            String path = items->at(i);
-            Ref<HashSum> hashSum;
-            if (toolName->contains("sha1")) hashSum = Sha1::create();
-            else hashSum = Md5::create();
-            Ref<HashMeter> hashMeter = HashMeter::open(hashSum);
-            Ref<File> source;
-            if (path != "") source = File::open(path);
-            else { source = flux::stdIn(); path = "-"; }
-            source->transferAll(hashMeter);
-            fout() << hashMeter->finish()->hex() << "\t" << path << nl;
+
+        Ref<VariantMap> options = VariantMap::create();
+        options->insert("concurrency", -1);
+        options->insert("recursive", false);
+        options->insert("list", false);
+        options->insert("check", "");
+        arguments->validate(options);
+        arguments->override(options);
+
+        int algorithm = toolName->contains("sha1") ? HashWorker::Sha1Sum : HashWorker::Md5Sum;
+        int concurrency = options->value("concurrency");
+        if (concurrency <= 0) concurrency = System::concurrency();
+        bool recursive = options->value("recursive");
+        String sumsPath = options->value("check");
+        bool checkMode = (sumsPath != "");
+
+        Ref<HashJobList> jobs = HashJobList::create();
+
+        if (checkMode) {
+            readSums(jobs, sumsPath);
+        }
+        else {
+            StringList *items = arguments->items();
+            if (options->value("list")) {
+                Ref<LineSource> source = LineSource::open(stdIn());
+                for (String line; source->read(&line);)
+                    if (line != "") items->append(line);
+            }
+            else if (items->count() == 0) {
+                items->append("");
+            }
+            for (int i = 0; i < items->count(); ++i)
+                appendJobs(jobs, items->at(i), recursive);
+        }
+
+        bool ok = true;
+
+        if (concurrency == 1 || jobs->count() <= 1) {
+            Ref<ByteArray> buf = ByteArray::allocate(0x10000);
+            for (int i = 0; i < jobs->count(); ++i) {
+                HashJob *job = jobs->at(i);
+                HashWorker::process(algorithm, job, buf);
+                ok = report(toolName, job, checkMode) && ok;
+            }
+        }
+        else {
+            if (concurrency > jobs->count()) concurrency = jobs->count();
+            Ref<HashJobChannel> requestChannel = HashJobChannel::create(jobs->count() + concurrency);
+            Ref<HashJobChannel> replyChannel = HashJobChannel::create(jobs->count());
+            for (int i = 0; i < jobs->count(); ++i)
+                requestChannel->push(jobs->at(i));
+
+            typedef List< Ref<HashWorker> > WorkerList;
+            Ref<WorkerList> workers = WorkerList::create();
+            for (int i = 0; i < concurrency; ++i)
+                workers->append(HashWorker::start(algorithm, requestChannel, replyChannel));
+
+            typedef Map<int, Ref<HashJob> > PendingMap;
+            Ref<PendingMap> pending = PendingMap::create();
+            for (int next = 0; next < jobs->count();) {
+                Ref<HashJob> job = replyChannel->pop();
+                pending->insert(job->index(), job);
+                while (pending->lookup(next, &job)) {
+                    pending->remove(next);
+                    ok = report(toolName, job, checkMode) && ok;
+                    ++next;
+                }
+            }
         }
+
+        if (!ok) return 1;
     }
     catch (HelpError &) {
         fout(
-            "Usage: %% [FILE]...\n"
+            "Usage: %% [OPTION]... [FILE]...\n"
             "Computes %% sums of files.\n"
+            "\n"
+            "Options:\n"
+            "  -concurrency  number of files to hash in parallel (default: number of cores)\n"
+            "  -recursive    hash all files contained in given directories\n"
+            "  -list         read the list of files to hash from standard input\n"
+            "  -check        verify the sums listed in given file\n"
         ) << toolName << (toolName->contains("sha1") ? "SHA1" : "MD5");
     }
     catch (Exception &ex) {
@@ -52,3 +120,52 @@ int main(int argc, char **argv)
     }
     return 0;
 }
+
+void appendJobs(HashJobList *jobs, String path, bool recursive)
+{
+    if (recursive && path != "" && Dir::exists(path)) {
+        Ref<DirWalker> walker = DirWalker::open(path);
+        String childPath;
+        bool isDir = false;
+        while (walker->read(&childPath, &isDir)) {
+            if (!isDir) jobs->append(HashJob::create(jobs->count(), childPath));
+        }
+        return;
+    }
+    jobs->append(HashJob::create(jobs->count(), path));
+}
+
+void readSums(HashJobList *jobs, String sumsPath)
+{
+    Ref<LineSource> source = LineSource::open(File::open(sumsPath));
+    for (String line; source->read(&line);) {
+        int i = line->find(' ');
+        int j = line->find('\t');
+        if (j < i) i = j;
+        if (i == 0 || i == line->count()) continue;
+        String sum = line->copy(0, i)->downcase();
+        String path = line->copy(i, line->count())->trimInsitu(" \t*", "");
+        if (path == "-") path = "";
+        jobs->append(HashJob::create(jobs->count(), path, sum));
+    }
+}
+
+bool report(String toolName, HashJob *job, bool checkMode)
+{
+    String path = job->path();
+    if (path == "") path = "-";
+
+    if (job->error() != "") {
+        ferr() << toolName << ": " << job->error() << nl;
+        return false;
+    }
+
+    if (checkMode) {
+        bool ok = (job->sum() == job->requiredSum());
+        fout() << path << ": " << (ok ? "OK" : "FAILED") << nl;
+        return ok;
+    }
+
+    fout() << job->sum() << "\t" << path << nl;
+    return true;
+}
@@ -11,6 +11,7 @@
 #include <flux/exceptions>
 #include <flux/Format>
 #include <flux/Arguments>
+#include <flux/stream/LookAheadStream>
 #include <flux/tar/TarReader>
 #include <flux/tar/ArReader>
 #include <flux/tar/TarWriter>
@@ -20,6 +21,7 @@
 
 using namespace flux;
 using namespace flux::tar;
+using namespace flux::stream;
 
 int main(int argc, char **argv)
 {
@@ -54,9 +56,15 @@ int main(int argc, char **argv)
                 if (path != "") source = File::open(path);
                 else source = stdIn();
 
+                Ref<LookAheadStream> lookAhead = LookAheadStream::open(source, 0x200);
+                bool isTar = TarReader::testFormat(lookAhead);
+                lookAhead->replay();
+                bool isAr = !isTar && ArReader::testFormat(lookAhead);
+                lookAhead->done();
+
                 Ref<ArchiveReader> archive;
-                if (tarMode) archive = TarReader::open(source);
-                else archive = ArReader::open(source);
+                if (isTar || (tarMode && !isAr)) archive = TarReader::open(lookAhead);
+                else archive = ArReader::open(lookAhead);
 
                 if (options->value("list")) fluxtar::list(archive);
                 else if (options->value("status")) fluxtar::status(archive);
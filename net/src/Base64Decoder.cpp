@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/net/base64>
+#include <flux/net/Base64Decoder>
+
+namespace flux {
+namespace net {
+
+Ref<Base64Decoder> Base64Decoder::open(Stream *stream)
+{
+    return new Base64Decoder(stream);
+}
+
+Base64Decoder::Base64Decoder(Stream *stream):
+    stream_(stream),
+    outIndex_(0),
+    outFill_(0),
+    pendingFill_(0),
+    padded_(false)
+{}
+
+bool Base64Decoder::readyRead(double interval) const
+{
+    if (outIndex_ < outFill_) return true;
+    return stream_->readyRead(interval);
+}
+
+int Base64Decoder::read(ByteArray *data)
+{
+    if (!in_) {
+        in_ = ByteArray::create(0x4000);
+        out_ = ByteArray::create(0x3000);
+    }
+
+    while (outIndex_ == outFill_) {
+        int n = stream_->read(in_);
+        if (n == 0) {
+            finish();
+            return 0;
+        }
+        outIndex_ = 0;
+        outFill_ = feed(in_->chars(), n, out_->bytes());
+    }
+
+    int n = outFill_ - outIndex_;
+    if (n > data->count()) n = data->count();
+    memcpy(data->bytes(), out_->bytes() + outIndex_, n);
+    outIndex_ += n;
+    return n;
+}
+
+void Base64Decoder::write(const ByteArray *data)
+{
+    if (!out_) out_ = ByteArray::create(0x3000);
+
+    const char *s = reinterpret_cast<const char *>(data->bytes());
+    for (int m = data->count(); m > 0;) {
+        int k = (m < 0x4000) ? m : 0x4000;
+        int n = feed(s, k, out_->bytes());
+        if (n > 0) stream_->write(out_->select(0, n));
+        s += k;
+        m -= k;
+    }
+}
+
+void Base64Decoder::write(const StringList *parts)
+{
+    for (int i = 0, n = parts->count(); i < n; ++i)
+        write(parts->at(i));
+}
+
+/** Check that the input did not end within a group of four characters
+  */
+void Base64Decoder::finish()
+{
+    if (pendingFill_ > 0) throw base64::IllegalInputSize4Error();
+}
+
+/** Decode \a m characters of \a source (plus the characters pending from the previous call)
+  * into \a sink, which needs to provide room for at least 3 * (m + 3) / 4 bytes.
+  */
+int Base64Decoder::feed(const char *source, int m, uint8_t *sink)
+{
+    if (m <= 0) return 0;
+    if (padded_) throw base64::IllegalPaddingError();
+
+    const char *s = source;
+    uint8_t *d = sink;
+
+    if (pendingFill_ > 0) {
+        while (pendingFill_ < 4 && m > 0) {
+            pending_[pendingFill_++] = *s++;
+            --m;
+        }
+        if (pendingFill_ < 4) return 0;
+        int k = base64::decode(pending_, 4, d);
+        d += k;
+        pendingFill_ = 0;
+        if (k < 3) {
+            padded_ = true;
+            if (m > 0) throw base64::IllegalPaddingError();
+        }
+    }
+
+    int q = m - m % 4;
+    if (q > 0) {
+        int k = base64::decode(s, q, d);
+        d += k;
+        if (k < 3 * (q / 4)) {
+            padded_ = true;
+            if (q < m) throw base64::IllegalPaddingError();
+        }
+    }
+
+    for (int i = q; i < m; ++i)
+        pending_[pendingFill_++] = s[i];
+
+    return d - sink;
+}
+
+}} // namespace flux::net
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUXNET_BASE64DECODER_H
+#define FLUXNET_BASE64DECODER_H
+
+#include <flux/Stream>
+
+namespace flux {
+namespace net {
+
+/** \brief Base-64 decoding stream filter
+  *
+  * Reading from the decoder reads Base-64 encoded text from the underlying stream and
+  * delivers the decoded data. Writing to the decoder passes on the decoded data to
+  * the underlying stream. Input is decoded in bounded chunks, so arbitrarily large
+  * bodies can be decoded without holding them in memory.
+  * Broken input is reported by throwing a base64::DecodeError.
+  * \see Base64Encoder, base64::decode()
+  */
+class Base64Decoder: public Stream
+{
+public:
+    static Ref<Base64Decoder> open(Stream *stream);
+
+    inline Stream *stream() const { return stream_; }
+
+    virtual bool readyRead(double interval) const;
+    virtual int read(ByteArray *data);
+
+    virtual void write(const ByteArray *data);
+    virtual void write(const StringList *parts);
+
+    void finish();
+
+private:
+    Base64Decoder(Stream *stream);
+
+    int feed(const char *source, int m, uint8_t *sink);
+
+    Ref<Stream> stream_;
+    Ref<ByteArray> in_;
+    Ref<ByteArray> out_;
+    int outIndex_, outFill_;
+    char pending_[4];
+    int pendingFill_;
+    bool padded_;
+};
+
+}} // namespace flux::net
+
+#endif // FLUXNET_BASE64DECODER_H
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/net/base64>
+#include <flux/net/Base64Encoder>
+
+namespace flux {
+namespace net {
+
+Ref<Base64Encoder> Base64Encoder::open(Stream *sink)
+{
+    return new Base64Encoder(sink);
+}
+
+Base64Encoder::Base64Encoder(Stream *sink):
+    sink_(sink),
+    buf_(ByteArray::create(0x4000)),
+    pendingFill_(0)
+{}
+
+Base64Encoder::~Base64Encoder()
+{
+    try {
+        finish();
+    }
+    catch (...)
+    {}
+}
+
+void Base64Encoder::write(const ByteArray *data)
+{
+    const uint8_t *s = data->bytes();
+    int n = data->count();
+
+    while (0 < pendingFill_ && pendingFill_ < 3 && n > 0) {
+        pending_[pendingFill_++] = *s++;
+        --n;
+    }
+
+    int j = 0;
+    if (pendingFill_ == 3) {
+        j = base64::encode(pending_, 3, buf_->chars());
+        pendingFill_ = 0;
+    }
+
+    while (n >= 3) {
+        if (buf_->count() - j < 4) {
+            sink_->write(buf_->select(0, j));
+            j = 0;
+        }
+        int k = (buf_->count() - j) / 4 * 3;
+        if (k > n) k = n - n % 3;
+        j += base64::encode(s, k, buf_->chars() + j);
+        s += k;
+        n -= k;
+    }
+
+    for (; n > 0; --n) pending_[pendingFill_++] = *s++;
+
+    if (j > 0) sink_->write(buf_->select(0, j));
+}
+
+void Base64Encoder::write(const StringList *parts)
+{
+    for (int i = 0, n = parts->count(); i < n; ++i)
+        write(parts->at(i));
+}
+
+void Base64Encoder::finish()
+{
+    if (pendingFill_ == 0) return;
+    int j = base64::encode(pending_, pendingFill_, buf_->chars());
+    pendingFill_ = 0;
+    sink_->write(buf_->select(0, j));
+}
+
+}} // namespace flux::net
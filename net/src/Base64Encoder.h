@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUXNET_BASE64ENCODER_H
+#define FLUXNET_BASE64ENCODER_H
+
+#include <flux/Stream>
+
+namespace flux {
+namespace net {
+
+/** \brief Base-64 encoding output filter
+  *
+  * Everything written to the encoder is passed on Base-64 encoded to the sink stream.
+  * The final group of characters (including padding) is written on finish() or
+  * when the encoder gets destroyed. Call finish() explicitly to get notified
+  * about errors writing to the sink.
+  * \see Base64Decoder, base64::encode()
+  */
+class Base64Encoder: public Stream
+{
+public:
+    static Ref<Base64Encoder> open(Stream *sink);
+    ~Base64Encoder();
+
+    inline Stream *sink() const { return sink_; }
+
+    virtual void write(const ByteArray *data);
+    virtual void write(const StringList *parts);
+
+    void finish();
+
+private:
+    Base64Encoder(Stream *sink);
+
+    Ref<Stream> sink_;
+    Ref<ByteArray> buf_;
+    uint8_t pending_[3];
+    int pendingFill_;
+};
+
+}} // namespace flux::net
+
+#endif // FLUXNET_BASE64ENCODER_H
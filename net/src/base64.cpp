@@ -6,95 +6,165 @@
  *
  */
 
-#include <flux/ByteSink>
 #include <flux/net/base64>
 
 namespace flux {
 namespace net {
 namespace base64 {
 
-String encode(const String &source)
+enum { Invalid = 0x01000000 };
+
+class CodecTables
 {
-    const char *alphabet =
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-        "abcdefghijklmnopqrstuvwxyz"
-        "0123456789+/";
+public:
+    CodecTables()
+    {
+        const char *alphabet =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+            "abcdefghijklmnopqrstuvwxyz"
+            "0123456789+/";
 
-    const int n = source->count();
-    int i = 0;
-
-    const int m = 4 * (n / 3 + (n % 3 != 0));
-    String sink(m);
-    int l = 0;
-
-    while (i < n) {
-        uint32_t bits = 0;
-        for (int j = 0; j < 3; ++j) {
-            bits |= ((i < n) ? uint32_t(source->byteAt(i)) : uint32_t(0));
-            bits <<= 8;
-            ++i;
+        for (int x = 0; x < 0x1000; ++x) {
+            encode_[x][0] = alphabet[x >> 6];
+            encode_[x][1] = alphabet[x & 0x3F];
         }
-        bits >>= 8;
 
         for (int k = 0; k < 4; ++k) {
-            sink->at(l++) = alphabet[(bits & 0xfc0000) >> 18];
-            bits <<= 6;
+            for (int i = 0; i < 0x100; ++i)
+                decode_[k][i] = Invalid;
         }
-    }
-    if (i > 0) {
-        while (i > n) {
-            sink->at(--l) = '=';
-            --i;
+
+        for (int v = 0; v < 64; ++v) {
+            uint8_t ch = alphabet[v];
+            decode_[0][ch] = v << 18;
+            decode_[1][ch] = v << 12;
+            decode_[2][ch] = v << 6;
+            decode_[3][ch] = v;
         }
     }
 
-    return sink;
-}
+    static const CodecTables *instance()
+    {
+        static CodecTables instance_;
+        return &instance_;
+    }
 
-String decode(const String &source)
+    inline void encodeGroup(const uint8_t *s, char *d) const
+    {
+        uint32_t x = (uint32_t(s[0]) << 16) | (uint32_t(s[1]) << 8) | s[2];
+        d[0] = encode_[x >> 12][0];
+        d[1] = encode_[x >> 12][1];
+        d[2] = encode_[x & 0xFFF][0];
+        d[3] = encode_[x & 0xFFF][1];
+    }
+
+    inline uint32_t decodeGroup(const uint8_t *s, uint8_t *d) const
+    {
+        uint32_t x = decode_[0][s[0]] | decode_[1][s[1]] | decode_[2][s[2]] | decode_[3][s[3]];
+        d[0] = x >> 16;
+        d[1] = x >> 8;
+        d[2] = x;
+        return x;
+    }
+
+    inline uint32_t decodeValue(int k, uint8_t ch) const { return decode_[k][ch]; }
+
+private:
+    char encode_[0x1000][2];
+    uint32_t decode_[4][0x100];
+};
+
+/** Encode \a n bytes of \a source into encodedSize(n) characters of \a sink
+  * (including padding) and return the number of characters written.
+  */
+int encode(const uint8_t *source, int n, char *sink)
 {
-    if (source->count() % 4 != 0) throw base64::IllegalInputSize4Error();
+    const CodecTables *tables = CodecTables::instance();
 
-    const int m = source->count();
-    int p = 0;
-    while (m - p > 0) {
-        ++p;
-        if (source->at(m - p) != '=') {
-            --p;
-            break;
-        }
+    const uint8_t *s = source;
+    char *d = sink;
+
+    for (; n >= 12; n -= 12, s += 12, d += 16) {
+        tables->encodeGroup(s, d);
+        tables->encodeGroup(s + 3, d + 4);
+        tables->encodeGroup(s + 6, d + 8);
+        tables->encodeGroup(s + 9, d + 12);
     }
 
-    if (!((0 <= p) && (p <= 2))) throw base64::IllegalPaddingError();
+    for (; n >= 3; n -= 3, s += 3, d += 4)
+        tables->encodeGroup(s, d);
 
-    int n = 3 * (m / 4) - p;
-    String sink(n);
-    int i = 0;
+    if (n > 0) {
+        uint8_t h[3] = { s[0], uint8_t((n > 1) ? s[1] : 0), 0 };
+        tables->encodeGroup(h, d);
+        d[3] = '=';
+        if (n == 1) d[2] = '=';
+        d += 4;
+    }
 
-    for (int l = 0; l < m;) {
-        uint32_t bits = 0;
-        for (int k = 0; k < 4; ++k) {
-            uint32_t ch = source->at(l++);
-            if (('A' <= ch) && (ch <= 'Z')) ch -= 'A';
-            else if (('a' <= ch) && (ch <= 'z')) ch = (ch - 'a') + 26;
-            else if (('0' <= ch) && (ch <= '9')) ch = (ch - '0') + 52;
-            else if (ch == '+') ch = 62;
-            else if (ch == '/') ch = 63;
-            else if (ch == '=') ch = 0;
-            else throw base64::IllegalCharacterError();
-            bits |= ch;
-            bits <<= 6;
-        }
-        bits >>= 6;
-        for (int j = 0; j < 3; ++j) {
-            if (i == n) break;
-            uint8_t ch = (bits & 0xFF0000) >> 16;
-            bits <<= 8;
-            sink->byteAt(i++) = ch;
-        }
-        if (i == n) break;
+    return d - sink;
+}
+
+/** Decode \a m characters of \a source into \a sink and return the number of bytes written.
+  * The number of characters needs to be a multiple of 4 and only the last group of
+  * four characters may contain padding. The sink needs to provide room for 3 * m / 4 bytes.
+  */
+int decode(const char *source, int m, uint8_t *sink)
+{
+    if (m % 4 != 0) throw IllegalInputSize4Error();
+    if (m == 0) return 0;
+
+    const CodecTables *tables = CodecTables::instance();
+
+    const uint8_t *s = reinterpret_cast<const uint8_t *>(source);
+    uint8_t *d = sink;
+    uint32_t invalid = 0;
+
+    int n = m - 4;
+    for (; n >= 16; n -= 16, s += 16, d += 12) {
+        invalid |= tables->decodeGroup(s, d);
+        invalid |= tables->decodeGroup(s + 4, d + 3);
+        invalid |= tables->decodeGroup(s + 8, d + 6);
+        invalid |= tables->decodeGroup(s + 12, d + 9);
     }
+    for (; n > 0; n -= 4, s += 4, d += 3)
+        invalid |= tables->decodeGroup(s, d);
+
+    if (invalid & Invalid) throw IllegalCharacterError();
+
+    int p = (s[3] == '=') + (s[2] == '=' && s[3] == '=');
+    if (s[0] == '=' || s[1] == '=' || (s[2] == '=' && s[3] != '='))
+        throw IllegalPaddingError();
+
+    uint32_t x = tables->decodeValue(0, s[0]) | tables->decodeValue(1, s[1]);
+    if (p < 2) x |= tables->decodeValue(2, s[2]);
+    if (p < 1) x |= tables->decodeValue(3, s[3]);
+    if (x & Invalid) throw IllegalCharacterError();
+
+    *d++ = x >> 16;
+    if (p < 2) *d++ = x >> 8;
+    if (p < 1) *d++ = x;
+
+    return d - sink;
+}
+
+String encode(const String &source)
+{
+    const int n = source->count();
+    String sink(encodedSize(n));
+    if (n > 0) encode(source->bytes(), n, sink->chars());
+    return sink;
+}
+
+String decode(const String &source)
+{
+    const int m = source->count();
+    if (m % 4 != 0) throw IllegalInputSize4Error();
+    if (m == 0) return String();
 
+    int p = (source->at(m - 1) == '=') + (source->at(m - 2) == '=');
+    String sink(3 * (m / 4) - p);
+    decode(source->chars(), m, sink->bytes());
     return sink;
 }
 
@@ -22,6 +22,11 @@ namespace base64 {
 String encode(const String &source);
 String decode(const String &source);
 
+inline int encodedSize(int n) { return 4 * ((n + 2) / 3); }
+
+int encode(const uint8_t *source, int n, char *sink);
+int decode(const char *source, int m, uint8_t *sink);
+
 /** \brief Base64 decoding failed: broken input
   */
 class DecodeError {
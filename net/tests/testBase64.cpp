@@ -8,7 +8,11 @@
 
 #include <flux/testing/TestSuite>
 #include <flux/stdio>
+#include <flux/System>
+#include <flux/Random>
 #include <flux/net/base64>
+#include <flux/net/Base64Encoder>
+#include <flux/net/Base64Decoder>
 
 using namespace flux;
 using namespace flux::testing;
@@ -25,12 +29,206 @@ class SymmetryExamples: public TestCase
             fout("base64(\"%%\") = \"%%\"\n") << a << b;
             FLUX_VERIFY(base64::decode(b) == a);
         }
+
+        FLUX_VERIFY(base64::encode("Ma") == "TWE=");
+        FLUX_VERIFY(base64::encode("M") == "TQ==");
+    }
+};
+
+class BrokenInput: public TestCase
+{
+    static bool rejected(String text) {
+        try { base64::decode(text); }
+        catch (base64::DecodeError &) { return true; }
+        return false;
+    }
+
+    void run() {
+        FLUX_VERIFY(rejected("TWE"));
+        FLUX_VERIFY(rejected("TW=E"));
+        FLUX_VERIFY(rejected("T==="));
+        FLUX_VERIFY(rejected("TQ==TWFu"));
+        FLUX_VERIFY(rejected("TWFuTW?u"));
+        FLUX_VERIFY(!rejected("TWFuTWFu"));
+    }
+};
+
+class RandomData {
+public:
+    static String create(int n, int seed) {
+        Ref<Random> random = Random::open(seed);
+        String s(n);
+        for (int i = 0; i < n; ++i) s->byteAt(i) = random->get(0, 255);
+        return s;
+    }
+};
+
+class StringSink: public Stream
+{
+public:
+    static Ref<StringSink> create() { return new StringSink; }
+    void write(const ByteArray *data) { parts_->append(data->copy()); }
+    String collect() const { return parts_->join(); }
+private:
+    StringSink(): parts_(StringList::create()) {}
+    Ref<StringList> parts_;
+};
+
+class ChunkSource: public Stream
+{
+public:
+    static Ref<ChunkSource> open(String text, int seed) { return new ChunkSource(text, seed); }
+    int read(ByteArray *data) {
+        int n = random_->get(1, 100);
+        if (n > data->count()) n = data->count();
+        if (n > text_->count() - i_) n = text_->count() - i_;
+        memcpy(data->bytes(), text_->bytes() + i_, n);
+        i_ += n;
+        return n;
+    }
+private:
+    ChunkSource(String text, int seed): text_(text), random_(Random::open(seed)), i_(0) {}
+    String text_;
+    Ref<Random> random_;
+    int i_;
+};
+
+class StreamFilters: public TestCase
+{
+    void run() {
+        for (int n = 0; n < 200; n += 7) {
+            String data = RandomData::create(n, n + 1);
+            String text = base64::encode(data);
+
+            Ref<StringSink> encoded = StringSink::create();
+            {
+                Ref<Base64Encoder> encoder = Base64Encoder::open(encoded);
+                Ref<ChunkSource> source = ChunkSource::open(data, n + 2);
+                source->transferAll(encoder, ByteArray::create(13));
+            }
+            FLUX_VERIFY(encoded->collect() == text);
+
+            Ref<Base64Decoder> decoder = Base64Decoder::open(ChunkSource::open(text, n + 3));
+            FLUX_VERIFY(decoder->readAll() == data);
+
+            Ref<StringSink> decoded = StringSink::create();
+            ChunkSource::open(text, n + 4)->transferAll(Base64Decoder::open(decoded), ByteArray::create(5));
+            FLUX_VERIFY(decoded->collect() == data);
+        }
+    }
+};
+
+String referenceEncode(const String &source)
+{
+    const char *alphabet =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+        "abcdefghijklmnopqrstuvwxyz"
+        "0123456789+/";
+
+    const int n = source->count();
+    int i = 0;
+
+    const int m = 4 * (n / 3 + (n % 3 != 0));
+    String sink(m);
+    int l = 0;
+
+    while (i < n) {
+        uint32_t bits = 0;
+        for (int j = 0; j < 3; ++j) {
+            bits |= ((i < n) ? uint32_t(source->byteAt(i)) : uint32_t(0));
+            bits <<= 8;
+            ++i;
+        }
+        bits >>= 8;
+
+        for (int k = 0; k < 4; ++k) {
+            sink->at(l++) = alphabet[(bits & 0xfc0000) >> 18];
+            bits <<= 6;
+        }
+    }
+    if (i > 0) {
+        while (i > n) {
+            sink->at(--l) = '=';
+            --i;
+        }
+    }
+
+    return sink;
+}
+
+String referenceDecode(const String &source)
+{
+    const int m = source->count();
+    int p = 0;
+    while (m - p > 0) {
+        ++p;
+        if (source->at(m - p) != '=') {
+            --p;
+            break;
+        }
+    }
+
+    int n = 3 * (m / 4) - p;
+    String sink(n);
+    int i = 0;
+
+    for (int l = 0; l < m;) {
+        uint32_t bits = 0;
+        for (int k = 0; k < 4; ++k) {
+            uint32_t ch = source->at(l++);
+            if (('A' <= ch) && (ch <= 'Z')) ch -= 'A';
+            else if (('a' <= ch) && (ch <= 'z')) ch = (ch - 'a') + 26;
+            else if (('0' <= ch) && (ch <= '9')) ch = (ch - '0') + 52;
+            else if (ch == '+') ch = 62;
+            else if (ch == '/') ch = 63;
+            else if (ch == '=') ch = 0;
+            bits |= ch;
+            bits <<= 6;
+        }
+        bits >>= 6;
+        for (int j = 0; j < 3; ++j) {
+            if (i == n) break;
+            uint8_t ch = (bits & 0xFF0000) >> 16;
+            bits <<= 8;
+            sink->byteAt(i++) = ch;
+        }
+        if (i == n) break;
+    }
+
+    return sink;
+}
+
+class Throughput: public TestCase
+{
+    void run() {
+        const int n = 1 << 22;
+        String data = RandomData::create(n, 7);
+
+        double t0 = System::now();
+        String text = base64::encode(data);
+        double t1 = System::now();
+        String text2 = referenceEncode(data);
+        double t2 = System::now();
+        String data2 = base64::decode(text);
+        double t3 = System::now();
+        String data3 = referenceDecode(text);
+        double t4 = System::now();
+
+        fout("encode: %% MB/s (byte-wise reference: %% MB/s)\n") << int(n / (t1 - t0) / 1e6) << int(n / (t2 - t1) / 1e6);
+        fout("decode: %% MB/s (byte-wise reference: %% MB/s)\n") << int(n / (t3 - t2) / 1e6) << int(n / (t4 - t3) / 1e6);
+
+        FLUX_VERIFY(text == text2);
+        FLUX_VERIFY(data2 == data);
+        FLUX_VERIFY(data3 == data);
     }
 };
 
 int main(int argc, char** argv)
 {
     FLUX_TESTSUITE_ADD(SymmetryExamples);
+    FLUX_TESTSUITE_ADD(BrokenInput);
+    FLUX_TESTSUITE_ADD(StreamFilters);
+    FLUX_TESTSUITE_ADD(Throughput);
 
     return testSuite()->run(argc, argv);
 }
@@ -45,12 +45,11 @@ void LineBuffer::write(const ByteArray *buf)
         i = buf->find('\n', i);
         if (i < n) {
             ++i;
-            backlog_->pushBack(buf->copy(i0, i));
-            i0 = i;
+            backlog_->pushBack(const_cast<ByteArray *>(buf)->select(i0, i));
             String h = prefix();
             if (h != "") backlog_->pushFront(h);
             stream_->write(backlog_);
-            backlog_ = StringList::create();
+            backlog_->clear();
         }
         else {
             backlog_->pushBack(buf->copy(i0, n));
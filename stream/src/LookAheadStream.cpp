@@ -6,6 +6,7 @@
  *
  */
 
+#include <string.h> // memcpy
 #include <flux/stream/LookAheadStream>
 
 namespace flux {
@@ -18,64 +19,150 @@ Ref<LookAheadStream> LookAheadStream::open(Stream *source, int windowSize)
 
 LookAheadStream::LookAheadStream(Stream *source, int windowSize)
     : source_(source),
-      window_(ByteArray::create(windowSize)),
-      w_(windowSize), m_(0), i_(0),
-      done_(false)
+      buffer_(ByteArray::allocate(windowSize > 0 ? windowSize : 0x1000)),
+      slice_(buffer_->select(0, 0)),
+      head_(0), fill_(0), pos_(0),
+      marked_(true),
+      eoi_(false)
 {}
 
 bool LookAheadStream::readyRead(double interval) const
 {
-    if (w_ <= i_) {
-        if (done_) return source_->readyRead(interval);
-        return true;
-    }
-    if (i_ < m_) return true;
+    if (pos_ < fill_) return true;
     return source_->readyRead(interval);
 }
 
 int LookAheadStream::read(ByteArray *data)
 {
-    if (w_ <= i_) {
-        if (done_) return source_->read(data);
-        return 0;
-    }
-
-    if (i_ < m_) {
-        int i1 = i_ + data->count();
-        if (i1 > m_) i1 = m_;
-        *data = *(window_->select(i_, i1));
-        int n = i1 - i_;
-        i_ = i1;
-        return n;
+    if (pos_ == fill_) {
+        if (!marked_) return source_->read(data);
+        if (!fetch()) return 0;
     }
 
-    if (done_) return source_->read(data);
-
-    int r = data->count();
-    if (m_ + r > w_) r = w_ - m_;
-    int n = source_->read(data->select(0, r));
-    if (n == 0) return 0;
-    *(window_->select(m_, m_ + n)) = *data;
-    m_ += n;
-    i_ += n;
+    int n = fill_ - pos_;
+    if (n > data->count()) n = data->count();
+    int w = buffer_->count();
+    int i = (head_ + pos_) % w;
+    int n1 = (i + n <= w) ? n : w - i;
+    memcpy(data->bytes(), buffer_->bytes() + i, n1);
+    if (n1 < n) memcpy(data->bytes() + n1, buffer_->bytes(), n - n1);
+    pos_ += n;
+    release();
     return n;
 }
 
 off_t LookAheadStream::transfer(off_t count, Stream *sink, ByteArray *buf)
 {
-    if (done_) return source_->transfer(count, sink, buf);
+    if (pos_ == fill_ && !marked_) return source_->transfer(count, sink, buf);
     return Stream::transfer(count, sink, buf);
 }
 
-void LookAheadStream::replay()
+/** Look at the next \a count bytes without consuming them
+  * \return view of the data, shorter than \a count only at the end of input
+  */
+ByteArray *LookAheadStream::peek(int count)
+{
+    while (fill_ - pos_ < count && fetch());
+    int n = fill_ - pos_;
+    if (n > count) n = count;
+    return view(pos_, n);
+}
+
+/** Consume the next \a count bytes without copying them
+  * \return view of the data, shorter than \a count only at the end of input
+  */
+ByteArray *LookAheadStream::readSpan(int count)
+{
+    ByteArray *data = peek(count);
+    pos_ += data->count();
+    release();
+    return data;
+}
+
+/** Start recording at the current read position, dropping any earlier mark
+  */
+void LookAheadStream::mark()
+{
+    marked_ = true;
+    head_ = (head_ + pos_) % buffer_->count();
+    fill_ -= pos_;
+    pos_ = 0;
+}
+
+/** Rewind to the mark
+  */
+void LookAheadStream::reset()
+{
+    if (marked_) pos_ = 0;
+}
+
+/** Stop recording, the data already buffered ahead is still served
+  */
+void LookAheadStream::unmark()
+{
+    marked_ = false;
+    release();
+}
+
+/** Read from the source stream into the free part of the ring
+  */
+bool LookAheadStream::fetch()
+{
+    if (eoi_) return false;
+    if (fill_ == 0) head_ = 0;
+    else if (fill_ == buffer_->count()) grow();
+    int w = buffer_->count();
+    int i = (head_ + fill_) % w;
+    int i1 = (i < head_) ? head_ : w;
+    int n = source_->read(slice_->reselect(i, i1));
+    if (n == 0) {
+        eoi_ = true;
+        return false;
+    }
+    fill_ += n;
+    return true;
+}
+
+void LookAheadStream::grow()
 {
-    if (!done_) i_ = 0;
+    linearize(2 * buffer_->count());
 }
 
-void LookAheadStream::done()
+/** Move the retained data to the beginning of a new buffer of size \a capacity
+  */
+void LookAheadStream::linearize(int capacity)
 {
-    i_ = 0;
-    done_ = true;
+    Ref<ByteArray> buffer = ByteArray::allocate(capacity);
+    int w = buffer_->count();
+    int n1 = (head_ + fill_ <= w) ? fill_ : w - head_;
+    memcpy(buffer->bytes(), buffer_->bytes() + head_, n1);
+    if (n1 < fill_) memcpy(buffer->bytes() + n1, buffer_->bytes(), fill_ - n1);
+    buffer_ = buffer;
+    slice_ = buffer_->select(0, 0);
+    head_ = 0;
+}
+
+/** Drop consumed data unless recording
+  */
+void LookAheadStream::release()
+{
+    if (marked_) return;
+    head_ = (head_ + pos_) % buffer_->count();
+    fill_ -= pos_;
+    pos_ = 0;
+}
+
+/** Contiguous view of \a n bytes starting at the retained position \a i
+  */
+ByteArray *LookAheadStream::view(int i, int n)
+{
+    int w = buffer_->count();
+    int i0 = (head_ + i) % w;
+    if (i0 + n > w) {
+        linearize(w);
+        i0 = i;
+    }
+    return slice_->reselect(i0, i0 + n);
 }
 
 }} // namespace flux::stream
@@ -15,28 +15,62 @@ namespace flux {
 namespace stream {
 
 /** \brief Look-a-head stream buffer
+  *
+  * Data read from the source stream is kept in a ring buffer for as long as it may
+  * be needed again: peek() looks at upcoming data without consuming it and after
+  * mark() all data read can be replayed by reset(). The buffer grows as needed, so
+  * there is no limit on how much data can be replayed.
+  *
+  * A new stream is marked at its beginning. Format detection reads a header,
+  * calls replay() to try another format and finally done() to hand the stream
+  * over to the actual reader, starting from the beginning again.
+  *
+  * peek() and readSpan() return views into the buffer, which stay valid until the
+  * next operation on the stream. Once unmarked and drained, reads and transfers go
+  * to the source stream directly.
   */
 class LookAheadStream: public Stream
 {
 public:
-    static Ref<LookAheadStream> open(Stream *source, int windowSize);
+    static Ref<LookAheadStream> open(Stream *source, int windowSize = 0x1000);
+
+    inline Stream *source() const { return source_; }
 
     virtual bool readyRead(double interval) const;
     virtual int read(ByteArray *data);
     virtual off_t transfer(off_t count = -1, Stream *sink = 0, ByteArray *buf = 0);
 
-    void replay();
-    void done();
+    ByteArray *peek(int count);
+    ByteArray *readSpan(int count);
+
+    /// number of bytes buffered ahead of the read position
+    inline int buffered() const { return fill_ - pos_; }
+
+    inline bool marked() const { return marked_; }
+    void mark();
+    void reset();
+    void unmark();
+
+    inline void replay() { reset(); }
+    inline void done() { reset(); unmark(); }
 
 private:
     LookAheadStream(Stream *source, int windowSize);
 
+    bool fetch();
+    void grow();
+    void linearize(int capacity);
+    void release();
+    ByteArray *view(int i, int n);
+
     Ref<Stream> source_;
-    Ref<ByteArray> window_;
-    const int w_; // window size
-    int m_; // window fill
-    int i_; // read offset
-    bool done_;
+    Ref<ByteArray> buffer_;
+    Ref<ByteArray> slice_;
+    int head_; // buffer offset of the first byte retained
+    int fill_; // number of bytes retained
+    int pos_; // read position relative to head_
+    bool marked_;
+    bool eoi_;
 };
 
 }} // namespace flux::stream
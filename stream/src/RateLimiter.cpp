@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/System>
+#include <flux/Thread>
+#include <flux/stream/RateLimiter>
+
+namespace flux {
+namespace stream {
+
+Ref<RateLimiter> RateLimiter::open(Stream *stream)
+{
+    return new RateLimiter(stream);
+}
+
+RateLimiter::RateLimiter(Stream *stream):
+    stream_(stream),
+    readBuckets_(TokenBuckets::create()),
+    writeBuckets_(TokenBuckets::create()),
+    parkLimit_(0),
+    backlog_(StringList::create()),
+    parked_(0)
+{}
+
+RateLimiter::~RateLimiter()
+{
+    try {
+        flush();
+    }
+    catch (...)
+    {}
+}
+
+void RateLimiter::limitRead(TokenBucket *bucket)
+{
+    readBuckets_->append(bucket);
+}
+
+void RateLimiter::limitWrite(TokenBucket *bucket)
+{
+    writeBuckets_->append(bucket);
+}
+
+/** Park throttled writes, blocking only if more than \a parkLimit bytes are parked
+  * (a limit of 0 turns parking off)
+  */
+void RateLimiter::setParking(int parkLimit)
+{
+    if (parkLimit <= 0) flush();
+    parkLimit_ = parkLimit;
+}
+
+/// point in time when the next parked or unparked write can pass
+double RateLimiter::writeReadyTime() const
+{
+    return readyTime(writeBuckets_, System::now());
+}
+
+/** Pass on the parked data which is due
+  * \return true if no data is left parked
+  */
+bool RateLimiter::resume()
+{
+    while (backlog_->count() > 0) {
+        String data = backlog_->at(0);
+        int i = 0;
+        writeDue(data, &i, false);
+        parked_ -= i;
+        if (i < data->count()) {
+            backlog_->at(0) = data->copy(i, data->count());
+            return false;
+        }
+        backlog_->popFront();
+    }
+    return true;
+}
+
+/** Pass on all parked data, waiting for the buckets as needed
+  */
+void RateLimiter::flush()
+{
+    while (backlog_->count() > 0) {
+        String data = backlog_->popFront();
+        int i = 0;
+        writeDue(data, &i, true);
+        parked_ -= data->count();
+    }
+}
+
+bool RateLimiter::readyRead(double interval) const
+{
+    double delay = readyTime(readBuckets_, System::now()) - System::now();
+    if (delay > 0) {
+        if (delay > interval) {
+            if (interval > 0) Thread::sleep(interval);
+            return false;
+        }
+        Thread::sleep(delay);
+        interval -= delay;
+    }
+    return stream_->readyRead(interval);
+}
+
+int RateLimiter::read(ByteArray *data)
+{
+    double t = readyTime(readBuckets_, System::now());
+    if (t > System::now()) Thread::sleepUntil(t);
+    int n = quantum(readBuckets_, data->count());
+    n = (n < data->count()) ? stream_->read(data->select(0, n)) : stream_->read(data);
+    take(readBuckets_, n, System::now());
+    return n;
+}
+
+void RateLimiter::write(const ByteArray *data)
+{
+    int i = 0;
+    if (backlog_->count() == 0) writeDue(data, &i, !parking());
+    if (i == data->count()) return;
+    backlog_->append(data->copy(i, data->count()));
+    parked_ += data->count() - i;
+    if (parked_ > parkLimit_) {
+        while (!resume() && parked_ > parkLimit_)
+            Thread::sleepUntil(writeReadyTime());
+    }
+}
+
+void RateLimiter::write(const StringList *parts)
+{
+    if (writeBuckets_->count() == 0 && backlog_->count() == 0) {
+        stream_->write(parts);
+        return;
+    }
+    for (int i = 0; i < parts->count(); ++i)
+        write(parts->at(i));
+}
+
+/** Write \a data starting at \a i as far as the buckets permit, waiting for the
+  * buckets if \a wait is true
+  */
+void RateLimiter::writeDue(const ByteArray *data, int *i, bool wait)
+{
+    int n = data->count();
+    while (*i < n) {
+        double now = System::now();
+        double t = readyTime(writeBuckets_, now);
+        if (t > now) {
+            if (!wait) break;
+            Thread::sleepUntil(t);
+            now = System::now();
+        }
+        int m = quantum(writeBuckets_, n - *i);
+        if (*i == 0 && m == n) stream_->write(data);
+        else stream_->write(const_cast<ByteArray *>(data)->select(*i, *i + m));
+        take(writeBuckets_, m, now);
+        *i += m;
+    }
+}
+
+double RateLimiter::readyTime(TokenBuckets *buckets, double now)
+{
+    double t = now;
+    for (int i = 0; i < buckets->count(); ++i) {
+        double t2 = buckets->at(i)->readyTime(now);
+        if (t2 > t) t = t2;
+    }
+    return t;
+}
+
+int RateLimiter::quantum(TokenBuckets *buckets, int count)
+{
+    for (int i = 0; i < buckets->count(); ++i) {
+        double burst = buckets->at(i)->burst();
+        if (count > burst) count = int(burst);
+    }
+    return count;
+}
+
+void RateLimiter::take(TokenBuckets *buckets, int amount, double now)
+{
+    for (int i = 0; i < buckets->count(); ++i)
+        buckets->at(i)->take(amount, now);
+}
+
+}} // namespace flux::stream
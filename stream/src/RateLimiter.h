@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUXSTREAM_RATELIMITER_H
+#define FLUXSTREAM_RATELIMITER_H
+
+#include <flux/Stream>
+#include <flux/stream/TokenBucket>
+
+namespace flux {
+namespace stream {
+
+/** \brief Bandwidth shaping stream
+  *
+  * Reads and writes are limited by any number of token buckets, e.g. one for the
+  * connection, one shared by all connections from the same origin and a global one.
+  * Data is passed on in portions of at most the smallest burst size and each portion
+  * waits until none of the buckets is overdrawn.
+  *
+  * In parking mode throttled writes don't wait. Instead, the data is parked and
+  * the write returns immediately. An event loop calls resume() once writeReadyTime()
+  * has come to pass the parked data on. A write only blocks if more than
+  * parkLimit() bytes are parked.
+  * \see TokenBucket, TransferLimiter
+  */
+class RateLimiter: public Stream
+{
+public:
+    static Ref<RateLimiter> open(Stream *stream);
+    ~RateLimiter();
+
+    inline Stream *stream() const { return stream_; }
+
+    void limitRead(TokenBucket *bucket);
+    void limitWrite(TokenBucket *bucket);
+
+    inline bool parking() const { return parkLimit_ > 0; }
+    inline int parkLimit() const { return parkLimit_; }
+    void setParking(int parkLimit = 0x10000);
+
+    inline int parked() const { return parked_; }
+    double writeReadyTime() const;
+    bool resume();
+    void flush();
+
+    virtual bool readyRead(double interval) const;
+    virtual int read(ByteArray *data);
+    virtual void write(const ByteArray *data);
+    virtual void write(const StringList *parts);
+
+private:
+    RateLimiter(Stream *stream);
+
+    static double readyTime(TokenBuckets *buckets, double now);
+    static int quantum(TokenBuckets *buckets, int count);
+    static void take(TokenBuckets *buckets, int amount, double now);
+    void writeDue(const ByteArray *data, int *i, bool wait);
+
+    Ref<Stream> stream_;
+    Ref<TokenBuckets> readBuckets_;
+    Ref<TokenBuckets> writeBuckets_;
+    int parkLimit_;
+    Ref<StringList> backlog_;
+    int parked_;
+};
+
+}} // namespace flux::stream
+
+#endif // FLUXSTREAM_RATELIMITER_H
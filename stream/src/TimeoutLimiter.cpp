@@ -6,6 +6,7 @@
  *
  */
 
+#include <flux/exceptions>
 #include <flux/System>
 #include <flux/stream/TimeoutLimiter>
 
@@ -19,8 +20,20 @@ Ref<TimeoutLimiter> TimeoutLimiter::open(Stream *stream, double timeout)
 
 TimeoutLimiter::TimeoutLimiter(Stream *stream, double timeout)
     : stream_(stream),
-      timeout_(timeout)
-{}
+      systemStream_(cast<SystemStream>(stream)),
+      timeout_(timeout),
+      previousDeadline_(inf)
+{
+    if (systemStream_) {
+        previousDeadline_ = systemStream_->readDeadline();
+        systemStream_->setReadDeadline(timeout_);
+    }
+}
+
+TimeoutLimiter::~TimeoutLimiter()
+{
+    if (systemStream_) systemStream_->setReadDeadline(previousDeadline_);
+}
 
 bool TimeoutLimiter::readyRead(double interval) const
 {
@@ -29,6 +42,15 @@ bool TimeoutLimiter::readyRead(double interval) const
 
 int TimeoutLimiter::read(ByteArray *buf)
 {
+    if (systemStream_) {
+        if (systemStream_->readDeadline() != timeout_) systemStream_->setReadDeadline(timeout_);
+        try {
+            return systemStream_->read(buf);
+        }
+        catch (Timeout &) {
+            throw TimeoutExceeded();
+        }
+    }
     double interval = timeout_ - System::now();
     if (interval <= 0 || !stream_->readyRead(interval))
         throw TimeoutExceeded();
@@ -45,4 +67,14 @@ void TimeoutLimiter::write(const StringList *parts)
     stream_->write(parts);
 }
 
+SystemStream *TimeoutLimiter::directSink()
+{
+    return stream_->directSink();
+}
+
+void TimeoutLimiter::directWritten(off_t count)
+{
+    stream_->directWritten(count);
+}
+
 }} // namespace flux::stream
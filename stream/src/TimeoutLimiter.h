@@ -9,19 +9,24 @@
 #ifndef FLUXSTREAM_TIMEOUTLIMITER_H
 #define FLUXSTREAM_TIMEOUTLIMITER_H
 
-#include <flux/Stream>
-#include <flux/Exception>
+#include <flux/SystemStream>
 
 namespace flux {
 namespace stream {
 
 /** \brief I/O timeout enforcing stream
+  *
+  * The timeout is an absolute deadline for all reads. On a SystemStream the deadline
+  * is handed down to the stream itself (SystemStream::setReadDeadline()), which saves
+  * waiting for readiness before each read on sockets. The stream's previous deadline
+  * is restored when the limiter is destroyed.
   * \see flux::IoMonitor
   */
 class TimeoutLimiter: public Stream
 {
 public:
     static Ref<TimeoutLimiter> open(Stream *stream, double timeout = 0);
+    ~TimeoutLimiter();
 
     inline Stream *stream() const { return stream_; }
     inline double timeout() const { return timeout_; }
@@ -31,11 +36,16 @@ public:
     virtual void write(const ByteArray *buf);
     virtual void write(const StringList *parts);
 
+    virtual SystemStream *directSink();
+    virtual void directWritten(off_t count);
+
 private:
     TimeoutLimiter(Stream *stream, double timeout);
 
     Ref<Stream> stream_;
+    SystemStream *systemStream_;
     double timeout_;
+    double previousDeadline_;
 };
 
 /** \brief Exception thrown when an I/O timeout is exceeded
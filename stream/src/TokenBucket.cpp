@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/Guard>
+#include <flux/System>
+#include <flux/stream/TokenBucket>
+
+namespace flux {
+namespace stream {
+
+/** Create a bucket filling up at \a rate bytes per second and holding up to \a burst
+  * bytes (by default the amount accumulated in 1/8 second, but at least 4 KiB)
+  */
+Ref<TokenBucket> TokenBucket::create(double rate, double burst)
+{
+    return new TokenBucket(rate, burst);
+}
+
+TokenBucket::TokenBucket(double rate, double burst):
+    rate_(rate),
+    burst_(burst),
+    time_(System::now())
+{
+    FLUX_ASSERT(rate_ > 0);
+    if (burst_ <= 0) {
+        burst_ = rate_ / 8;
+        if (burst_ < 0x1000) burst_ = 0x1000;
+    }
+    tokens_ = burst_;
+}
+
+void TokenBucket::refill(double now)
+{
+    if (now > time_) {
+        tokens_ += (now - time_) * rate_;
+        if (tokens_ > burst_) tokens_ = burst_;
+        time_ = now;
+    }
+}
+
+/// number of tokens at hand (negative if the bucket is overdrawn)
+double TokenBucket::available(double now)
+{
+    Guard<SpinLock> guard(&lock_);
+    refill(now);
+    return tokens_;
+}
+
+/// point in time when the bucket is not overdrawn anymore
+double TokenBucket::readyTime(double now)
+{
+    Guard<SpinLock> guard(&lock_);
+    refill(now);
+    if (tokens_ >= 0) return now;
+    return now - tokens_ / rate_;
+}
+
+void TokenBucket::take(double amount, double now)
+{
+    Guard<SpinLock> guard(&lock_);
+    refill(now);
+    tokens_ -= amount;
+}
+
+}} // namespace flux::stream
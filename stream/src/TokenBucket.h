@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUXSTREAM_TOKENBUCKET_H
+#define FLUXSTREAM_TOKENBUCKET_H
+
+#include <flux/SpinLock>
+#include <flux/List>
+
+namespace flux {
+namespace stream {
+
+/** \brief Token bucket for bandwidth shaping
+  *
+  * Tokens (bytes) accumulate at rate() per second up to burst(). Transfers take
+  * tokens and may overdraw the bucket, the resulting debt delays the following
+  * transfers. A bucket can be shared by any number of streams and threads to limit
+  * their aggregate bandwidth.
+  * \see RateLimiter
+  */
+class TokenBucket: public Object
+{
+public:
+    static Ref<TokenBucket> create(double rate, double burst = 0);
+
+    inline double rate() const { return rate_; }
+    inline double burst() const { return burst_; }
+
+    double available(double now);
+    double readyTime(double now);
+    void take(double amount, double now);
+
+private:
+    TokenBucket(double rate, double burst);
+
+    void refill(double now);
+
+    SpinLock lock_;
+    double rate_;
+    double burst_;
+    double tokens_;
+    double time_;
+};
+
+typedef List< Ref<TokenBucket> > TokenBuckets;
+
+}} // namespace flux::stream
+
+#endif // FLUXSTREAM_TOKENBUCKET_H
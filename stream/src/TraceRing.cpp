@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <string.h> // memcpy
+#include <flux/stream/TraceRing>
+
+namespace flux {
+namespace stream {
+
+namespace {
+
+struct TraceRecord {
+    double time;
+    int32_t channel;
+    int32_t type;
+    int32_t size;
+    int32_t length;
+};
+
+inline size_t recordSize(int length) {
+    return (sizeof(TraceRecord) + length + 7) & ~size_t(7);
+}
+
+} // namespace
+
+Ref<TraceRing> TraceRing::create(int capacity)
+{
+    return new TraceRing(capacity);
+}
+
+TraceRing::TraceRing(int capacity):
+    mask_(0x100),
+    head_(0),
+    cachedTail_(0),
+    tail_(0),
+    cachedHead_(0),
+    dropped_(0)
+{
+    while (int(mask_) < capacity) mask_ <<= 1;
+    buffer_ = new uint8_t[mask_];
+    --mask_;
+}
+
+TraceRing::~TraceRing()
+{
+    delete[] buffer_;
+}
+
+/** Append a record to the ring, capturing at most \a snapLength bytes of \a data
+  * \return false if the record was dropped
+  */
+bool TraceRing::push(double time, int channel, int type, const ByteArray *data, int snapLength)
+{
+    TraceRecord record;
+    record.time = time;
+    record.channel = channel;
+    record.type = type;
+    record.size = data ? data->count() : 0;
+    record.length = record.size < snapLength ? record.size : snapLength;
+
+    size_t n = recordSize(record.length);
+    size_t t = tail_;
+    if (mask_ + 1 - (t - cachedHead_) < n) {
+        cachedHead_ = __atomic_load_n(&head_, __ATOMIC_ACQUIRE);
+        if (mask_ + 1 - (t - cachedHead_) < n) {
+            __atomic_add_fetch(&dropped_, 1, __ATOMIC_RELAXED);
+            return false;
+        }
+    }
+    put(t, &record, sizeof(record));
+    if (record.length > 0) put(t + sizeof(record), data->bytes(), record.length);
+    __atomic_store_n(&tail_, t + n, __ATOMIC_RELEASE);
+    return true;
+}
+
+/** Take the oldest record from the ring
+  * \return false if the ring is empty
+  */
+bool TraceRing::pop(TraceEvent *event)
+{
+    size_t h = head_;
+    if (cachedTail_ == h) {
+        cachedTail_ = __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+        if (cachedTail_ == h) return false;
+    }
+    TraceRecord record;
+    get(h, &record, sizeof(record));
+    event->time = record.time;
+    event->channel = record.channel;
+    event->type = record.type;
+    event->size = record.size;
+    event->data = ByteArray::create(record.length);
+    get(h + sizeof(record), event->data->bytes(), record.length);
+    __atomic_store_n(&head_, h + recordSize(record.length), __ATOMIC_RELEASE);
+    return true;
+}
+
+void TraceRing::put(size_t offset, const void *data, size_t n)
+{
+    size_t i = offset & mask_;
+    size_t n1 = (i + n <= mask_ + 1) ? n : mask_ + 1 - i;
+    memcpy(buffer_ + i, data, n1);
+    if (n1 < n) memcpy(buffer_, reinterpret_cast<const uint8_t *>(data) + n1, n - n1);
+}
+
+void TraceRing::get(size_t offset, void *data, size_t n) const
+{
+    size_t i = offset & mask_;
+    size_t n1 = (i + n <= mask_ + 1) ? n : mask_ + 1 - i;
+    memcpy(data, buffer_ + i, n1);
+    if (n1 < n) memcpy(reinterpret_cast<uint8_t *>(data) + n1, buffer_, n - n1);
+}
+
+}} // namespace flux::stream
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUXSTREAM_TRACERING_H
+#define FLUXSTREAM_TRACERING_H
+
+#include <flux/ByteArray>
+
+namespace flux {
+namespace stream {
+
+/** \brief Captured I/O event
+  * \see TraceRing
+  */
+class TraceEvent
+{
+public:
+    enum Type {
+        Input,
+        Output,
+        Close
+    };
+
+    TraceEvent(): time(0), channel(0), type(Input), size(0) {}
+
+    double time;
+    int channel;
+    int type;
+    int size; // number of bytes transferred, data holds at most the snap length
+    Ref<ByteArray> data;
+};
+
+/** \brief Lock-free ring of I/O trace records for one producer and one consumer thread
+  *
+  * Records are copied into a byte ring of fixed size. A push takes one acquire load
+  * and one release store in the common case and never blocks: if the ring is full
+  * the record is dropped and counted.
+  * \see Tracer, SpscChannel
+  */
+class TraceRing: public Object
+{
+public:
+    static Ref<TraceRing> create(int capacity = 0x100000);
+    ~TraceRing();
+
+    inline int capacity() const { return mask_ + 1; }
+
+    bool push(double time, int channel, int type, const ByteArray *data = 0, int snapLength = 0x400);
+    bool pop(TraceEvent *event);
+
+    /// number of records dropped due to a lack of space
+    inline uint64_t dropped() const { return __atomic_load_n(&dropped_, __ATOMIC_RELAXED); }
+
+    inline bool isEmpty() const {
+        return __atomic_load_n(&tail_, __ATOMIC_ACQUIRE) == __atomic_load_n(&head_, __ATOMIC_ACQUIRE);
+    }
+
+private:
+    TraceRing(int capacity);
+
+    void put(size_t offset, const void *data, size_t n);
+    void get(size_t offset, void *data, size_t n) const;
+
+    uint8_t *buffer_;
+    size_t mask_;
+    char pad0_[64];
+    size_t head_; // written by consumer
+    size_t cachedTail_; // consumer's view of tail_
+    char pad1_[64];
+    size_t tail_; // written by producer
+    size_t cachedHead_; // producer's view of head_
+    uint64_t dropped_;
+    char pad2_[64];
+};
+
+}} // namespace flux::stream
+
+#endif // FLUXSTREAM_TRACERING_H
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#include <flux/Guard>
+#include <flux/Thread>
+#include <flux/Channel>
+#include <flux/System>
+#include <flux/ThreadLocalRef>
+#include <flux/LocalStatic>
+#include <flux/Format>
+#include <flux/str>
+#include <flux/stream/StreamTap>
+#include <flux/stream/Tracer>
+
+namespace flux {
+namespace stream {
+
+/** Forwards the data of one direction of a tapped stream to the tracer
+  */
+class TraceSink: public Stream
+{
+public:
+    TraceSink(Tracer *tracer, int channel, int type):
+        tracer_(tracer),
+        channel_(channel),
+        type_(type)
+    {}
+
+    ~TraceSink()
+    {
+        if (type_ == TraceEvent::Output)
+            tracer_->ring()->push(System::now(), channel_, TraceEvent::Close);
+    }
+
+    virtual void write(const ByteArray *data)
+    {
+        if (data->count() > 0)
+            tracer_->ring()->push(System::now(), channel_, type_, data, tracer_->snapLength());
+    }
+
+private:
+    Ref<Tracer> tracer_;
+    int channel_;
+    int type_;
+};
+
+/** Collects the trace records periodically until shut down
+  */
+class TraceCollector: public Thread
+{
+public:
+    TraceCollector(Tracer *tracer):
+        tracer_(tracer),
+        shutdown_(Channel<bool>::create())
+    {}
+
+    void shutdown()
+    {
+        shutdown_->push(true);
+        wait();
+    }
+
+private:
+    virtual void run()
+    {
+        bool done = false;
+        while (!done) {
+            done = shutdown_->popBefore(System::now() + tracer_->interval_);
+            tracer_->collect();
+        }
+    }
+
+    Tracer *tracer_;
+    Ref< Channel<bool> > shutdown_;
+};
+
+class TraceRingOwner: public Object
+{
+public:
+    TraceRingOwner(int tracerId, TraceRing *ring): tracerId_(tracerId), ring_(ring) {}
+    int tracerId_;
+    Ref<TraceRing> ring_;
+};
+
+/** Start a tracer writing to \a sink every \a interval seconds, capturing at most
+  * \a snapLength bytes per read or write in rings of \a ringSize bytes per thread
+  */
+Ref<Tracer> Tracer::start(Stream *sink, double interval, int snapLength, int ringSize)
+{
+    return new Tracer(sink, interval, snapLength, ringSize);
+}
+
+Tracer::Tracer(Stream *sink, double interval, int snapLength, int ringSize):
+    sink_(sink),
+    interval_(interval),
+    snapLength_(snapLength),
+    ringSize_(ringSize),
+    mutex_(Mutex::create()),
+    rings_(Rings::create()),
+    labels_(Labels::create()),
+    nextChannel_(0),
+    dropped_(0),
+    reported_(0),
+    collector_(new TraceCollector(this))
+{
+    static int lastId = 0;
+    id_ = __sync_add_and_fetch(&lastId, 1);
+    collector_->start();
+}
+
+Tracer::~Tracer()
+{
+    collector_->shutdown();
+}
+
+/** Open a stream, which passes all data through to \a stream and traces it
+  * under the given \a label
+  */
+Ref<Stream> Tracer::tap(Stream *stream, String label)
+{
+    int channel = openChannel(label);
+    return StreamTap::open(stream,
+        new TraceSink(this, channel, TraceEvent::Input),
+        new TraceSink(this, channel, TraceEvent::Output)
+    );
+}
+
+/// total number of records dropped so far
+uint64_t Tracer::dropped() const
+{
+    Guard<Mutex> guard(mutex_);
+    uint64_t n = dropped_;
+    for (int i = 0; i < rings_->count(); ++i)
+        n += rings_->at(i)->dropped();
+    return n;
+}
+
+int Tracer::openChannel(String label)
+{
+    Guard<Mutex> guard(mutex_);
+    int channel = nextChannel_++;
+    labels_->insert(channel, label);
+    return channel;
+}
+
+TraceRing *Tracer::ring()
+{
+    ThreadLocalRef<TraceRingOwner> &owner = localStatic< ThreadLocalRef<TraceRingOwner>, Tracer >();
+    if (!owner || owner->tracerId_ != id_) {
+        Ref<TraceRing> ring = TraceRing::create(ringSize_);
+        owner = new TraceRingOwner(id_, ring);
+        Guard<Mutex> guard(mutex_);
+        rings_->append(ring);
+    }
+    return owner->ring_;
+}
+
+/** Format the records of all rings collected so far, merged in order of time
+  */
+void Tracer::collect()
+{
+    Ref<Rings> rings = Rings::create();
+    {
+        Guard<Mutex> guard(mutex_);
+        for (int i = 0; i < rings_->count();) {
+            TraceRing *ring = rings_->at(i);
+            if (ring->refCount() == 1 && ring->isEmpty()) {
+                dropped_ += ring->dropped();
+                rings_->pop(i);
+                continue;
+            }
+            rings->append(ring);
+            ++i;
+        }
+    }
+
+    int n = rings->count();
+    Ref< List<TraceEvent> > next = List<TraceEvent>::create(n);
+    Ref< List<bool> > pending = List<bool>::create(n);
+    for (int i = 0; i < n; ++i)
+        pending->at(i) = rings->at(i)->pop(&next->at(i));
+
+    while (true) {
+        int k = -1;
+        for (int i = 0; i < n; ++i) {
+            if (pending->at(i) && (k < 0 || next->at(i).time < next->at(k).time))
+                k = i;
+        }
+        if (k < 0) break;
+        format(&next->at(k));
+        pending->at(k) = rings->at(k)->pop(&next->at(k));
+    }
+
+    uint64_t total = dropped();
+    if (total > reported_) {
+        Format(sink_) << "(trace) " << total - reported_ << " records dropped\n";
+        reported_ = total;
+    }
+}
+
+/** Write a record line by line, escaping control characters
+  */
+void Tracer::format(const TraceEvent *event)
+{
+    String label;
+    {
+        Guard<Mutex> guard(mutex_);
+        if (event->type == TraceEvent::Close) {
+            labels_->remove(event->channel);
+            return;
+        }
+        label = labels_->value(event->channel);
+    }
+
+    String prefix = Format("(%%) %% %% ") << event->channel << label << (event->type == TraceEvent::Input ? ">" : "<");
+    ByteArray *data = event->data;
+    Format line(sink_);
+    for (int i0 = 0, n = data->count(); i0 < n;) {
+        line << prefix;
+        int i = i0;
+        for (; i < n; ++i) {
+            uint8_t ch = data->byteAt(i);
+            if (31 < ch && ch < 127) continue;
+            if (i0 < i) line << data->copy(i0, i);
+            i0 = i + 1;
+            if (ch == 0x0A) break;
+            if (ch == 0x09) line << "\\t";
+            else if (ch != 0x0D) line << "\\x" << hex(ch, 2);
+        }
+        if (i0 < i) line << data->copy(i0, i);
+        i0 = i + 1;
+        line << "\n";
+    }
+    if (event->size > data->count())
+        line << prefix << "... (" << event->size - data->count() << " more bytes)\n";
+}
+
+}} // namespace flux::stream
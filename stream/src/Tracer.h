@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2007-2015 Frank Mertens.
+ *
+ * Use of this source is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ */
+
+#ifndef FLUXSTREAM_TRACER_H
+#define FLUXSTREAM_TRACER_H
+
+#include <flux/Mutex>
+#include <flux/Map>
+#include <flux/stream/TraceRing>
+
+namespace flux {
+namespace stream {
+
+class TraceCollector;
+
+/** \brief Background I/O tracing
+  *
+  * Streams opened by tap() capture the data read and written into a ring buffer
+  * owned by the calling thread. The tracer thread collects the records from all
+  * rings every interval() seconds and writes them to the sink, escaped and line
+  * by line, each line prefixed by the channel number and label of the tapped
+  * stream. Tapped streams therefore never wait for the sink. If a ring runs full
+  * records are dropped and reported in the trace.
+  *
+  * Tapped streams keep the tracer alive. The tracer thread terminates after
+  * collecting the remaining records when the last reference to the tracer is gone.
+  * \see TraceRing, StreamTap
+  */
+class Tracer: public Object
+{
+public:
+    static Ref<Tracer> start(Stream *sink, double interval = 0.1, int snapLength = 0x400, int ringSize = 0x100000);
+    ~Tracer();
+
+    inline Stream *sink() const { return sink_; }
+    inline double interval() const { return interval_; }
+    inline int snapLength() const { return snapLength_; }
+
+    Ref<Stream> tap(Stream *stream, String label);
+
+    uint64_t dropped() const;
+
+private:
+    friend class TraceSink;
+    friend class TraceCollector;
+
+    Tracer(Stream *sink, double interval, int snapLength, int ringSize);
+
+    int openChannel(String label);
+    TraceRing *ring();
+
+    void collect();
+    void format(const TraceEvent *event);
+
+    Ref<Stream> sink_;
+    double interval_;
+    int snapLength_;
+    int ringSize_;
+    int id_;
+
+    typedef List< Ref<TraceRing> > Rings;
+    typedef Map<int, String> Labels;
+
+    Ref<Mutex> mutex_;
+    Ref<Rings> rings_;
+    Ref<Labels> labels_;
+    int nextChannel_;
+    uint64_t dropped_;
+    uint64_t reported_; // number of dropped records reported in the trace
+
+    Ref<TraceCollector> collector_;
+};
+
+}} // namespace flux::stream
+
+#endif // FLUXSTREAM_TRACER_H
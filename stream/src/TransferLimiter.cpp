@@ -41,7 +41,7 @@ void TransferLimiter::write(const ByteArray *buf)
 {
     if (writeLimit_ > 0 && totalWritten_ + buf->count() > writeLimit_)
         throw WriteLimitExceeded();
-    write(buf);
+    stream_->write(buf);
     totalWritten_ += buf->count();
 }
 
@@ -50,8 +50,9 @@ void TransferLimiter::write(const StringList *parts)
     size_t h = 0;
     for (int i = 0, n = parts->count(); i < n; ++i)
         h += parts->at(i)->count();
-    if (totalWritten_ + h > writeLimit_) throw WriteLimitExceeded();
-    write(parts);
+    if (writeLimit_ > 0 && totalWritten_ + h > writeLimit_)
+        throw WriteLimitExceeded();
+    stream_->write(parts);
     totalWritten_ += h;
 }
 
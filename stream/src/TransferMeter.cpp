@@ -46,4 +46,15 @@ void TransferMeter::write(const StringList *parts)
         totalWritten_ += parts->at(i)->count();
 }
 
+SystemStream *TransferMeter::directSink()
+{
+    return stream_->directSink();
+}
+
+void TransferMeter::directWritten(off_t count)
+{
+    stream_->directWritten(count);
+    totalWritten_ += count;
+}
+
 }} // namespace flux::stream
@@ -30,6 +30,9 @@ public:
     virtual void write(const ByteArray *buf);
     virtual void write(const StringList *parts);
 
+    virtual SystemStream *directSink();
+    virtual void directWritten(off_t count);
+
 private:
     TransferMeter(Stream *stream);
 
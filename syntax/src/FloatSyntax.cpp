@@ -6,7 +6,7 @@
  *
  */
 
-#include <math.h> // pow
+#include <flux/numbers>
 #include <flux/Singleton>
 #include <flux/syntax/FloatSyntax>
 
@@ -71,6 +71,7 @@ FloatSyntax::FloatSyntax()
 
 void FloatSyntax::read(float64_t *value, const ByteArray *text, Token *token) const
 {
+    int i0 = token->i0(), i1 = token->i1();
     token = token->firstChild();
 
     if (token->rule() == nan_)
@@ -89,52 +90,7 @@ void FloatSyntax::read(float64_t *value, const ByteArray *text, Token *token) co
     }
     else
     {
-        int sign = 1;
-        float64_t mantissa = 0.;
-        int epSign = 1;
-        int ep = 0;
-
-        while (token)
-        {
-            if (token->rule() == sign_)
-            {
-                if (text->at(token->i0()) == '-')
-                    sign = -1;
-            }
-            else if (token->rule() == integerPart_)
-            {
-                for (int i = token->i0(); i < token->i1(); ++i)
-                {
-                    mantissa *= 10;
-                    mantissa += text->at(i) - '0';
-                }
-            }
-            else if (token->rule() == fractionPart_)
-            {
-                float64_t h = 0.1;
-                for (int i = token->i0(); i < token->i1(); ++i, h /= 10)
-                    mantissa += h * (text->at(i) - '0');
-            }
-            else if (token->rule() == exponentSign_)
-            {
-                if (text->at(token->i0()) == '-')
-                    epSign = -1;
-            }
-            else if (token->rule() == exponent_)
-            {
-                for (int i = token->i0(); i < token->i1(); ++i)
-                {
-                    ep *= 10;
-                    ep += text->at(i) - '0';
-                }
-            }
-
-            token = token->nextSibling();
-        }
-
-        *value = sign * mantissa;
-        if (ep != 0)
-            *value *= ::pow(10., float64_t(epSign * ep));
+        parseFloat64(reinterpret_cast<const char *>(text->bytes()) + i0, i1 - i0, value);
     }
 }
 
@@ -113,6 +113,7 @@ int TestSuite::run(int argc, char **argv)
             errFile = File::temp();
             FileUnlinkGuard outGuard(outFile->path());
             FileUnlinkGuard errGuard(errFile->path());
+            flushStdOut();
             outFile->duplicateTo(stdOut());
             errFile->duplicateTo(stdErr());
         }
@@ -139,6 +140,7 @@ int TestSuite::run(int argc, char **argv)
 
         String outText, errText;
         if (report_->captureOutput()) {
+            flushStdOut();
             outSaved->duplicateTo(stdOut());
             errSaved->duplicateTo(stdErr());
             outText = outFile->map();
@@ -31,21 +31,20 @@ void JobScheduler::start()
 {
     if (started_) return;
     started_ = true;
-    serverPool_ = ServerPool::create();
-    for (int i = 0; i < concurrency_; ++i)
-        serverPool_->pushBack(JobServer::start(requestChannel_, replyChannel_));
+    server_ = JobServer::start(requestChannel_, replyChannel_, concurrency_);
 }
 
 void JobScheduler::schedule(Job *job)
 {
     requestChannel_->pushBack(job);
+    if (server_) server_->wakeup();
     ++totalCount_;
 }
 
 bool JobScheduler::collect(Ref<Job> *completedJob)
 {
     start();
-    if ((finishCount_ == totalCount_) || !serverPool_) {
+    if ((finishCount_ == totalCount_) || !server_) {
         *completedJob = 0;
         return false;
     }
@@ -54,7 +53,7 @@ bool JobScheduler::collect(Ref<Job> *completedJob)
     *completedJob = job;
     if (job->status() != 0) {
         status_ = job->status();
-        serverPool_ = 0;
+        server_ = 0;
     }
     ++finishCount_;
 
@@ -39,8 +39,7 @@ private:
     Ref<JobChannel> requestChannel_;
     Ref<JobChannel> replyChannel_;
 
-    typedef Queue< Ref<JobServer> > ServerPool;
-    Ref<ServerPool> serverPool_;
+    Ref<JobServer> server_;
 
     bool started_;
     int status_;
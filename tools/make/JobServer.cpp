@@ -6,22 +6,108 @@
  *
  */
 
+#include <sys/syscall.h> // SYS_pidfd_open
+#include <unistd.h> // pipe, read, write, syscall
+#include <string.h> // memcpy
+#include <flux/exceptions>
+#include <flux/List>
+#include <flux/IoMonitor>
 #include <flux/ProcessFactory>
 #include "JobServer.h"
 
 namespace fluxmake {
 
-JobServer::JobServer(JobChannel *requestChannel, JobChannel *replyChannel):
+class JobSupervisor: public Thread
+{
+public:
+    JobSupervisor(JobServer *server): server_(server) {}
+
+private:
+    void run() { server_->run(); }
+
+    JobServer *server_;
+};
+
+typedef List< Ref<ByteArray> > ChunkList;
+
+/** \internal
+  * \brief Output and exit status collection of a running job
+  */
+class JobSlot
+{
+public:
+    JobSlot(): outputEvent_(0), exitEvent_(0), fill_(0) {}
+
+    enum { ChunkSize = 0x4000 };
+
+    Ref<Job> job_;
+    Ref<Process> process_;
+    Ref<SystemStream> pidfd_;
+    IoEvent *outputEvent_;
+    IoEvent *exitEvent_;
+    Ref<ChunkList> chunks_;
+    int fill_; // bytes used in the last chunk
+};
+
+JobServer::JobServer(JobChannel *requestChannel, JobChannel *replyChannel, int concurrency):
     requestChannel_(requestChannel),
-    replyChannel_(replyChannel)
+    replyChannel_(replyChannel),
+    concurrency_(concurrency > 0 ? concurrency : 1),
+    shutdown_(false)
 {
-    Thread::start();
+    int fd[2];
+    if (::pipe(fd) == -1) FLUX_SYSTEM_DEBUG_ERROR(errno);
+    wakeupIn_ = SystemStream::create(fd[0]);
+    wakeupOut_ = SystemStream::create(fd[1]);
+    wakeupIn_->closeOnExec();
+    wakeupOut_->closeOnExec();
+    supervisor_ = new JobSupervisor(this);
+    supervisor_->start();
 }
 
 JobServer::~JobServer()
 {
-    requestChannel_->pushFront(0);
-    wait();
+    shutdown_ = true;
+    wakeup();
+    supervisor_->wait();
+}
+
+/** Tell the supervisor about new requests
+  */
+void JobServer::wakeup()
+{
+    char ch = 0;
+    while (::write(wakeupOut_->fd(), &ch, 1) == -1 && errno == EINTR);
+}
+
+static Ref<SystemStream> openPidFd(Process *process)
+{
+#ifdef SYS_pidfd_open
+    int fd = ::syscall(SYS_pidfd_open, process->id(), 0);
+    if (fd != -1) {
+        Ref<SystemStream> stream = SystemStream::create(fd);
+        stream->closeOnExec();
+        return stream;
+    }
+#endif
+    return 0;
+}
+
+/** Start the child process of \a job, if that fails reply with the job failed right away
+  */
+Ref<Process> JobServer::launch(ProcessFactory *factory, Job *job)
+{
+    Ref<Process> process;
+    try {
+        factory->setCommand(job->command_);
+        process = factory->produce();
+    }
+    catch (Exception &ex) {
+        job->status_ = 127; // same as the shell's "command not found"
+        job->outputText_ = ex.message() + "\n";
+        replyChannel_->pushBack(job);
+    }
+    return process;
 }
 
 void JobServer::run()
@@ -29,15 +115,100 @@ void JobServer::run()
     Ref<ProcessFactory> factory = ProcessFactory::create();
     factory->setIoPolicy(Process::CloseInput|Process::ForwardOutput|Process::ErrorToOutput);
 
+    Ref<IoMonitor> monitor = IoMonitor::create(2 * concurrency_ + 1);
+    IoEvent *wakeupEvent = monitor->addEvent(wakeupIn_, IoEvent::ReadyRead);
+
+    JobSlot *slots = new JobSlot[concurrency_];
+    Ref<ChunkList> pool = ChunkList::create();
+    int running = 0;
+
     while (true) {
-        Ref<Job> job = requestChannel_->popFront();
-        if (!job) break;
-        factory->setCommand(job->command_);
-        Ref<Process> process = factory->produce();
-        job->outputText_ = process->out()->readAll();
-        job->status_ = process->wait();
-        replyChannel_->pushBack(job);
+        for (int i = 0; i < concurrency_ && running < concurrency_ && !shutdown_; ++i) {
+            JobSlot *slot = slots + i;
+            if (slot->job_) continue;
+            Ref<Job> job;
+            while (requestChannel_->popFrontBefore(0, &job)) {
+                slot->process_ = launch(factory, job);
+                if (slot->process_) break;
+            }
+            if (!slot->process_) break;
+            slot->job_ = job;
+            slot->pidfd_ = openPidFd(slot->process_);
+            slot->outputEvent_ = monitor->addEvent(slot->process_->out(), IoEvent::ReadyRead);
+            if (slot->pidfd_) slot->exitEvent_ = monitor->addEvent(slot->pidfd_, IoEvent::ReadyRead);
+            slot->chunks_ = ChunkList::create();
+            slot->fill_ = JobSlot::ChunkSize;
+            ++running;
+        }
+
+        if (shutdown_ && running == 0) break;
+
+        Ref<IoActivity> activity = monitor->wait(-1);
+
+        for (int k = 0; k < activity->count(); ++k) {
+            IoEvent *event = activity->at(k);
+            if (event == wakeupEvent) {
+                char buf[64];
+                ::read(wakeupIn_->fd(), buf, sizeof(buf));
+                continue;
+            }
+
+            JobSlot *slot = slots;
+            while (slot->outputEvent_ != event && slot->exitEvent_ != event) ++slot;
+
+            if (event == slot->exitEvent_) {
+                monitor->removeEvent(event);
+                slot->exitEvent_ = 0;
+            }
+            else {
+                if (slot->fill_ == JobSlot::ChunkSize) {
+                    Ref<ByteArray> chunk;
+                    if (pool->count() > 0) pool->pop(&chunk);
+                    else chunk = ByteArray::create(JobSlot::ChunkSize);
+                    slot->chunks_->append(chunk);
+                    slot->fill_ = 0;
+                }
+                ByteArray *chunk = slot->chunks_->at(slot->chunks_->count() - 1);
+                ssize_t n = ::read(event->stream()->fd(), chunk->bytes() + slot->fill_, JobSlot::ChunkSize - slot->fill_);
+                if (n == -1) {
+                    if (errno == EINTR) continue;
+                    FLUX_SYSTEM_DEBUG_ERROR(errno);
+                }
+                if (n > 0) {
+                    slot->fill_ += n;
+                    continue;
+                }
+                monitor->removeEvent(event);
+                slot->outputEvent_ = 0;
+            }
+
+            if (slot->outputEvent_ || slot->exitEvent_) continue;
+
+            // without a pidfd the child is just about to exit after closing its output
+            Job *job = slot->job_;
+            job->status_ = slot->process_->wait();
+
+            ChunkList *chunks = slot->chunks_;
+            int size = 0;
+            if (chunks->count() > 0) size = (chunks->count() - 1) * JobSlot::ChunkSize + slot->fill_;
+            String text(size);
+            for (int i = 0, j = 0; i < chunks->count(); ++i, j += JobSlot::ChunkSize) {
+                ByteArray *chunk = chunks->at(i);
+                ::memcpy(text->bytes() + j, chunk->bytes(), (i < chunks->count() - 1) ? int(JobSlot::ChunkSize) : slot->fill_);
+                if (pool->count() < 4 * concurrency_) pool->append(chunk);
+            }
+            job->outputText_ = text;
+
+            replyChannel_->pushBack(job);
+            slot->job_ = 0;
+            slot->process_ = 0;
+            slot->pidfd_ = 0;
+            slot->chunks_ = 0;
+            --running;
+        }
     }
+
+    delete[] slots;
 }
 
 } // namespace fluxmake
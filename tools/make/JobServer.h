@@ -11,24 +11,46 @@
 
 #include <flux/Thread>
 #include <flux/Channel>
+#include <flux/SystemStream>
+#include <flux/ProcessFactory>
 #include "Job.h"
 
 namespace fluxmake {
 
-class JobServer: public Thread
+class JobSupervisor;
+
+/** \brief Run jobs as child processes
+  *
+  * A single supervisor thread keeps up to \a concurrency child processes running.
+  * It multiplexes their output pipes and exit notifications (pidfd) on one IoMonitor
+  * and collects the output in pooled buffers. Finished jobs are pushed to the reply
+  * channel in the order they finish. A job whose command cannot be started finishes
+  * with status 127 and the error message as output.
+  */
+class JobServer: public Object
 {
 public:
-    inline static Ref<JobServer> start(JobChannel *requestChannel, JobChannel *replyChannel) {
-        return new JobServer(requestChannel, replyChannel);
+    inline static Ref<JobServer> start(JobChannel *requestChannel, JobChannel *replyChannel, int concurrency) {
+        return new JobServer(requestChannel, replyChannel, concurrency);
     }
 
+    void wakeup();
+
 private:
-    JobServer(JobChannel *requestChannel, JobChannel *replyChannel);
+    friend class JobSupervisor;
+
+    JobServer(JobChannel *requestChannel, JobChannel *replyChannel, int concurrency);
     ~JobServer();
-    virtual void run();
+    void run();
+    Ref<Process> launch(ProcessFactory *factory, Job *job);
 
     Ref<JobChannel> requestChannel_;
     Ref<JobChannel> replyChannel_;
+    int concurrency_;
+    Ref<SystemStream> wakeupIn_;
+    Ref<SystemStream> wakeupOut_;
+    volatile bool shutdown_;
+    Ref<JobSupervisor> supervisor_;
 };
 
 } // namespace fluxmake
@@ -27,6 +27,7 @@ ChunkedSink::~ChunkedSink()
 
 void ChunkedSink::write(const ByteArray *buf)
 {
+    if (buf->count() == 0) return;
     Format(stream_) << hex(buf->count()) << "\r\n" << buf << "\r\n";
 }
 
@@ -36,6 +37,7 @@ void ChunkedSink::write(const StringList *parts)
     int total = 0;
     for (int i = 0; i < parts->count(); ++i)
         total += parts->at(i)->count();
+    if (total == 0) return;
     chunk << hex(total) << "\r\n";
     for (int i = 0; i < parts->count(); ++i)
         chunk << parts->at(i);
@@ -9,11 +9,8 @@
 #include <flux/System>
 #include <flux/LineSource>
 #include <flux/stream/TransferLimiter>
-#include <flux/stream/StreamTap>
-#include <flux/stream/LineBuffer>
 #include "exceptions.h"
 #include "ErrorLog.h"
-#include "TapBuffer.h"
 #include "RequestStream.h"
 #include "ClientConnection.h"
 
@@ -31,13 +28,7 @@ ClientConnection::ClientConnection(StreamSocket *socket, SocketAddress *address)
     stream_(requestStream_),
     address_(address),
     visit_(Visit::create(address_))
-{
-    if (errorLog()->level() >= DebugLogLevel) {
-        Ref<Stream> requestBuffer = TapBuffer::open(errorLog()->debugStream(), address_->networkAddress() + " > ");
-        Ref<Stream> responseBuffer = TapBuffer::open(errorLog()->debugStream(), address_->networkAddress() + " < ");
-        stream_ = StreamTap::open(stream_, requestBuffer, responseBuffer);
-    }
-}
+{}
 
 Ref<Request> ClientConnection::readRequest()
 {
@@ -66,6 +57,30 @@ bool ClientConnection::isPayloadConsumed() const
     return requestStream_->isPayloadConsumed();
 }
 
+void ClientConnection::trace(Tracer *tracer)
+{
+    stream_ = tracer->tap(stream_, address_->networkAddress());
+}
+
+void ClientConnection::limitRead(TokenBucket *bucket)
+{
+    rateLimiter()->limitRead(bucket);
+}
+
+void ClientConnection::limitWrite(TokenBucket *bucket)
+{
+    rateLimiter()->limitWrite(bucket);
+}
+
+RateLimiter *ClientConnection::rateLimiter()
+{
+    if (!rateLimiter_) {
+        rateLimiter_ = RateLimiter::open(stream_);
+        stream_ = rateLimiter_;
+    }
+    return rateLimiter_;
+}
+
 Ref<Request> ClientConnection::scanRequest()
 {
     requestStream_->nextHeader();
@@ -10,6 +10,8 @@
 #define FLUXNODE_CLIENTCONNECTION_H
 
 #include <flux/net/StreamSocket>
+#include <flux/stream/RateLimiter>
+#include <flux/stream/Tracer>
 #include "Visit.h"
 #include "Request.h"
 
@@ -17,6 +19,7 @@ namespace fluxnode {
 
 using namespace flux;
 using namespace flux::net;
+using namespace flux::stream;
 
 class ServiceWorker;
 class RequestStream;
@@ -37,6 +40,10 @@ public:
     void setupTimeout(double interval);
     bool isPayloadConsumed() const;
 
+    void trace(Tracer *tracer);
+    void limitRead(TokenBucket *bucket);
+    void limitWrite(TokenBucket *bucket);
+
     inline Visit *visit() const { return visit_; }
     inline int priority() const { return visit_->priority(); }
 
@@ -46,9 +53,11 @@ private:
     ClientConnection(StreamSocket *socket, SocketAddress *address);
 
     Ref<Request> scanRequest();
+    RateLimiter *rateLimiter();
 
     Ref<RequestStream> requestStream_;
     Ref<Stream> stream_;
+    Ref<RateLimiter> rateLimiter_;
     Ref<SocketAddress> address_;
     Ref<Request> request_, pendingRequest_;
 
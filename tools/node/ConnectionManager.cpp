@@ -7,7 +7,9 @@
  */
 
 #include <flux/System>
+#include <flux/File>
 #include "ErrorLog.h"
+#include "NodeConfig.h"
 #include "ClientConnection.h"
 #include "ConnectionManager.h"
 
@@ -22,9 +24,29 @@ ConnectionManager::ConnectionManager(int serviceWindow):
     closedConnections_(ClosedConnections::create()),
     connectionCounts_(ConnectionCounts::create()),
     visits_(Visits::create()),
-    serviceWindow_(serviceWindow)
+    serviceWindow_(serviceWindow),
+    originBuckets_(OriginBuckets::create()),
+    traceSampling_(nodeConfig()->traceSampling()),
+    traceCount_(0)
 {
     FLUXNODE_NOTICE() << "Service window of " << serviceWindow << "s will be used to prioritize connections" << nl;
+
+    if (nodeConfig()->totalBandwidth() > 0) {
+        totalBucket_ = TokenBucket::create(nodeConfig()->totalBandwidth(), nodeConfig()->bandwidthBurst());
+        FLUXNODE_NOTICE() << "Total bandwidth limited to " << nodeConfig()->totalBandwidth() << " bytes/s" << nl;
+    }
+
+    if (traceSampling_ == 0 && errorLog()->level() >= DebugLogLevel)
+        traceSampling_ = 1;
+
+    if (traceSampling_ > 0) {
+        Ref<Stream> sink = errorLog()->debugStream();
+        String path = nodeConfig()->tracePath();
+        if (path != "") sink = File::open(path, File::WriteOnly|File::Append|File::Create);
+        tracer_ = Tracer::start(sink);
+        traceFilter_ = nodeConfig()->traceFilter();
+        FLUXNODE_NOTICE() << "Tracing 1 in " << traceSampling_ << " connections" << nl;
+    }
 }
 
 void ConnectionManager::cycle()
@@ -48,7 +70,10 @@ void ConnectionManager::cycle()
             int index = 0;
             if (!connectionCounts_->lookup(origin, &count, &index)) continue;
 
-            if (count == 1) connectionCounts_->removeAt(index);
+            if (count == 1) {
+                connectionCounts_->removeAt(index);
+                originBuckets_->remove(origin);
+            }
             else connectionCounts_->valueAt(index) = count - 1;
         }
     }
@@ -62,6 +87,45 @@ void ConnectionManager::prioritize(ClientConnection *client)
     if (!connectionCounts_->insert(origin, 1, &count, &index))
         connectionCounts_->valueAt(index) = count + 1;
     client->visit()->setPriority(count < 8 ? 0 : -count);
+    trace(client);
+    shape(client, origin);
+}
+
+/** Trace every traceSampling_-th connection whose address matches the trace filter
+  */
+void ConnectionManager::trace(ClientConnection *client)
+{
+    if (!tracer_) return;
+    if (str(traceFilter_) != "" && !traceFilter_->match(client->address()->networkAddress())->valid()) return;
+    int n = traceCount_++;
+    if (traceCount_ == traceSampling_) traceCount_ = 0;
+    if (n == 0) client->trace(tracer_);
+}
+
+/** Throttle the client connection by its own bucket, the bucket shared by all
+  * connections from the same origin and the bucket shared by all connections
+  */
+void ConnectionManager::shape(ClientConnection *client, uint64_t origin)
+{
+    NodeConfig *config = nodeConfig();
+    double burst = config->bandwidthBurst();
+
+    if (config->connectionBandwidth() > 0)
+        client->limitWrite(TokenBucket::create(config->connectionBandwidth(), burst));
+
+    if (config->originBandwidth() > 0) {
+        Ref<TokenBucket> bucket;
+        if (!originBuckets_->lookup(origin, &bucket)) {
+            bucket = TokenBucket::create(config->originBandwidth(), burst);
+            originBuckets_->insert(origin, bucket);
+        }
+        client->limitWrite(bucket);
+    }
+
+    if (totalBucket_) client->limitWrite(totalBucket_);
+
+    if (config->uploadBandwidth() > 0)
+        client->limitRead(TokenBucket::create(config->uploadBandwidth(), burst));
 }
 
 } // namespace fluxnode
@@ -12,12 +12,17 @@
 #include <flux/types>
 #include <flux/List>
 #include <flux/Map>
+#include <flux/regexp/RegExp>
+#include <flux/stream/TokenBucket>
+#include <flux/stream/Tracer>
 #include "ServiceWorker.h"
 #include "Visit.h"
 
 namespace fluxnode {
 
 using namespace flux;
+using namespace flux::regexp;
+using namespace flux::stream;
 
 class ClientConnection;
 
@@ -34,13 +39,25 @@ public:
 private:
     ConnectionManager(int serviceWindow);
 
+    void trace(ClientConnection *client);
+    void shape(ClientConnection *client, uint64_t origin);
+
     typedef Map<uint64_t, int> ConnectionCounts;
+    typedef Map<uint64_t, Ref<TokenBucket> > OriginBuckets;
     typedef List< Ref<Visit> > Visits;
 
     Ref<ClosedConnections> closedConnections_;
     Ref<ConnectionCounts> connectionCounts_;
     Ref<Visits> visits_;
     int serviceWindow_;
+
+    Ref<OriginBuckets> originBuckets_;
+    Ref<TokenBucket> totalBucket_;
+
+    Ref<Tracer> tracer_;
+    RegExp traceFilter_;
+    int traceSampling_;
+    int traceCount_;
 };
 
 } // namespace fluxnode
@@ -8,6 +8,7 @@
 
 #include <flux/File>
 #include <flux/Dir>
+#include <flux/MappedFile>
 #include "utils.h"
 #include "exceptions.h"
 #include "ServiceWorker.h"
@@ -118,11 +119,12 @@ void DirectoryDelegate::listDirectory(Request *request, String path)
 
 void DirectoryDelegate::deliverFile(String path)
 {
-    String content = File::open(path)->map();
-    String mediaType = mediaTypeDatabase()->lookup(path, content);
+    Ref<File> file = File::open(path);
+    Ref<MappedFile> mapped = MappedFile::open(file, MappedFile::Normal);
+    String mediaType = mediaTypeDatabase()->lookup(path, mapped->map(0, 0x100)->copy());
     if (mediaType != "") header("Content-Type", mediaType);
-    begin(content->count());
-    write(content);
+    begin(mapped->size());
+    file->transfer(mapped->size(), payload());
     end();
 }
 
@@ -130,13 +132,7 @@ void DirectoryDelegate::streamFile(String path)
 {
     String mediaType = mediaTypeDatabase()->lookup(path, "");
     if (mediaType != "") header("Content-Type", mediaType);
-    Ref<File> file = File::open(path);
-    Ref<ByteArray> buf = ByteArray::create(0x10000);
-    while (true) {
-        int n = file->read(buf);
-        if (n == 0) break;
-        write(buf->select(0, n));
-    }
+    File::open(path)->transferAll(payload());
 }
 
 } // namespace fluxnode
@@ -39,6 +39,7 @@ void LogMaster::registerLog(Log *log)
         Ref<Logs> logs = Logs::create();
         logs->insert(log);
         timer = RotateTimer::start(System::now() + log->rotationInterval(), log->rotationInterval(), rotate_, logs);
+        timerByPath_->insert(log->path(), timer);
     }
     else {
         timer->tick()->insert(log);
@@ -62,6 +62,14 @@ void NodeConfig::load(int argc, char **argv)
     version_ = config->value("version");
     daemon_ = config->value("daemon");
     serviceWindow_ = config->value("service_window");
+    connectionBandwidth_ = config->value("connection_bandwidth");
+    originBandwidth_ = config->value("origin_bandwidth");
+    totalBandwidth_ = config->value("total_bandwidth");
+    uploadBandwidth_ = config->value("upload_bandwidth");
+    bandwidthBurst_ = config->value("bandwidth_burst");
+    traceSampling_ = config->value("trace_sampling");
+    traceFilter_ = config->value("trace_filter");
+    tracePath_ = config->value("trace_path");
     errorLogConfig_ = LogConfig::load(cast<MetaObject>(config->value("error_log")));
     accessLogConfig_ = LogConfig::load(cast<MetaObject>(config->value("access_log")));
 
@@ -35,6 +35,16 @@ public:
     inline bool daemon() const { return daemon_; }
     inline int serviceWindow() const { return serviceWindow_; }
 
+    inline int connectionBandwidth() const { return connectionBandwidth_; }
+    inline int originBandwidth() const { return originBandwidth_; }
+    inline int totalBandwidth() const { return totalBandwidth_; }
+    inline int uploadBandwidth() const { return uploadBandwidth_; }
+    inline int bandwidthBurst() const { return bandwidthBurst_; }
+
+    inline int traceSampling() const { return traceSampling_; }
+    inline String traceFilter() const { return traceFilter_; }
+    inline String tracePath() const { return tracePath_; }
+
     inline LogConfig *errorLogConfig() const { return errorLogConfig_; }
     inline LogConfig *accessLogConfig() const { return accessLogConfig_; }
 
@@ -53,6 +63,16 @@ private:
     bool daemon_;
     int serviceWindow_;
 
+    int connectionBandwidth_;
+    int originBandwidth_;
+    int totalBandwidth_;
+    int uploadBandwidth_;
+    int bandwidthBurst_;
+
+    int traceSampling_;
+    String traceFilter_;
+    String tracePath_;
+
     Ref<LogConfig> errorLogConfig_;
     Ref<LogConfig> accessLogConfig_;
 
@@ -33,6 +33,14 @@ protected:
         insert("version", "fluxnode/" FLUX_BUNDLE_VERSION);
         insert("daemon", false);
         insert("service_window", 30);
+        insert("connection_bandwidth", 0);
+        insert("origin_bandwidth", 0);
+        insert("total_bandwidth", 0);
+        insert("upload_bandwidth", 0);
+        insert("bandwidth_burst", 0);
+        insert("trace_sampling", 0);
+        insert("trace_filter", "");
+        insert("trace_path", "");
         insert("error_log", LogPrototype::create());
         insert("access_log", LogPrototype::create());
     }
@@ -157,4 +157,14 @@ void RequestStream::write(const StringList *parts)
     stream_->write(parts);
 }
 
+SystemStream *RequestStream::directSink()
+{
+    return stream_->directSink();
+}
+
+void RequestStream::directWritten(off_t count)
+{
+    stream_->directWritten(count);
+}
+
 } // namespace fluxnode
@@ -35,6 +35,9 @@ public:
     virtual void write(const ByteArray *buf);
     virtual void write(const StringList *parts);
 
+    virtual SystemStream *directSink();
+    virtual void directWritten(off_t count);
+
 private:
     RequestStream(Stream *stream);
 
@@ -8,6 +8,7 @@
 
 #include <flux/System>
 #include <flux/Date>
+#include <flux/BufferedStream>
 #include <flux/stream/TransferMeter>
 #include "utils.h"
 #include "NodeConfig.h"
@@ -26,6 +27,7 @@ Ref<Response> Response::create(ClientConnection *client)
 
 Response::Response(ClientConnection *client):
     client_(client),
+    stream_(BufferedStream::open(client->stream())),
     headerWritten_(false),
     statusCode_(200),
     contentLength_(-1),
@@ -62,7 +64,7 @@ void Response::writeHeader()
         insert("Last-Modified", now);
     }
 
-    Format header(client_->stream());
+    Format header(stream_);
     header << "HTTP/1.1 " << statusCode_ << " " << reasonPhrase_ << "\r\n";
     for (int i = 0; i < count(); ++i)
         header << keyAt(i) << ":" << valueAt(i) << "\r\n";
@@ -83,7 +85,7 @@ Stream *Response::payload()
 {
     if (!payload_) {
         if (!headerWritten_) writeHeader();
-        Ref<Stream> stream = client_->stream();
+        Ref<Stream> stream = stream_;
         if (contentLength_ < 0) {
             stream = ChunkedSink::open(stream);
         }
@@ -118,6 +120,7 @@ void Response::end()
         bytesWritten_ = payload_->totalWritten();
         payload_ = 0;
     }
+    stream_->flush();
 }
 
 } // namespace fluxnode
@@ -11,7 +11,7 @@
 
 #include <flux/String>
 #include <flux/Map>
-#include <flux/Stream>
+#include <flux/BufferedStream>
 
 namespace flux {
 namespace stream {
@@ -41,6 +41,7 @@ public:
 
 private:
     friend class ServiceWorker;
+    friend class ServiceDelegate;
 
     Response(ClientConnection *client);
 
@@ -52,6 +53,7 @@ private:
     size_t bytesWritten() const;
 
     Ref<ClientConnection> client_;
+    Ref<BufferedStream> stream_;
     bool headerWritten_;
     Ref<TransferMeter> payload_;
     int statusCode_;
@@ -56,6 +56,11 @@ Format ServiceDelegate::chunk()
     return worker_->response()->chunk();
 }
 
+Stream *ServiceDelegate::payload()
+{
+    return worker_->response()->payload();
+}
+
 void ServiceDelegate::end()
 {
     worker_->response()->end();
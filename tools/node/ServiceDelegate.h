@@ -35,6 +35,7 @@ protected:
     void write(String bytes);
     Format chunk(String pattern);
     Format chunk();
+    Stream *payload();
     void end();
     void close();
 